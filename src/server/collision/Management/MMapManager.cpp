@@ -24,14 +24,205 @@
 #include "StringFormat.h"
 #include "World.h"
 
+#include <ace/Mem_Map.h>
+#include <ace/OS_NS_unistd.h>
+
+#include <condition_variable>
+#include <thread>
+
 namespace MMAP
 {
     static char const* const MAP_FILE_NAME_FORMAT = "%s/mmaps/%04i.mmap";
     static char const* const TILE_FILE_NAME_FORMAT = "%s/mmaps/%04i%02i%02i.mmtile";
 
+    namespace
+    {
+        std::atomic<uint64> nextMeshSerial(1);
+
+        // serials of the meshes alive right now; unloadedMeshes is bumped on
+        // every unload so threads only take the lock when there is something
+        // to purge
+        std::mutex liveMeshLock;
+        std::unordered_set<uint64> liveMeshes;
+        std::atomic<uint32> unloadedMeshes(0);
+
+        // queries of the calling thread, keyed by MMapData serial; queries of
+        // meshes unloaded in the meantime are freed on the next lookup
+        struct ThreadNavMeshQueries
+        {
+            ~ThreadNavMeshQueries()
+            {
+                for (auto const& query : queries)
+                    dtFreeNavMeshQuery(query.second);
+            }
+
+            void PurgeUnloaded()
+            {
+                uint32 unloaded = unloadedMeshes.load(std::memory_order_acquire);
+                if (unloaded == seenUnloads)
+                    return;
+
+                seenUnloads = unloaded;
+
+                std::lock_guard<std::mutex> guard(liveMeshLock);
+                for (auto itr = queries.begin(); itr != queries.end();)
+                {
+                    if (liveMeshes.count(itr->first))
+                        ++itr;
+                    else
+                    {
+                        dtFreeNavMeshQuery(itr->second);
+                        itr = queries.erase(itr);
+                    }
+                }
+            }
+
+            std::unordered_map<uint64, dtNavMeshQuery*> queries;
+            uint32 seenUnloads = 0;
+        };
+
+        thread_local ThreadNavMeshQueries threadNavMeshQueries;
+
+        // maps the whole .mmtile and pages it in, returns null if the file
+        // is missing or does not hold a valid tile
+        ACE_Mem_Map* MapTileFile(std::string const& fileName)
+        {
+            if (ACE_OS::access(fileName.c_str(), R_OK) != 0)
+            {
+                TC_LOG_DEBUG("maps", "MMAP:loadMap: Could not open mmtile file '%s'", fileName.c_str());
+                return nullptr;
+            }
+
+            ACE_Mem_Map* mapping = new ACE_Mem_Map();
+            if (mapping->map(fileName.c_str(), static_cast<size_t>(-1), O_RDONLY, ACE_DEFAULT_FILE_PERMS, PROT_READ | PROT_WRITE, ACE_MAP_PRIVATE) != 0)
+            {
+                TC_LOG_DEBUG("maps", "MMAP:loadMap: Could not map mmtile file '%s'", fileName.c_str());
+                delete mapping;
+                return nullptr;
+            }
+
+            // the mapping stays valid without the descriptor
+            mapping->close_handle();
+
+            uint8 const* data = static_cast<uint8 const*>(mapping->addr());
+            size_t const length = mapping->size();
+
+            MmapTileHeader const* fileHeader = reinterpret_cast<MmapTileHeader const*>(data);
+            if (length < sizeof(MmapTileHeader) || fileHeader->mmapMagic != MMAP_MAGIC)
+            {
+                TC_LOG_DEBUG("maps", "MMAP:loadMap: Bad header in mmap %s", fileName.c_str());
+                delete mapping;
+                return nullptr;
+            }
+
+            if (fileHeader->mmapVersion != MMAP_VERSION)
+            {
+                TC_LOG_DEBUG("maps", "MMAP:loadMap: %s was built with generator v%i, expected v%i",
+                    fileName.c_str(), fileHeader->mmapVersion, MMAP_VERSION);
+                delete mapping;
+                return nullptr;
+            }
+
+            if (fileHeader->size > length - sizeof(MmapTileHeader))
+            {
+                TC_LOG_DEBUG("maps", "MMAP:loadMap: %s has corrupted data size", fileName.c_str());
+                delete mapping;
+                return nullptr;
+            }
+
+            // fault every page in here so adding the tile never waits on disk
+            uint32 checksum = 0;
+            for (size_t offset = 0; offset < length; offset += 4096)
+                checksum += static_cast<uint8 const volatile*>(data)[offset];
+            (void)checksum;
+
+            return mapping;
+        }
+    }
+
     // ######################## MMapManager ########################
+    struct MMapManager::IoStage
+    {
+        struct Request
+        {
+            PendingTilePtr tile;        // null for a prefetch
+            uint64 key;
+            std::string fileName;
+        };
+
+        IoStage() : stopped(false) { }
+
+        ~IoStage()
+        {
+            {
+                std::lock_guard<std::mutex> guard(lock);
+                stopped = true;
+            }
+            condition.notify_all();
+            if (thread.joinable())
+                thread.join();
+        }
+
+        void queue(PendingTilePtr tile, uint64 key, std::string fileName)
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            if (!thread.joinable())
+                thread = std::thread(&IoStage::run, this);
+
+            requests.push_back({ std::move(tile), key, std::move(fileName) });
+            condition.notify_one();
+        }
+
+        void run()
+        {
+            for (;;)
+            {
+                Request request;
+                {
+                    std::unique_lock<std::mutex> guard(lock);
+                    condition.wait(guard, [this] { return stopped || !requests.empty(); });
+                    if (stopped)
+                        return;
+
+                    request = std::move(requests.front());
+                    requests.pop_front();
+                }
+
+                ACE_Mem_Map* mapping = MapTileFile(request.fileName);
+                if (request.tile)
+                {
+                    request.tile->mapping = mapping;
+                    request.tile->ready.store(true, std::memory_order_release);
+                }
+                else
+                {
+                    delete mapping;                                 // prefetch only warms the page cache
+
+                    std::lock_guard<std::mutex> guard(lock);
+                    prefetchedTiles.erase(request.key);
+                }
+            }
+        }
+
+        std::deque<Request> requests;
+        // prefetches queued or being read, guarded by lock
+        std::unordered_set<uint64> prefetchedTiles;
+        std::mutex lock;
+        std::condition_variable condition;
+        std::thread thread;
+        bool stopped;
+    };
+
+    MMapManager::MMapManager() : loadedTiles(0), thread_safe_environment(true), _io(new IoStage()) { }
+
     MMapManager::~MMapManager()
     {
+        // stop reading before releasing what was read
+        _io.reset();
+
+        for (PendingTilePtr const& tile : _pendingTiles)
+            delete tile->mapping;
+
         for (MMapDataSet::iterator i = loadedMMaps.begin(); i != loadedMMaps.end(); ++i)
             delete i->second;
 
@@ -122,109 +313,201 @@ namespace MMAP
         if (!loadMapData(mapId))
             return false;
 
-        // get this mmap data
-        MMapData* mmap = loadedMMaps[mapId];
-        ASSERT(mmap->navMesh);
+        PendingTilePtr tile;
+        {
+            std::lock_guard<std::mutex> guard(_pendingLock);
+
+            // check if we already have this tile loaded or queued
+            if (!_requestedTiles.insert(packTileKey(mapId, x, y)).second)
+                return false;
 
-        // check if we already have this tile loaded
-        uint32 packedGridPos = packTileID(x, y);
-        if (mmap->loadedTileRefs.find(packedGridPos) != mmap->loadedTileRefs.end())
-            return false;
+            tile = std::make_shared<PendingTile>(true, mapId, x, y);
+            _pendingTiles.push_back(tile);
+            _queuedLoads.insert(packTileKey(mapId, x, y));
+        }
 
         // load this tile :: mmaps/MMMMXXYY.mmtile
-        std::string fileName = Trinity::StringFormat(TILE_FILE_NAME_FORMAT, ConfigMgr::GetStringDefault("DataDir", ".").c_str(), mapId, x, y);
-        FILE* file = fopen(fileName.c_str(), "rb");
-        if (!file)
+        queueIo(tile, mapId, x, y);
+        return true;
+    }
+
+    void MMapManager::prefetchTile(uint32 mapId, int32 x, int32 y)
+    {
+        if (x < 0 || y < 0 || x >= 64 || y >= 64)
+            return;
+
+        if (GetMMapData(mapId) == loadedMMaps.end())
+            return;
+
+        uint64 const key = packTileKey(mapId, x, y);
         {
-            TC_LOG_DEBUG("maps", "MMAP:loadMap: Could not open mmtile file '%s'", fileName.c_str());
-            return false;
+            std::lock_guard<std::mutex> guard(_pendingLock);
+            if (_requestedTiles.find(key) != _requestedTiles.end())
+                return;
         }
 
-        // read header
-        MmapTileHeader fileHeader;
-        if (fread(&fileHeader, sizeof(MmapTileHeader), 1, file) != 1 || fileHeader.mmapMagic != MMAP_MAGIC)
         {
-            TC_LOG_DEBUG("maps", "MMAP:loadMap: Bad header in mmap %04u%02i%02i.mmtile", mapId, x, y);
-            fclose(file);
-            return false;
+            std::lock_guard<std::mutex> guard(_io->lock);
+            if (!_io->prefetchedTiles.insert(key).second)
+                return;
         }
 
-        if (fileHeader.mmapVersion != MMAP_VERSION)
+        queueIo(nullptr, mapId, x, y);
+    }
+
+    void MMapManager::queueIo(PendingTilePtr tile, uint32 mapId, int32 x, int32 y)
+    {
+        _io->queue(std::move(tile), packTileKey(mapId, x, y), Trinity::StringFormat(TILE_FILE_NAME_FORMAT, ConfigMgr::GetStringDefault("DataDir", ".").c_str(), mapId, x, y));
+    }
+
+    void MMapManager::commitPendingTiles()
+    {
+        std::lock_guard<std::mutex> guard(_pendingLock);
+
+        // requests are applied in order, a load still being read holds back
+        // everything queued after it
+        while (!_pendingTiles.empty())
         {
-            TC_LOG_DEBUG("maps", "MMAP:loadMap: %04u%02i%02i.mmtile was built with generator v%i, expected v%i",
-                mapId, x, y, fileHeader.mmapVersion, MMAP_VERSION);
-            fclose(file);
-            return false;
+            PendingTile& tile = *_pendingTiles.front();
+            if (!tile.ready.load(std::memory_order_acquire))
+                break;
+
+            uint64 const key = packTileKey(tile.mapId, tile.x, tile.y);
+            if (tile.load)
+            {
+                auto queued = _queuedLoads.find(key);
+                if (queued != _queuedLoads.end())
+                    _queuedLoads.erase(queued);
+            }
+
+            MMapDataSet::const_iterator itr = GetMMapData(tile.mapId);
+            if (itr != loadedMMaps.end())
+            {
+                if (!tile.load)
+                    removeTile(itr->second, tile.mapId, tile.x, tile.y);
+                // skip loads unloaded again before they were applied
+                else if (_requestedTiles.find(key) != _requestedTiles.end())
+                    addTile(itr->second, tile);
+            }
+
+            delete tile.mapping;
+            _pendingTiles.pop_front();
         }
+    }
 
-        long pos = ftell(file);
-        fseek(file, 0, SEEK_END);
-        if (int64(fileHeader.size) > ftell(file) - pos)
-        {
-            TC_LOG_DEBUG("maps", "MMAP:loadMap: %04u%02i%02i.mmtile has corrupted data size", mapId, x, y);
-            fclose(file);
+    bool MMapManager::loadPendingTile(uint32 mapId, int32 x, int32 y)
+    {
+        if (x < 0 || y < 0 || x >= 64 || y >= 64)
             return false;
+
+        MMapDataSet::const_iterator itr = GetMMapData(mapId);
+        if (itr == loadedMMaps.end())
+            return false;
+
+        MMapData* mmap = itr->second;
+        uint32 const packedGridPos = packTileID(x, y);
+        uint64 const key = packTileKey(mapId, x, y);
+        {
+            std::lock_guard<std::mutex> guard(_pendingLock);
+            if (_queuedLoads.find(key) == _queuedLoads.end() || _requestedTiles.find(key) == _requestedTiles.end())
+                return false;
         }
 
-        fseek(file, pos, SEEK_SET);
+        {
+            ting::shared_lock<ting::shared_mutex> guard(mmap->tileLock);
+            if (mmap->loadedTileRefs.find(packedGridPos) != mmap->loadedTileRefs.end())
+                return true;
+        }
 
-        unsigned char* data = (unsigned char*)dtAlloc(fileHeader.size, DT_ALLOC_PERM);
-        ASSERT(data);
+        // the I/O thread may not have reached it yet, read the file here
+        // rather than wait behind the rest of its queue
+        PendingTile tile(true, mapId, x, y);
+        tile.mapping = MapTileFile(Trinity::StringFormat(TILE_FILE_NAME_FORMAT, ConfigMgr::GetStringDefault("DataDir", ".").c_str(), mapId, x, y));
 
-        size_t result = fread(data, fileHeader.size, 1, file);
-        if (!result)
+        bool loaded;
         {
-            TC_LOG_DEBUG("maps", "MMAP:loadMap: Bad header or data in mmap %04u%02i%02i.mmtile", mapId, x, y);
-            fclose(file);
-            return false;
+            std::lock_guard<ting::shared_mutex> guard(mmap->tileLock);
+            addTile(mmap, tile);
+            loaded = mmap->loadedTileRefs.find(packedGridPos) != mmap->loadedTileRefs.end();
         }
 
-        fclose(file);
+        delete tile.mapping;
+
+        // the queued load skips the tile already in place, and a missing
+        // file is not looked for again on every query
+        std::lock_guard<std::mutex> guard(_pendingLock);
+        _queuedLoads.erase(key);
+        return loaded;
+    }
+
+    ting::shared_mutex* MMapManager::GetNavMeshLock(uint32 mapId)
+    {
+        MMapDataSet::const_iterator itr = GetMMapData(mapId);
+        if (itr == loadedMMaps.end())
+            return nullptr;
+
+        return &itr->second->tileLock;
+    }
+
+    void MMapManager::addTile(MMapData* mmap, PendingTile& tile)
+    {
+        // file missing or invalid, already logged by the I/O thread
+        if (!tile.mapping)
+            return;
+
+        uint32 packedGridPos = packTileID(tile.x, tile.y);
+        if (mmap->loadedTileRefs.find(packedGridPos) != mmap->loadedTileRefs.end())
+            return;
+
+        unsigned char* data = static_cast<unsigned char*>(tile.mapping->addr());
+        MmapTileHeader const* fileHeader = reinterpret_cast<MmapTileHeader const*>(data);
+        data += sizeof(MmapTileHeader);
 
         dtMeshHeader* header = (dtMeshHeader*)data;
         dtTileRef tileRef = 0;
 
-        // memory allocated for data is now managed by detour, and will be deallocated when the tile is removed
-        if (dtStatusSucceed(mmap->navMesh->addTile(data, fileHeader.size, 0, 0, &tileRef)))
+        // tile data stays owned by the mapping, it is unmapped when the tile is removed
+        if (dtStatusSucceed(mmap->navMesh->addTile(data, fileHeader->size, 0, 0, &tileRef)))
         {
-            mmap->loadedTileRefs.insert(std::pair<uint32, dtTileRef>(packedGridPos, tileRef));
+            MMapTile& loaded = mmap->loadedTileRefs[packedGridPos];
+            loaded.ref = tileRef;
+            loaded.mapping = tile.mapping;
+            tile.mapping = nullptr;
             ++loadedTiles;
-            TC_LOG_DEBUG("maps", "MMAP:loadMap: Loaded mmtile %04i[%02i, %02i] into %04i[%02i, %02i]", mapId, x, y, mapId, header->x, header->y);
-            return true;
+            TC_LOG_DEBUG("maps", "MMAP:loadMap: Loaded mmtile %04i[%02i, %02i] into %04i[%02i, %02i]", tile.mapId, tile.x, tile.y, tile.mapId, header->x, header->y);
+            return;
         }
 
-        TC_LOG_DEBUG("maps", "MMAP:loadMap: Could not load %04u%02i%02i.mmtile into navmesh", mapId, x, y);
-        dtFree(data);
-        return false;
+        TC_LOG_DEBUG("maps", "MMAP:loadMap: Could not load %04u%02i%02i.mmtile into navmesh", tile.mapId, tile.x, tile.y);
     }
 
     bool MMapManager::unloadMap(uint32 mapId, int32 x, int32 y)
     {
-        // check if we have this map loaded
-        MMapDataSet::const_iterator itr = GetMMapData(mapId);
-        if (itr == loadedMMaps.end())
+        std::lock_guard<std::mutex> guard(_pendingLock);
+        if (!_requestedTiles.erase(packTileKey(mapId, x, y)))
         {
             // file may not exist, therefore not loaded
-            TC_LOG_DEBUG("maps", "MMAP:unloadMap: Asked to unload not loaded navmesh map. %04u%02i%02i.mmtile", mapId, x, y);
+            TC_LOG_DEBUG("maps", "MMAP:unloadMap: Asked to unload not loaded navmesh tile. %04u%02i%02i.mmtile", mapId, x, y);
             return false;
         }
 
-        MMapData* mmap = itr->second;
+        _pendingTiles.push_back(std::make_shared<PendingTile>(false, mapId, x, y));
+        return true;
+    }
 
+    void MMapManager::removeTile(MMapData* mmap, uint32 mapId, int32 x, int32 y)
+    {
         // check if we have this tile loaded
-        uint32 packedGridPos = packTileID(x, y);
-        if (mmap->loadedTileRefs.find(packedGridPos) == mmap->loadedTileRefs.end())
+        MMapTileSet::iterator itr = mmap->loadedTileRefs.find(packTileID(x, y));
+        if (itr == mmap->loadedTileRefs.end())
         {
             // file may not exist, therefore not loaded
             TC_LOG_DEBUG("maps", "MMAP:unloadMap: Asked to unload not loaded navmesh tile. %04u%02i%02i.mmtile", mapId, x, y);
-            return false;
+            return;
         }
 
-        dtTileRef tileRef = mmap->loadedTileRefs[packedGridPos];
-
         // unload, and mark as non loaded
-        unsigned char* data = NULL;
-        if (dtStatusFailed(mmap->navMesh->removeTile(tileRef, &data, NULL)))
+        if (dtStatusFailed(mmap->navMesh->removeTile(itr->second.ref, NULL, NULL)))
         {
             // this is technically a memory leak
             // if the grid is later reloaded, dtNavMesh::addTile will return error but no extra memory is used
@@ -232,17 +515,11 @@ namespace MMAP
             TC_LOG_DEBUG("maps", "MMAP:unloadMap: Could not unload %04u%02i%02i.mmtile from navmesh", mapId, x, y);
             std::abort();
         }
-        else
-        {
-            mmap->loadedTileRefs.erase(packedGridPos);
-            --loadedTiles;
-            TC_LOG_DEBUG("maps", "MMAP:unloadMap: Unloaded mmtile %04i[%02i, %02i] from %04i", mapId, x, y, mapId);
-
-            dtFree(data);
-            return true;
-        }
 
-        return false;
+        delete itr->second.mapping;
+        mmap->loadedTileRefs.erase(itr);
+        --loadedTiles;
+        TC_LOG_DEBUG("maps", "MMAP:unloadMap: Unloaded mmtile %04i[%02i, %02i] from %04i", mapId, x, y, mapId);
     }
 
     bool MMapManager::unloadMap(uint32 mapId)
@@ -255,18 +532,38 @@ namespace MMAP
             return false;
         }
 
+        // queued loads of this map are dropped when they are applied
+        {
+            std::lock_guard<std::mutex> guard(_pendingLock);
+            for (auto i = _requestedTiles.begin(); i != _requestedTiles.end();)
+            {
+                if (uint32(*i >> 32) == mapId)
+                    i = _requestedTiles.erase(i);
+                else
+                    ++i;
+            }
+
+            for (auto i = _queuedLoads.begin(); i != _queuedLoads.end();)
+            {
+                if (uint32(*i >> 32) == mapId)
+                    i = _queuedLoads.erase(i);
+                else
+                    ++i;
+            }
+        }
+
         // unload all tiles from given map
         MMapData* mmap = itr->second;
         for (MMapTileSet::iterator i = mmap->loadedTileRefs.begin(); i != mmap->loadedTileRefs.end(); ++i)
         {
             uint32 x = (i->first >> 16);
             uint32 y = (i->first & 0x0000FFFF);
-            unsigned char* data = NULL;
-            if (dtStatusFailed(mmap->navMesh->removeTile(i->second, &data, NULL)))
+            if (dtStatusFailed(mmap->navMesh->removeTile(i->second.ref, NULL, NULL)))
                 TC_LOG_DEBUG("maps", "MMAP:unloadMap: Could not unload %04u%02i%02i.mmtile from navmesh", mapId, x, y);
             else
             {
-                dtFree(data);
+                delete i->second.mapping;
+                i->second.mapping = nullptr;
                 --loadedTiles;
                 TC_LOG_DEBUG("maps", "MMAP:unloadMap: Unloaded mmtile %04i[%02i, %02i] from %04i", mapId, x, y, mapId);
             }
@@ -279,33 +576,6 @@ namespace MMAP
         return true;
     }
 
-    bool MMapManager::unloadMapInstance(uint32 mapId, uint32 instanceId)
-    {
-        // check if we have this map loaded
-        MMapDataSet::const_iterator itr = GetMMapData(mapId);
-        if (itr == loadedMMaps.end())
-        {
-            // file may not exist, therefore not loaded
-            TC_LOG_DEBUG("maps", "MMAP:unloadMapInstance: Asked to unload not loaded navmesh map %04u", mapId);
-            return false;
-        }
-
-        MMapData* mmap = itr->second;
-        if (mmap->navMeshQueries.find(instanceId) == mmap->navMeshQueries.end())
-        {
-            TC_LOG_DEBUG("maps", "MMAP:unloadMapInstance: Asked to unload not loaded dtNavMeshQuery mapId %04u instanceId %u", mapId, instanceId);
-            return false;
-        }
-
-        dtNavMeshQuery* query = mmap->navMeshQueries[instanceId];
-
-        dtFreeNavMeshQuery(query);
-        mmap->navMeshQueries.erase(instanceId);
-        TC_LOG_DEBUG("maps", "MMAP:unloadMapInstance: Unloaded mapId %04u instanceId %u", mapId, instanceId);
-
-        return true;
-    }
-
     dtNavMesh const* MMapManager::GetNavMesh(uint32 mapId)
     {
         MMapDataSet::const_iterator itr = GetMMapData(mapId);
@@ -315,30 +585,38 @@ namespace MMAP
         return itr->second->GetNavMesh();
     }
 
-    dtNavMeshQuery const* MMapManager::GetNavMeshQuery(uint32 mapId, uint32 instanceId)
+    dtNavMeshQuery const* MMapManager::GetThreadNavMeshQuery(MMapData* mmap, int maxNodes)
     {
-        MMapDataSet::const_iterator itr = GetMMapData(mapId);
-        if (itr == loadedMMaps.end())
-            return NULL;
+        threadNavMeshQueries.PurgeUnloaded();
 
-        MMapData* mmap = itr->second;
-        if (mmap->navMeshQueries.find(instanceId) == mmap->navMeshQueries.end())
+        dtNavMeshQuery*& query = threadNavMeshQueries.queries[mmap->GetSerial()];
+        if (!query)
         {
             // allocate mesh query
-            dtNavMeshQuery* query = dtAllocNavMeshQuery();
+            query = dtAllocNavMeshQuery();
             ASSERT(query);
-            if (dtStatusFailed(query->init(mmap->GetNavMesh(), 1024)))
+            if (dtStatusFailed(query->init(mmap->GetNavMesh(), maxNodes)))
             {
                 dtFreeNavMeshQuery(query);
-                TC_LOG_DEBUG("maps", "MMAP:GetNavMeshQuery: Failed to initialize dtNavMeshQuery for mapId %04u instanceId %u", mapId, instanceId);
+                threadNavMeshQueries.queries.erase(mmap->GetSerial());
                 return NULL;
             }
-
-            TC_LOG_DEBUG("maps", "MMAP:GetNavMeshQuery: created dtNavMeshQuery for mapId %04u instanceId %u", mapId, instanceId);
-            mmap->navMeshQueries.insert(std::pair<uint32, dtNavMeshQuery*>(instanceId, query));
         }
 
-        return mmap->navMeshQueries[instanceId];
+        return query;
+    }
+
+    dtNavMeshQuery const* MMapManager::GetNavMeshQuery(uint32 mapId)
+    {
+        MMapDataSet::const_iterator itr = GetMMapData(mapId);
+        if (itr == loadedMMaps.end())
+            return NULL;
+
+        dtNavMeshQuery const* query = GetThreadNavMeshQuery(itr->second, 1024);
+        if (!query)
+            TC_LOG_DEBUG("maps", "MMAP:GetNavMeshQuery: Failed to initialize dtNavMeshQuery for mapId %04u", mapId);
+
+        return query;
     }
 
     bool MMapManager::loadGameObject(uint32 displayId)
@@ -414,43 +692,41 @@ namespace MMAP
         return true;
     }
 
-    dtNavMeshQuery const* MMapManager::GetModelNavMeshQuery(uint32 displayId, uint32 instanceId)
+    dtNavMeshQuery const* MMapManager::GetModelNavMeshQuery(uint32 displayId)
     {
-        if (loadedModels.find(displayId) == loadedModels.end())
+        MMapDataSet::const_iterator itr = loadedModels.find(displayId);
+        if (itr == loadedModels.end())
             return NULL;
 
-        MMapData* mmap = loadedModels[displayId];
-        if (mmap->navMeshQueries.find(instanceId) == mmap->navMeshQueries.end())
-        {
-            // allocate mesh query
-            dtNavMeshQuery* query = dtAllocNavMeshQuery();
-            ASSERT(query);
-            if (dtStatusFailed(query->init(mmap->GetNavMesh(), 2048)))
-            {
-                dtFreeNavMeshQuery(query);
-                TC_LOG_DEBUG("maps", "MMAP:GetNavMeshQuery: Failed to initialize dtNavMeshQuery for displayid %04u instanceId %u", displayId, instanceId);
-                return NULL;
-            }
+        dtNavMeshQuery const* query = GetThreadNavMeshQuery(itr->second, 2048);
+        if (!query)
+            TC_LOG_DEBUG("maps", "MMAP:GetNavMeshQuery: Failed to initialize dtNavMeshQuery for displayid %04u", displayId);
 
-            TC_LOG_DEBUG("maps", "MMAP:GetNavMeshQuery: created dtNavMeshQuery for displayid %04u instanceId %u", displayId, instanceId);
-            mmap->navMeshQueries.insert(std::pair<uint32, dtNavMeshQuery*>(instanceId, query));
-        }
-
-        return mmap->navMeshQueries[instanceId];
+        return query;
     }
 
     MMapData::MMapData(dtNavMesh* mesh, uint32 mapId)
     {
         navMesh = mesh;
         _mapId = mapId;
+        _serial = nextMeshSerial.fetch_add(1, std::memory_order_relaxed);
+
+        std::lock_guard<std::mutex> guard(liveMeshLock);
+        liveMeshes.insert(_serial);
     }
 
     MMapData::~MMapData()
     {
-        for (NavMeshQuerySet::iterator i = navMeshQueries.begin(); i != navMeshQueries.end(); ++i)
-            dtFreeNavMeshQuery(i->second);
+        {
+            std::lock_guard<std::mutex> guard(liveMeshLock);
+            liveMeshes.erase(_serial);
+        }
+        unloadedMeshes.fetch_add(1, std::memory_order_release);
 
         dtFreeNavMesh(navMesh);
+
+        for (MMapTileSet::iterator i = loadedTileRefs.begin(); i != loadedTileRefs.end(); ++i)
+            delete i->second.mapping;
     }
 
     dtNavMesh* MMapData::GetNavMesh()
@@ -24,16 +24,30 @@
 #include "DetourNavMesh.h"
 #include "DetourNavMeshQuery.h"
 #include "MapDefines.h"
+#include <atomic>
+#include <deque>
+#include <memory>
+#include <mutex>
 #include <string>
 #include <unordered_map>
 #include <unordered_set>
 #include <vector>
+#include <ting/shared_mutex.hpp>
+
+class ACE_Mem_Map;
 
 //  move map related classes
 namespace MMAP
 {
-    typedef std::unordered_map<uint32, dtTileRef> MMapTileSet;
-    typedef std::unordered_map<uint32, dtNavMeshQuery*> NavMeshQuerySet;
+    // tile data lives in a private mapping of its .mmtile, detour patches
+    // links in place so touched pages are copied on write
+    struct MMapTile
+    {
+        dtTileRef ref;
+        ACE_Mem_Map* mapping;
+    };
+
+    typedef std::unordered_map<uint32, MMapTile> MMapTileSet;
 
     class MMapData
     {
@@ -43,14 +57,20 @@ namespace MMAP
 
         dtNavMesh* GetNavMesh();
 
-        // we have to use single dtNavMeshQuery for every instance, since those are not thread safe
-        NavMeshQuerySet navMeshQueries;     // instanceId to query
+        // dtNavMeshQuery is not thread safe, every thread keeps its own
+        // query per mesh, keyed by this serial (see GetThreadNavMeshQuery);
+        // queries of destroyed meshes are freed on the thread's next lookup
+        uint64 GetSerial() const { return _serial; }
 
         dtNavMesh* navMesh;
         MMapTileSet loadedTileRefs;
+        // held shared by path queries, exclusive while a queued tile is
+        // loaded ahead of the queue (see MMapManager::loadPendingTile)
+        ting::shared_mutex tileLock;
 
     private:
         uint32 _mapId;
+        uint64 _serial;
     };
 
 
@@ -59,22 +79,59 @@ namespace MMAP
 
     // singleton class
     // holds all all access to mmap loading unloading and meshes
+    //
+    // Tiles are never added to or removed from a navmesh while maps are
+    // updating: loadMap and unloadMap only queue the request, the .mmtile
+    // is mapped and paged in by a background I/O thread and the queue is
+    // applied by commitPendingTiles between map update phases. A path query
+    // needing a tile still in the queue loads it right away through
+    // loadPendingTile, queries hold the navmesh tileLock shared for that.
     class MMapManager
     {
+        struct PendingTile
+        {
+            PendingTile(bool load, uint32 mapId, int32 x, int32 y)
+                : load(load), mapId(mapId), x(x), y(y), ready(!load), mapping(nullptr) { }
+
+            bool load;
+            uint32 mapId;
+            int32 x;
+            int32 y;
+            // set by the I/O thread once mapping holds the paged in file,
+            // mapping stays null if the tile could not be read
+            std::atomic<bool> ready;
+            ACE_Mem_Map* mapping;
+        };
+
+        typedef std::shared_ptr<PendingTile> PendingTilePtr;
+
+        // background thread reading .mmtile files, see MMapManager.cpp
+        struct IoStage;
+
         public:
-            MMapManager() : loadedTiles(0), thread_safe_environment(true) {}
+            MMapManager();
             ~MMapManager();
 
             void InitializeThreadUnsafe(std::vector<uint32> const& mapIds);
             bool loadMap(const std::string& basePath, uint32 mapId, int32 x, int32 y);
             bool unloadMap(uint32 mapId, int32 x, int32 y);
             bool unloadMap(uint32 mapId);
-            bool unloadMapInstance(uint32 mapId, uint32 instanceId);
             bool loadGameObject(uint32 displayId);
 
-            // the returned [dtNavMeshQuery const*] is NOT threadsafe
-            dtNavMeshQuery const* GetNavMeshQuery(uint32 mapId, uint32 instanceId);
-            dtNavMeshQuery const* GetModelNavMeshQuery(uint32 displayId, uint32 instanceId);
+            // reads a tile into the page cache ahead of its grid being loaded
+            void prefetchTile(uint32 mapId, int32 x, int32 y);
+            // applies queued tile loads and unloads, must not run concurrently
+            // with path queries
+            void commitPendingTiles();
+            // loads a queued tile now instead of on the next commit, returns
+            // true if the tile is in the navmesh; callers must not hold tileLock
+            bool loadPendingTile(uint32 mapId, int32 x, int32 y);
+            // null if the map has no navmesh
+            ting::shared_mutex* GetNavMeshLock(uint32 mapId);
+
+            // the returned [dtNavMeshQuery const*] belongs to the calling thread
+            dtNavMeshQuery const* GetNavMeshQuery(uint32 mapId);
+            dtNavMeshQuery const* GetModelNavMeshQuery(uint32 displayId);
             dtNavMesh const* GetNavMesh(uint32 mapId);
 
             uint32 getLoadedTilesCount() const { return loadedTiles; }
@@ -83,13 +140,30 @@ namespace MMAP
         private:
             bool loadMapData(uint32 mapId);
             uint32 packTileID(int32 x, int32 y);
+            uint64 packTileKey(uint32 mapId, int32 x, int32 y) { return (uint64(mapId) << 32) | packTileID(x, y); }
+
+            void addTile(MMapData* mmap, PendingTile& tile);
+            void removeTile(MMapData* mmap, uint32 mapId, int32 x, int32 y);
+            dtNavMeshQuery const* GetThreadNavMeshQuery(MMapData* mmap, int maxNodes);
+
+            void queueIo(PendingTilePtr tile, uint32 mapId, int32 x, int32 y);
 
             MMapDataSet::const_iterator GetMMapData(uint32 mapId) const;
             MMapDataSet loadedMMaps;
-            uint32 loadedTiles;
+            std::atomic<uint32> loadedTiles;
             bool thread_safe_environment;
             MMapDataSet loadedModels;
             GoDataSet errorModels;
+
+            // loads and unloads in request order, guarded by _pendingLock
+            std::deque<PendingTilePtr> _pendingTiles;
+            // tiles that will be loaded once the queue is applied
+            std::unordered_set<uint64> _requestedTiles;
+            // loads still in _pendingTiles, not yet tried by loadPendingTile
+            std::unordered_multiset<uint64> _queuedLoads;
+            std::mutex _pendingLock;
+
+            std::unique_ptr<IoStage> _io;
     };
 }
 
@@ -0,0 +1,348 @@
+/*
+ * Copyright (C) 2008-2012 TrinityCore <http://www.trinitycore.org/>
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; either version 2 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "AuctionHouseIndex.h"
+#include "AuctionHouseMgr.h"
+#include "DBCStores.h"
+#include "Item.h"
+#include "ObjectMgr.h"
+#include "Player.h"
+#include "Util.h"
+
+#include <algorithm>
+#include <iterator>
+
+namespace {
+
+void SplitWords(std::string const& text, std::vector<std::string>& words)
+{
+    std::string::size_type start = 0;
+    while (start < text.size())
+    {
+        std::string::size_type end = text.find(' ', start);
+        if (end == std::string::npos)
+            end = text.size();
+
+        if (end > start)
+            words.push_back(text.substr(start, end - start));
+
+        start = end + 1;
+    }
+}
+
+} // namespace
+
+void AuctionHouseIndex::Insert(AuctionEntry const* auction, Item* item)
+{
+    ItemTemplate const* proto = item->GetTemplate();
+
+    Info& info = _info[auction->Id];
+    info.item = item;
+    info.itemEntry = proto->ItemId;
+    info.randomPropertyId = item->GetItemRandomPropertyId();
+    info.itemClass = proto->Class;
+    info.itemSubClass = proto->SubClass;
+    info.inventoryType = proto->InventoryType;
+    info.quality = proto->Quality;
+    info.requiredLevel = proto->RequiredLevel;
+
+    _all.insert(auction->Id);
+    _byClass[info.itemClass].insert(auction->Id);
+    _bySubClass[MakeSubClassKey(info.itemClass, info.itemSubClass)].insert(auction->Id);
+    _byInventoryType[info.inventoryType].insert(auction->Id);
+    _byQuality[info.quality].insert(auction->Id);
+    _byLevelBand[GetLevelBand(info.requiredLevel)].insert(auction->Id);
+
+    for (uint8 locale = 0; locale < TOTAL_LOCALES; ++locale)
+        if (_names[locale].built)
+            AddName(_names[locale], auction->Id, info, LocaleConstant(locale));
+}
+
+void AuctionHouseIndex::Remove(uint32 auctionId)
+{
+    std::unordered_map<uint32, Info>::iterator itr = _info.find(auctionId);
+    if (itr == _info.end())
+        return;
+
+    Info const& info = itr->second;
+
+    auto erase = [auctionId](AuctionIdSetMap& index, uint32 key)
+    {
+        AuctionIdSetMap::iterator set = index.find(key);
+        if (set == index.end())
+            return;
+
+        set->second.erase(auctionId);
+        if (set->second.empty())
+            index.erase(set);
+    };
+
+    _all.erase(auctionId);
+    erase(_byClass, info.itemClass);
+    erase(_bySubClass, MakeSubClassKey(info.itemClass, info.itemSubClass));
+    erase(_byInventoryType, info.inventoryType);
+    erase(_byQuality, info.quality);
+    erase(_byLevelBand, GetLevelBand(info.requiredLevel));
+
+    for (uint8 locale = 0; locale < TOTAL_LOCALES; ++locale)
+        if (_names[locale].built)
+            RemoveName(_names[locale], auctionId);
+
+    _info.erase(itr);
+}
+
+uint32 AuctionHouseIndex::Search(Query const& query, Player* player, uint32 offset, uint32 pageSize, std::vector<uint32>& ids)
+{
+    // every filter that has an index contributes its candidate set, the
+    // smallest one is walked and the rest of the query is checked per auction
+    std::vector<AuctionIdSet const*> candidates;
+    bool residual = false;
+
+    if (query.itemClass != 0xFFFFFFFF)
+    {
+        if (query.itemSubClass != 0xFFFFFFFF)
+            candidates.push_back(Find(_bySubClass, MakeSubClassKey(query.itemClass, query.itemSubClass)));
+        else
+            candidates.push_back(Find(_byClass, query.itemClass));
+    }
+    else if (query.itemSubClass != 0xFFFFFFFF)
+        residual = true;
+
+    if (query.inventoryType != 0xFFFFFFFF)
+        candidates.push_back(Find(_byInventoryType, query.inventoryType));
+
+    if (query.quality != 0xFFFFFFFF)
+        candidates.push_back(Find(_byQuality, query.quality));
+
+    if (query.levelMin != 0)
+    {
+        residual = true;
+        if (query.levelMax != 0 && GetLevelBand(query.levelMin) == GetLevelBand(query.levelMax))
+            candidates.push_back(Find(_byLevelBand, GetLevelBand(query.levelMin)));
+    }
+
+    if (query.usable)
+        residual = true;
+
+    std::string name;
+    AuctionIdSet nameCandidates;
+    if (!query.name.empty())
+    {
+        if (!WStrToUtf8(query.name, name))
+            return 0;
+
+        if (!_names[query.locale].built)
+            BuildNameIndex(query.locale);
+
+        residual = true;
+        candidates.push_back(FindNameCandidates(_names[query.locale], name, nameCandidates));
+    }
+
+    AuctionIdSet const* driver = &_all;
+    for (AuctionIdSet const* set : candidates)
+    {
+        if (!set)
+            return 0;
+
+        if (driver == &_all || set->size() < driver->size())
+            driver = set;
+    }
+
+    if (candidates.size() > 1)
+        residual = true;
+
+    // the index alone answers the query, page straight out of it
+    if (!residual)
+    {
+        if (offset < driver->size())
+        {
+            AuctionIdSet::const_iterator itr = driver->begin();
+            std::advance(itr, offset);
+            for (; itr != driver->end() && ids.size() < pageSize; ++itr)
+                ids.push_back(*itr);
+        }
+
+        return uint32(driver->size());
+    }
+
+    NameIndex const& names = _names[query.locale];
+
+    uint32 totalcount = 0;
+    for (uint32 auctionId : *driver)
+    {
+        Info const& info = _info.find(auctionId)->second;
+        if (!Matches(info, query))
+            continue;
+
+        if (query.usable && player->CanUseItem(info.item) != EQUIP_ERR_OK)
+            continue;
+
+        if (!name.empty())
+        {
+            std::unordered_map<uint32, std::string>::const_iterator itemName = names.names.find(auctionId);
+            if (itemName == names.names.end() || itemName->second.find(name) == std::string::npos)
+                continue;
+        }
+
+        if (totalcount >= offset && ids.size() < pageSize)
+            ids.push_back(auctionId);
+
+        ++totalcount;
+    }
+
+    return totalcount;
+}
+
+bool AuctionHouseIndex::Matches(Info const& info, Query const& query)
+{
+    // 0xFFFFFFFF = -1
+    if (query.itemClass != 0xFFFFFFFF && info.itemClass != query.itemClass)
+        return false;
+
+    if (query.itemSubClass != 0xFFFFFFFF && info.itemSubClass != query.itemSubClass)
+        return false;
+
+    if (query.inventoryType != 0xFFFFFFFF && info.inventoryType != query.inventoryType)
+        return false;
+
+    if (query.quality != 0xFFFFFFFF && info.quality != query.quality)
+        return false;
+
+    if (query.levelMin != 0 && (info.requiredLevel < query.levelMin || (query.levelMax != 0 && info.requiredLevel > query.levelMax)))
+        return false;
+
+    return true;
+}
+
+AuctionHouseIndex::AuctionIdSet const* AuctionHouseIndex::Find(AuctionIdSetMap const& index, uint32 key)
+{
+    AuctionIdSetMap::const_iterator itr = index.find(key);
+    return itr != index.end() ? &itr->second : NULL;
+}
+
+void AuctionHouseIndex::BuildNameIndex(LocaleConstant locale)
+{
+    NameIndex& index = _names[locale];
+    for (std::unordered_map<uint32, Info>::const_iterator itr = _info.begin(); itr != _info.end(); ++itr)
+        AddName(index, itr->first, itr->second, locale);
+
+    index.built = true;
+}
+
+void AuctionHouseIndex::AddName(NameIndex& index, uint32 auctionId, Info const& info, LocaleConstant locale)
+{
+    ItemTemplate const* proto = sObjectMgr->GetItemTemplate(info.itemEntry);
+    if (!proto)
+        return;
+
+    std::string name = proto->Name1;
+    if (ItemLocale const* il = sObjectMgr->GetItemLocale(proto->ItemId))
+        ObjectMgr::GetLocaleString(il->Name, locale, name);
+
+    if (name.empty())
+        return;
+
+    // DO NOT use GetItemEnchantMod(proto->RandomProperty) as it may return a result
+    //  that matches the search but it may not equal item->GetItemRandomPropertyId()
+    //  used in BuildAuctionInfo() which then causes wrong items to be listed
+    // The suffix (ie: of the Monkey) is found in ItemRandomProperties.dbc,
+    //  not ItemRandomSuffix.dbc even though the DBC names seem misleading
+    if (info.randomPropertyId)
+        if (ItemRandomPropertiesEntry const* itemRandProp = sItemRandomPropertiesStore.LookupEntry(info.randomPropertyId))
+            if (itemRandProp->nameSuffix && *itemRandProp->nameSuffix)
+            {
+                name += ' ';
+                name += itemRandProp->nameSuffix;
+            }
+
+    std::wstring wname;
+    if (!Utf8toWStr(name, wname))
+        return;
+
+    wstrToLower(wname);
+    if (!WStrToUtf8(wname, name))
+        return;
+
+    std::vector<std::string> words;
+    SplitWords(name, words);
+    for (std::string const& word : words)
+        index.tokens[word].insert(auctionId);
+
+    index.names[auctionId] = name;
+}
+
+void AuctionHouseIndex::RemoveName(NameIndex& index, uint32 auctionId)
+{
+    std::unordered_map<uint32, std::string>::iterator itr = index.names.find(auctionId);
+    if (itr == index.names.end())
+        return;
+
+    std::vector<std::string> words;
+    SplitWords(itr->second, words);
+    for (std::string const& word : words)
+    {
+        std::map<std::string, AuctionIdSet>::iterator token = index.tokens.find(word);
+        if (token == index.tokens.end())
+            continue;
+
+        token->second.erase(auctionId);
+        if (token->second.empty())
+            index.tokens.erase(token);
+    }
+
+    index.names.erase(itr);
+}
+
+AuctionHouseIndex::AuctionIdSet const* AuctionHouseIndex::FindNameCandidates(NameIndex const& index, std::string const& name, AuctionIdSet& buffer) const
+{
+    std::vector<std::string> words;
+    SplitWords(name, words);
+    if (words.empty())
+        return &_all;
+
+    // searches are matched from the start of a word: every searched word but
+    // the last is a whole word of the name, the last one may be a prefix.
+    // The longest word narrows the candidates best.
+    std::vector<std::string>::const_iterator longest = words.begin();
+    for (std::vector<std::string>::const_iterator itr = words.begin(); itr != words.end(); ++itr)
+        if (itr->size() > longest->size())
+            longest = itr;
+
+    bool const isPrefix = std::next(longest) == words.end() && name[name.size() - 1] != ' ';
+    if (!isPrefix)
+    {
+        std::map<std::string, AuctionIdSet>::const_iterator token = index.tokens.find(*longest);
+        return token != index.tokens.end() ? &token->second : NULL;
+    }
+
+    std::map<std::string, AuctionIdSet>::const_iterator first = index.tokens.lower_bound(*longest);
+    std::map<std::string, AuctionIdSet>::const_iterator last = first;
+    while (last != index.tokens.end() && last->first.compare(0, longest->size(), *longest) == 0)
+        ++last;
+
+    if (first == last)
+        return NULL;
+
+    // a single word with this prefix needs no copy
+    if (std::next(first) == last)
+        return &first->second;
+
+    for (; first != last; ++first)
+        buffer.insert(first->second.begin(), first->second.end());
+
+    return &buffer;
+}
@@ -0,0 +1,109 @@
+/*
+ * Copyright (C) 2008-2012 TrinityCore <http://www.trinitycore.org/>
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; either version 2 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _AUCTION_HOUSE_INDEX_H
+#define _AUCTION_HOUSE_INDEX_H
+
+#include "Common.h"
+
+#include <array>
+#include <map>
+#include <set>
+#include <unordered_map>
+#include <vector>
+
+class Item;
+class Player;
+struct AuctionEntry;
+
+// Secondary indexes over the auctions of one house, kept up to date by
+// AuctionHouseObject::AddAuction/RemoveAuction so that browse requests only
+// walk the auctions of the most selective filter instead of the whole house.
+// Every set is ordered by auction id, which also gives stable paging.
+// Name indexes are built per client locale on the first search in that
+// locale and maintained from then on.
+class AuctionHouseIndex
+{
+    public:
+        typedef std::set<uint32> AuctionIdSet;
+
+        struct Query
+        {
+            std::wstring name;                              // lower case, empty = any
+            uint32 levelMin;                                // 0 = any
+            uint32 levelMax;                                // 0 = no upper bound
+            uint32 inventoryType;                           // 0xFFFFFFFF = any
+            uint32 itemClass;                               // 0xFFFFFFFF = any
+            uint32 itemSubClass;                            // 0xFFFFFFFF = any
+            uint32 quality;                                 // 0xFFFFFFFF = any
+            bool usable;
+            LocaleConstant locale;
+        };
+
+        void Insert(AuctionEntry const* auction, Item* item);
+        void Remove(uint32 auctionId);
+
+        // Fills ids with up to pageSize matching auctions starting at the offset
+        // and returns the number of all matching auctions.
+        uint32 Search(Query const& query, Player* player, uint32 offset, uint32 pageSize, std::vector<uint32>& ids);
+
+    private:
+        struct Info
+        {
+            Item* item;
+            uint32 itemEntry;
+            int32 randomPropertyId;
+            uint32 itemClass;
+            uint32 itemSubClass;
+            uint32 inventoryType;
+            uint32 quality;
+            uint32 requiredLevel;
+        };
+
+        struct NameIndex
+        {
+            NameIndex() : built(false) { }
+
+            bool built;
+            std::unordered_map<uint32, std::string> names; // lower case utf8 name, with suffix
+            std::map<std::string, AuctionIdSet> tokens;     // lower case utf8 word -> auctions
+        };
+
+        typedef std::unordered_map<uint32, AuctionIdSet> AuctionIdSetMap;
+
+        static uint32 GetLevelBand(uint32 level) { return level / 10; }
+        static uint32 MakeSubClassKey(uint32 itemClass, uint32 itemSubClass) { return (itemClass << 16) | itemSubClass; }
+
+        static bool Matches(Info const& info, Query const& query);
+        static AuctionIdSet const* Find(AuctionIdSetMap const& index, uint32 key);
+
+        void BuildNameIndex(LocaleConstant locale);
+        void AddName(NameIndex& index, uint32 auctionId, Info const& info, LocaleConstant locale);
+        void RemoveName(NameIndex& index, uint32 auctionId);
+        AuctionIdSet const* FindNameCandidates(NameIndex const& index, std::string const& name, AuctionIdSet& buffer) const;
+
+        std::unordered_map<uint32, Info> _info;
+        AuctionIdSet _all;
+        AuctionIdSetMap _byClass;
+        AuctionIdSetMap _bySubClass;
+        AuctionIdSetMap _byInventoryType;
+        AuctionIdSetMap _byQuality;
+        AuctionIdSetMap _byLevelBand;
+        std::array<NameIndex, TOTAL_LOCALES> _names;
+};
+
+#endif
@@ -416,12 +416,18 @@ void AuctionHouseObject::AddAuction(AuctionEntry* auction)
     ASSERT(auction);
 
     AuctionsMap[auction->Id] = auction;
+
+    // auctions without item are never listed
+    if (Item* item = sAuctionMgr->GetAItem(auction->itemGUIDLow))
+        _index.Insert(auction, item);
+
     sScriptMgr->OnAuctionAdd(this, auction);
 }
 
 bool AuctionHouseObject::RemoveAuction(AuctionEntry* auction, uint32 /*itemEntry*/)
 {
     bool wasInMap = AuctionsMap.erase(auction->Id) ? true : false;
+    _index.Remove(auction->Id);
 
     sScriptMgr->OnAuctionRemove(this, auction);
 
@@ -520,91 +526,28 @@ void AuctionHouseObject::BuildListAuctionItems(WorldPacket& data, Player* player
     uint32 inventoryType, uint32 itemClass, uint32 itemSubClass, uint32 quality,
     uint32& count, uint32& totalcount)
 {
-    int loc_idx = player->GetSession()->GetSessionDbLocaleIndex();
-    int locdbc_idx = player->GetSession()->GetSessionDbcLocale();
-
-    for (AuctionEntryMap::const_iterator itr = AuctionsMap.begin(); itr != AuctionsMap.end(); ++itr)
+    AuctionHouseIndex::Query query;
+    query.name = wsearchedname;
+    query.levelMin = levelmin;
+    query.levelMax = levelmax;
+    query.inventoryType = inventoryType;
+    query.itemClass = itemClass;
+    query.itemSubClass = itemSubClass;
+    query.quality = quality;
+    query.usable = canUse != 0;
+    query.locale = player->GetSession()->GetSessionDbLocaleIndex();
+
+    std::vector<uint32> ids;
+    ids.reserve(50);
+    totalcount = _index.Search(query, player, page, 50, ids);
+
+    for (uint32 id : ids)
     {
-        AuctionEntry* Aentry = itr->second;
-        Item* item = sAuctionMgr->GetAItem(Aentry->itemGUIDLow);
-        if (!item)
-            continue;
-
-        ItemTemplate const* proto = item->GetTemplate();
-
-        // 0xFFFFFFFF = -1
-        if (itemClass != 0xFFFFFFFF && proto->Class != itemClass)
-            continue;
-
-        if (itemSubClass != 0xFFFFFFFF && proto->SubClass != itemSubClass)
-            continue;
-
-        if (inventoryType != 0xFFFFFFFF && proto->InventoryType != inventoryType)
-            continue;
-
-        if (quality != 0xFFFFFFFF && proto->Quality != quality)
-            continue;
-
-        if (levelmin != 0 && (proto->RequiredLevel < levelmin || (levelmax != 0 && proto->RequiredLevel > levelmax)))
-            continue;
-
-        if (canUse != 0 && player->CanUseItem(item) != EQUIP_ERR_OK)
-            continue;
-
-        // Allow search by suffix (ie: of the Monkey) or partial name (ie: Monkey)
-        // No need to do any of this if no search term was entered
-        if (!wsearchedname.empty())
-        {
-            std::string name = proto->Name1;
-            if (name.empty())
-                continue;
-
-            // local name
-            if (loc_idx >= 0)
-                if (ItemLocale const* il = sObjectMgr->GetItemLocale(proto->ItemId))
-                    ObjectMgr::GetLocaleString(il->Name, loc_idx, name);
-
-            // DO NOT use GetItemEnchantMod(proto->RandomProperty) as it may return a result
-            //  that matches the search but it may not equal item->GetItemRandomPropertyId()
-            //  used in BuildAuctionInfo() which then causes wrong items to be listed
-            int32 propRefID = item->GetItemRandomPropertyId();
-
-            if (propRefID)
-            {
-                // Append the suffix to the name (ie: of the Monkey) if one exists
-                // These are found in ItemRandomProperties.dbc, not ItemRandomSuffix.dbc
-                //  even though the DBC names seem misleading
-                const ItemRandomPropertiesEntry* itemRandProp = sItemRandomPropertiesStore.LookupEntry(propRefID);
-
-                if (itemRandProp)
-                {
-                    char* temp = itemRandProp->nameSuffix;
-                    //char* temp = itemRandProp->nameSuffix;
-
-                    // dbc local name
-                    if (temp)
-                    {
-                        // Append the suffix (ie: of the Monkey) to the name using localization
-                        // or default enUS if localization is invalid
-                        name += ' ';
-                        name += temp[locdbc_idx >= 0 ? locdbc_idx : LOCALE_enUS];
-                    }
-                }
-            }
-
-            // Perform the search (with or without suffix)
-            if (!Utf8FitTo(name, wsearchedname))
-                continue;
-        }
-
-        // Add the item if no search term or if entered search term was found
-        if (count < 50 && totalcount >= page)
+        if (AuctionEntry* Aentry = GetAuction(id))
         {
             ++count;
             Aentry->BuildAuctionInfo(data);
         }
-
-        ++totalcount;
     }
 }
 
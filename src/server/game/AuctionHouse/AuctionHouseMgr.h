@@ -21,6 +21,7 @@
 
 #include <ace/Singleton.h>
 
+#include "AuctionHouseIndex.h"
 #include "Common.h"
 #include "DatabaseEnv.h"
 #include "DBCStructure.h"
@@ -137,6 +138,9 @@ class AuctionHouseObject
   private:
     AuctionEntryMap AuctionsMap;
 
+    // secondary indexes for BuildListAuctionItems
+    AuctionHouseIndex _index;
+
     // storage for "next" auction item for next Update()
     AuctionEntryMap::const_iterator next;
 };
@@ -149,6 +149,16 @@ ZoneScript *BattlefieldMgr::GetZoneScript(uint32 zoneId)
         return NULL;
 }
 
+bool BattlefieldMgr::HasZoneOnMap(uint32 mapId) const
+{
+    for (BattlefieldMap::const_iterator itr = m_BattlefieldMap.begin(); itr != m_BattlefieldMap.end(); ++itr)
+        if (AreaTableEntry const* zone = sAreaTableStore.LookupEntry(itr->first))
+            if (zone->mapid == mapId)
+                return true;
+
+    return false;
+}
+
 void BattlefieldMgr::EventPlayerLoggedOut(Player * player)
 {
     for (BattlefieldSet::iterator itr = m_BattlefieldSet.begin(); itr != m_BattlefieldSet.end(); ++itr)
@@ -53,6 +53,8 @@ class BattlefieldMgr
     Battlefield *GetBattlefieldByGUID(uint64 guid);
 
     ZoneScript *GetZoneScript(uint32 zoneId);
+    // true if a battlefield handles a zone of the map, enabled or not
+    bool HasZoneOnMap(uint32 mapId) const;
 
     void AddZone(uint32 zoneid, Battlefield * handle);
 
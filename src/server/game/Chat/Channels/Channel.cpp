@@ -23,6 +23,7 @@
 #include "World.h"
 #include "DatabaseEnv.h"
 #include "AccountMgr.h"
+#include "SerializedPacket.h"
 
 Channel::Channel(const std::string& name, uint32 channel_id, uint32 Team)
  : m_announce(true), m_ownership(true), m_name(name), m_password(""), m_flags(0), m_channelId(channel_id), m_ownerGUID(0), m_Team(Team), _special(false)
@@ -781,26 +782,28 @@ void Channel::SetOwner(uint64 guid, bool exclaim)
 
 void Channel::SendToAll(WorldPacket* data, uint64 p)
 {
+    SerializedPacket packet(*data);
     for (PlayerList::const_iterator i = players.begin(); i != players.end(); ++i)
     {
         Player* player = ObjectAccessor::FindPlayer(i->first);
         if (player)
         {
             if (!p || !player->GetSocial()->HasIgnore(GUID_LOPART(p)))
-                player->GetSession()->SendPacket(data);
+                player->GetSession()->SendPacket(packet);
         }
     }
 }
 
 void Channel::SendToAllButOne(WorldPacket* data, uint64 who)
 {
+    SerializedPacket packet(*data);
     for (PlayerList::const_iterator i = players.begin(); i != players.end(); ++i)
     {
         if (i->first != who)
         {
             Player* player = ObjectAccessor::FindPlayer(i->first);
             if (player)
-                player->GetSession()->SendPacket(data);
+                player->GetSession()->SendPacket(packet);
         }
     }
 }
@@ -30,6 +30,8 @@
 namespace lfg
 {
 
+static_assert(LFG_MAX_QUEUE_COMBINATION >= MAXGROUPSIZE, "LfgCompatibilityKey must hold every combination tried by FindNewGroups");
+
 /**
    Given a list of guids returns the concatenation using | as delimiter
 
@@ -54,6 +56,78 @@ std::string ConcatenateGuids(LfgGuidList const& check)
     return o.str();
 }
 
+/**
+   Checks if two dungeon selections have at least one dungeon in common
+
+   @param[in]     first dungeon selection
+   @param[in]     second dungeon selection
+   @returns true if both contain a same dungeon
+*/
+bool HasCommonDungeon(LfgDungeonSet const& first, LfgDungeonSet const& second)
+{
+    LfgDungeonSet::const_iterator itFirst = first.begin();
+    LfgDungeonSet::const_iterator itSecond = second.begin();
+    while (itFirst != first.end() && itSecond != second.end())
+    {
+        if (*itFirst < *itSecond)
+            ++itFirst;
+        else if (*itSecond < *itFirst)
+            ++itSecond;
+        else
+            return true;
+    }
+    return false;
+}
+
+LfgCompatibilityKey::LfgCompatibilityKey(LfgGuidList const& check)
+{
+    ASSERT(check.size() <= LFG_MAX_QUEUE_COMBINATION);
+
+    guids.fill(0);
+    std::copy(check.begin(), check.end(), guids.begin());
+
+    // need the guids in order to avoid duplicates
+    std::array<uint64, LFG_MAX_QUEUE_COMBINATION>::iterator last = guids.begin() + check.size();
+    std::sort(guids.begin(), last);
+    std::fill(std::unique(guids.begin(), last), guids.end(), 0);
+}
+
+uint8 LfgCompatibilityKey::GetSize() const
+{
+    uint8 size = 0;
+    while (size < LFG_MAX_QUEUE_COMBINATION && guids[size])
+        ++size;
+    return size;
+}
+
+bool LfgCompatibilityKey::Contains(uint64 guid) const
+{
+    return std::find(guids.begin(), guids.end(), guid) != guids.end();
+}
+
+/**
+   Returns the guids of the key using | as delimiter, as ConcatenateGuids does
+*/
+std::string LfgCompatibilityKey::ToString() const
+{
+    std::ostringstream o;
+    for (uint8 i = 0; i < LFG_MAX_QUEUE_COMBINATION && guids[i]; ++i)
+    {
+        if (i)
+            o << '|';
+        o << guids[i];
+    }
+    return o.str();
+}
+
+size_t LfgCompatibilityKeyHash::operator()(LfgCompatibilityKey const& key) const
+{
+    size_t hash = 0;
+    for (uint8 i = 0; i < LFG_MAX_QUEUE_COMBINATION && key.guids[i]; ++i)
+        hash ^= std::hash<uint64>()(key.guids[i]) + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+    return hash;
+}
+
 char const* GetCompatibleString(LfgCompatibility compatibles)
 {
     switch (compatibles)
@@ -101,17 +175,13 @@ void LFGQueue::RemoveFromQueue(uint64 guid)
     RemoveFromCurrentQueue(guid);
     RemoveFromCompatibles(guid);
 
-    std::ostringstream o;
-    o << guid;
-    std::string sguid = o.str();
-
     LfgQueueDataContainer::iterator itDelete = QueueDataStore.end();
     for (LfgQueueDataContainer::iterator itr = QueueDataStore.begin(); itr != QueueDataStore.end(); ++itr)
         if (itr->first != guid)
         {
-            if (std::string::npos != itr->second.bestCompatible.find(sguid))
+            if (itr->second.bestCompatible.Contains(guid))
             {
-                itr->second.bestCompatible.clear();
+                itr->second.bestCompatible.Clear();
                 FindBestCompatibleInQueue(itr);
             }
         }
@@ -190,43 +260,69 @@ void LFGQueue::UpdateWaitTimeDps(int32 waitTime, uint32 dungeonId)
 */
 void LFGQueue::RemoveFromCompatibles(uint64 guid)
 {
-    std::stringstream out;
-    out << guid;
-    std::string strGuid = out.str();
-
     TC_LOG_DEBUG("lfg", "LFGQueue::RemoveFromCompatibles: Removing [" UI64FMTD "]", guid);
-    for (LfgCompatibleContainer::iterator itNext = CompatibleMapStore.begin(); itNext != CompatibleMapStore.end();)
+    LfgCompatibleKeysContainer::iterator itKeys = CompatibleKeysStore.find(guid);
+    if (itKeys == CompatibleKeysStore.end())
+        return;
+
+    for (std::vector<LfgCompatibilityKey>::const_iterator key = itKeys->second.begin(); key != itKeys->second.end(); ++key)
     {
-        LfgCompatibleContainer::iterator it = itNext++;
-        if (std::string::npos != it->first.find(strGuid))
-            CompatibleMapStore.erase(it);
+        CompatibleMapStore.erase(*key);
+
+        // the other guids of the combination do not reference it anymore either
+        for (uint8 i = 0; i < LFG_MAX_QUEUE_COMBINATION && key->guids[i]; ++i)
+        {
+            if (key->guids[i] == guid)
+                continue;
+
+            LfgCompatibleKeysContainer::iterator itOther = CompatibleKeysStore.find(key->guids[i]);
+            if (itOther != CompatibleKeysStore.end())
+                itOther->second.erase(std::remove(itOther->second.begin(), itOther->second.end(), *key), itOther->second.end());
+        }
     }
+
+    CompatibleKeysStore.erase(itKeys);
+}
+
+/**
+   Returns the cached compatibility of a list of guids, creating it if needed
+
+   @param[in]     key Sorted guids
+   @return LfgCompatibilityData cached data, pending if just created
+*/
+LfgCompatibilityData& LFGQueue::GetOrCreateCompatibilityData(LfgCompatibilityKey const& key)
+{
+    std::pair<LfgCompatibleContainer::iterator, bool> result = CompatibleMapStore.insert(LfgCompatibleContainer::value_type(key, LfgCompatibilityData()));
+    if (result.second)
+        for (uint8 i = 0; i < LFG_MAX_QUEUE_COMBINATION && key.guids[i]; ++i)
+            CompatibleKeysStore[key.guids[i]].push_back(key);
+
+    return result.first->second;
 }
 
 /**
    Stores the compatibility of a list of guids
 
-   @param[in]     key String concatenation of guids (| used as separator)
+   @param[in]     key Sorted guids
    @param[in]     compatibles type of compatibility
 */
-void LFGQueue::SetCompatibles(std::string const& key, LfgCompatibility compatibles)
+void LFGQueue::SetCompatibles(LfgCompatibilityKey const& key, LfgCompatibility compatibles)
 {
-    LfgCompatibilityData& data = CompatibleMapStore[key];
-    data.compatibility = compatibles;
+    GetOrCreateCompatibilityData(key).compatibility = compatibles;
 }
 
-void LFGQueue::SetCompatibilityData(std::string const& key, LfgCompatibilityData const& data)
+void LFGQueue::SetCompatibilityData(LfgCompatibilityKey const& key, LfgCompatibilityData const& data)
 {
-    CompatibleMapStore[key] = data;
+    GetOrCreateCompatibilityData(key) = data;
 }
 
 /**
    Get the compatibility of a group of guids
 
-   @param[in]     key String concatenation of guids (| used as separator)
+   @param[in]     key Sorted guids
    @return LfgCompatibility type of compatibility
 */
-LfgCompatibility LFGQueue::GetCompatibles(std::string const& key)
+LfgCompatibility LFGQueue::GetCompatibles(LfgCompatibilityKey const& key)
 {
     LfgCompatibleContainer::iterator itr = CompatibleMapStore.find(key);
     if (itr != CompatibleMapStore.end())
@@ -235,7 +331,7 @@ LfgCompatibility LFGQueue::GetCompatibles(std::string const& key)
     return LFG_COMPATIBILITY_PENDING;
 }
 
-LfgCompatibilityData* LFGQueue::GetCompatibilityData(std::string const& key)
+LfgCompatibilityData* LFGQueue::GetCompatibilityData(LfgCompatibilityKey const& key)
 {
     LfgCompatibleContainer::iterator itr = CompatibleMapStore.find(key);
     if (itr != CompatibleMapStore.end())
@@ -244,6 +340,60 @@ LfgCompatibilityData* LFGQueue::GetCompatibilityData(std::string const& key)
     return NULL;
 }
 
+/**
+   Get the queued guids that may form a group with the given one. Groups that
+   share no dungeon with it can never be compatible.
+
+   @param[in]     guid Guid looking for a group
+   @param[out]    candidates Queued guids worth checking, in queue order
+*/
+void LFGQueue::GetCandidates(uint64 guid, LfgGuidList& candidates)
+{
+    LfgQueueDataContainer::const_iterator itQueue = QueueDataStore.find(guid);
+    for (LfgGuidList::const_iterator it = currentQueueStore.begin(); it != currentQueueStore.end(); ++it)
+    {
+        // missing queue data is cleaned up by CheckCompatibility
+        LfgQueueDataContainer::const_iterator itOther = QueueDataStore.find(*it);
+        if (itQueue == QueueDataStore.end() || itOther == QueueDataStore.end() ||
+            HasCommonDungeon(itQueue->second.dungeons, itOther->second.dungeons))
+            candidates.push_back(*it);
+    }
+}
+
+/**
+   Checks if the members that can only take one role still fit in the group
+   when the candidate is added. CheckCompatibility assigns the roles using the
+   needs of the first dungeon of the first guid, which is the one in queue data.
+
+   @param[in]     check List of guids already combined
+   @param[in]     candidate Guid to add
+   @return false if the combination can never get valid roles
+*/
+bool LFGQueue::CanFillRoles(LfgGuidList const& check, uint64 candidate)
+{
+    LfgQueueDataContainer::const_iterator itFront = QueueDataStore.find(check.front());
+    LfgQueueDataContainer::const_iterator itQueue = QueueDataStore.find(candidate);
+    if (itFront == QueueDataStore.end() || itQueue == QueueDataStore.end())
+        return true;
+
+    uint8 tanks = itQueue->second.singleRoleTanks;
+    uint8 healers = itQueue->second.singleRoleHealers;
+    uint8 dps = itQueue->second.singleRoleDps;
+    for (LfgGuidList::const_iterator it = check.begin(); it != check.end(); ++it)
+    {
+        itQueue = QueueDataStore.find(*it);
+        if (itQueue == QueueDataStore.end())
+            return true;
+
+        tanks += itQueue->second.singleRoleTanks;
+        healers += itQueue->second.singleRoleHealers;
+        dps += itQueue->second.singleRoleDps;
+    }
+
+    LfgQueueData const& queueData = itFront->second;
+    return tanks <= queueData.tanksNeeded && healers <= queueData.healerNeeded && dps <= queueData.dpsNeeded;
+}
+
 uint8 LFGQueue::FindGroups()
 {
     uint8 proposals = 0;
@@ -256,7 +406,8 @@ uint8 LFGQueue::FindGroups()
         firstNew.push_back(frontguid);
         RemoveFromNewQueue(frontguid);
 
-        LfgGuidList temporalList = currentQueueStore;
+        LfgGuidList temporalList;
+        GetCandidates(frontguid, temporalList);
         LfgCompatibility compatibles = FindNewGroups(firstNew, temporalList);
 
         if (compatibles == LFG_COMPATIBLES_MATCH)
@@ -279,17 +430,17 @@ LfgCompatibility LFGQueue::FindNewGroups(LfgGuidList& check, LfgGuidList& all)
     if (check.empty() || check.size() > MAXGROUPSIZE)
         return LFG_INCOMPATIBLES_WRONG_GROUP_SIZE;
 
-    std::string strGuids = ConcatenateGuids(check);
-    LfgCompatibility compatibles = GetCompatibles(strGuids);
+    LfgCompatibilityKey key(check);
+    LfgCompatibility compatibles = GetCompatibles(key);
 
-    TC_LOG_DEBUG("lfg", "LFGQueue::FindNewGroup: (%s): %s - all(%s)", strGuids.c_str(), GetCompatibleString(compatibles), ConcatenateGuids(all).c_str());
+    TC_LOG_DEBUG("lfg", "LFGQueue::FindNewGroup: (%s): %s - all(%s)", key.ToString().c_str(), GetCompatibleString(compatibles), ConcatenateGuids(all).c_str());
     if (compatibles == LFG_COMPATIBILITY_PENDING) // Not previously cached, calculate
         compatibles = CheckCompatibility(check);
 
     if (compatibles == LFG_COMPATIBLES_BAD_STATES && sLFGMgr->AllQueued(check))
     {
-        TC_LOG_DEBUG("lfg", "LFGQueue::FindNewGroup: (%s) compatibles (cached) changed from bad states to match", strGuids.c_str());
-        SetCompatibles(strGuids, LFG_COMPATIBLES_MATCH);
+        TC_LOG_DEBUG("lfg", "LFGQueue::FindNewGroup: (%s) compatibles (cached) changed from bad states to match", key.ToString().c_str());
+        SetCompatibles(key, LFG_COMPATIBLES_MATCH);
         return LFG_COMPATIBLES_MATCH;
     }
 
@@ -299,8 +450,12 @@ LfgCompatibility LFGQueue::FindNewGroups(LfgGuidList& check, LfgGuidList& all)
     // Try to match with queued groups
     while (!all.empty())
     {
-        check.push_back(all.front());
+        uint64 candidate = all.front();
         all.pop_front();
+        if (!CanFillRoles(check, candidate))
+            continue;
+
+        check.push_back(candidate);
         LfgCompatibility subcompatibility = FindNewGroups(check, all);
         if (subcompatibility == LFG_COMPATIBLES_MATCH)
             return LFG_COMPATIBLES_MATCH;
@@ -318,7 +473,7 @@ LfgCompatibility LFGQueue::FindNewGroups(LfgGuidList& check, LfgGuidList& all)
 */
 LfgCompatibility LFGQueue::CheckCompatibility(LfgGuidList check)
 {
-    std::string strGuids = ConcatenateGuids(check);
+    LfgCompatibilityKey key(check);
     LfgProposal proposal;
     LfgDungeonSet proposalDungeons;
     LfgGroupsMap proposalGroups;
@@ -342,7 +497,7 @@ LfgCompatibility LFGQueue::CheckCompatibility(LfgGuidList check)
     // Check for correct size
     if (check.size() > maxGroupSize || check.empty())
     {
-        TC_LOG_DEBUG("lfg", "LFGQueue::CheckCompatibility: (%s): Size wrong - Not compatibles", strGuids.c_str());
+        TC_LOG_DEBUG("lfg", "LFGQueue::CheckCompatibility: (%s): Size wrong - Not compatibles", key.ToString().c_str());
         return LFG_INCOMPATIBLES_WRONG_GROUP_SIZE;
     }
 
@@ -356,8 +511,8 @@ LfgCompatibility LFGQueue::CheckCompatibility(LfgGuidList check)
         LfgCompatibility child_compatibles = CheckCompatibility(check);
         if (child_compatibles < LFG_COMPATIBLES_WITH_LESS_PLAYERS) // Group not compatible
         {
-            TC_LOG_DEBUG("lfg", "LFGQueue::CheckCompatibility: (%s) child %s not compatibles", strGuids.c_str(), ConcatenateGuids(check).c_str());
-            SetCompatibles(strGuids, child_compatibles);
+            TC_LOG_DEBUG("lfg", "LFGQueue::CheckCompatibility: (%s) child %s not compatibles", key.ToString().c_str(), ConcatenateGuids(check).c_str());
+            SetCompatibles(key, child_compatibles);
             return child_compatibles;
         }
         check.push_front(frontGuid);
@@ -397,7 +552,7 @@ LfgCompatibility LFGQueue::CheckCompatibility(LfgGuidList check)
     // Group with less that MAXGROUPSIZE members always compatible
     if (check.size() == 1 && numPlayers < (proposal.isNew && !forceMinPlayers ? maxGroupSize : minGroupSize))
     {
-        TC_LOG_DEBUG("lfg", "LFGQueue::CheckCompatibility: (%s) sigle group. Compatibles", strGuids.c_str());
+        TC_LOG_DEBUG("lfg", "LFGQueue::CheckCompatibility: (%s) sigle group. Compatibles", key.ToString().c_str());
         LfgQueueDataContainer::iterator itQueue = QueueDataStore.find(check.front());
 
         LfgCompatibilityData data(LFG_COMPATIBLES_WITH_LESS_PLAYERS);
@@ -405,22 +560,22 @@ LfgCompatibility LFGQueue::CheckCompatibility(LfgGuidList check)
         uint32 n = 0;
         LFGMgr::CheckGroupRoles(data.roles, LfgRoleData(*itQueue->second.dungeons.begin() & 0xFFFFF), n);
 
-        UpdateBestCompatibleInQueue(itQueue, strGuids, data.roles);
-        SetCompatibilityData(strGuids, data);
+        UpdateBestCompatibleInQueue(itQueue, key, data.roles);
+        SetCompatibilityData(key, data);
         return LFG_COMPATIBLES_WITH_LESS_PLAYERS;
     }
 
     if (numLfgGroups > 1)
     {
-        TC_LOG_DEBUG("lfg", "LFGQueue::CheckCompatibility: (%s) More than one Lfggroup (%u)", strGuids.c_str(), numLfgGroups);
-        SetCompatibles(strGuids, LFG_INCOMPATIBLES_MULTIPLE_LFG_GROUPS);
+        TC_LOG_DEBUG("lfg", "LFGQueue::CheckCompatibility: (%s) More than one Lfggroup (%u)", key.ToString().c_str(), numLfgGroups);
+        SetCompatibles(key, LFG_INCOMPATIBLES_MULTIPLE_LFG_GROUPS);
         return LFG_INCOMPATIBLES_MULTIPLE_LFG_GROUPS;
     }
 
     if (numPlayers > maxGroupSize)
     {
-        TC_LOG_DEBUG("lfg", "LFGQueue::CheckCompatibility: (%s) Too much players (%u)", strGuids.c_str(), numPlayers);
-        SetCompatibles(strGuids, LFG_INCOMPATIBLES_TOO_MUCH_PLAYERS);
+        TC_LOG_DEBUG("lfg", "LFGQueue::CheckCompatibility: (%s) Too much players (%u)", key.ToString().c_str(), numPlayers);
+        SetCompatibles(key, LFG_INCOMPATIBLES_TOO_MUCH_PLAYERS);
         return LFG_INCOMPATIBLES_TOO_MUCH_PLAYERS;
     }
 
@@ -450,8 +605,8 @@ LfgCompatibility LFGQueue::CheckCompatibility(LfgGuidList check)
 
         if (uint8 playersize = numPlayers - proposalRoles.size())
         {
-            TC_LOG_DEBUG("lfg", "LFGQueue::CheckCompatibility: (%s) not compatible, %u players are ignoring each other", strGuids.c_str(), playersize);
-            SetCompatibles(strGuids, LFG_INCOMPATIBLES_HAS_IGNORES);
+            TC_LOG_DEBUG("lfg", "LFGQueue::CheckCompatibility: (%s) not compatible, %u players are ignoring each other", key.ToString().c_str(), playersize);
+            SetCompatibles(key, LFG_INCOMPATIBLES_HAS_IGNORES);
             return LFG_INCOMPATIBLES_HAS_IGNORES;
         }
 
@@ -468,8 +623,8 @@ LfgCompatibility LFGQueue::CheckCompatibility(LfgGuidList check)
             for (LfgRolesMap::const_iterator it = debugRoles.begin(); it != debugRoles.end(); ++it)
                 o << ", " << it->first << ": " << GetRolesString(it->second);
 
-            TC_LOG_DEBUG("lfg", "LFGQueue::CheckCompatibility: (%s) Roles not compatible%s", strGuids.c_str(), o.str().c_str());
-            SetCompatibles(strGuids, LFG_INCOMPATIBLES_NO_ROLES);
+            TC_LOG_DEBUG("lfg", "LFGQueue::CheckCompatibility: (%s) Roles not compatible%s", key.ToString().c_str(), o.str().c_str());
+            SetCompatibles(key, LFG_INCOMPATIBLES_NO_ROLES);
             return LFG_INCOMPATIBLES_NO_ROLES;
         }
 
@@ -486,8 +641,8 @@ LfgCompatibility LFGQueue::CheckCompatibility(LfgGuidList check)
 
         if (proposalDungeons.empty())
         {
-            TC_LOG_DEBUG("lfg", "LFGQueue::CheckCompatibility: (%s) No compatible dungeons%s", strGuids.c_str(), o.str().c_str());
-            SetCompatibles(strGuids, LFG_INCOMPATIBLES_NO_DUNGEONS);
+            TC_LOG_DEBUG("lfg", "LFGQueue::CheckCompatibility: (%s) No compatible dungeons%s", key.ToString().c_str(), o.str().c_str());
+            SetCompatibles(key, LFG_INCOMPATIBLES_NO_DUNGEONS);
             return LFG_INCOMPATIBLES_NO_DUNGEONS;
         }
     }
@@ -504,15 +659,15 @@ LfgCompatibility LFGQueue::CheckCompatibility(LfgGuidList check)
     // Enough players?
     if (numPlayers < (proposal.isNew && !forceMinPlayers ? maxGroupSize : minGroupSize))
     {
-        TC_LOG_DEBUG("lfg", "LFGQueue::CheckCompatibility: (%s) Compatibles but not enough players(%u)", strGuids.c_str(), numPlayers);
+        TC_LOG_DEBUG("lfg", "LFGQueue::CheckCompatibility: (%s) Compatibles but not enough players(%u)", key.ToString().c_str(), numPlayers);
 
         LfgCompatibilityData data(LFG_COMPATIBLES_WITH_LESS_PLAYERS);
         data.roles = proposalRoles;
 
         for (LfgGuidList::const_iterator itr = check.begin(); itr != check.end(); ++itr)
-            UpdateBestCompatibleInQueue(QueueDataStore.find(*itr), strGuids, data.roles);
+            UpdateBestCompatibleInQueue(QueueDataStore.find(*itr), key, data.roles);
 
-        SetCompatibilityData(strGuids, data);
+        SetCompatibilityData(key, data);
         return LFG_COMPATIBLES_WITH_LESS_PLAYERS;
     }
 
@@ -520,8 +675,8 @@ LfgCompatibility LFGQueue::CheckCompatibility(LfgGuidList check)
 
     if (!sLFGMgr->AllQueued(check))
     {
-        TC_LOG_DEBUG("lfg", "LFGQueue::CheckCompatibility: (%s) Group MATCH but can't create proposal!", strGuids.c_str());
-        SetCompatibles(strGuids, LFG_COMPATIBLES_BAD_STATES);
+        TC_LOG_DEBUG("lfg", "LFGQueue::CheckCompatibility: (%s) Group MATCH but can't create proposal!", key.ToString().c_str());
+        SetCompatibles(key, LFG_COMPATIBLES_BAD_STATES);
         return LFG_COMPATIBLES_BAD_STATES;
     }
 
@@ -569,8 +724,8 @@ LfgCompatibility LFGQueue::CheckCompatibility(LfgGuidList check)
 
     sLFGMgr->AddProposal(proposal);
 
-    TC_LOG_DEBUG("lfg", "LFGQueue::CheckCompatibility: (%s) MATCH! Group formed", strGuids.c_str());
-    SetCompatibles(strGuids, LFG_COMPATIBLES_MATCH);
+    TC_LOG_DEBUG("lfg", "LFGQueue::CheckCompatibility: (%s) MATCH! Group formed", key.ToString().c_str());
+    SetCompatibles(key, LFG_COMPATIBLES_MATCH);
     return LFG_COMPATIBLES_MATCH;
 }
 
@@ -633,7 +788,7 @@ void LFGQueue::UpdateQueueTimers(time_t currTime)
                 break;
         }
 
-        if (queueinfo.bestCompatible.empty())
+        if (queueinfo.bestCompatible.IsEmpty())
             FindBestCompatibleInQueue(itQueue);
 
         LfgQueueStatusData queueData(dungeonId, waitTime, wtAvg, wtTank, wtHealer, wtDps, queuedTime, &queueinfo);
@@ -670,7 +825,7 @@ uint8 LFGQueue::GetQueueSubType(uint64 guid)
 }
 
 LfgQueueData::LfgQueueData() : joinTime(time_t(time(NULL))),
-    type(LFG_TYPE_DUNGEON), subType(LFG_SUBTYPE_DUNGEON)
+    type(LFG_TYPE_DUNGEON), subType(LFG_SUBTYPE_DUNGEON), singleRoleTanks(0), singleRoleHealers(0), singleRoleDps(0)
 {
     tanks = tanksNeeded = minTanksNeeded = LFG_TANKS_NEEDED;
     healers = healerNeeded = minHealerNeeded = LFG_HEALERS_NEEDED;
@@ -697,6 +852,25 @@ LfgQueueData::LfgQueueData(time_t _joinTime, LfgDungeonSet const& _dungeons, con
     tanks = tanksNeeded;
     healers = healerNeeded;
     dps = dpsNeeded;
+
+    singleRoleTanks = singleRoleHealers = singleRoleDps = 0;
+    for (LfgRolesMap::const_iterator it = roles.begin(); it != roles.end(); ++it)
+    {
+        switch (it->second & ~PLAYER_ROLE_LEADER)
+        {
+            case PLAYER_ROLE_TANK:
+                ++singleRoleTanks;
+                break;
+            case PLAYER_ROLE_HEALER:
+                ++singleRoleHealers;
+                break;
+            case PLAYER_ROLE_DAMAGE:
+                ++singleRoleDps;
+                break;
+            default:
+                break;
+        }
+    }
 }
 
 std::string LFGQueue::DumpQueueInfo() const
@@ -731,7 +905,7 @@ std::string LFGQueue::DumpCompatibleInfo(bool full /* = false */) const
     o << "Compatible Map size: " << CompatibleMapStore.size() << "\n";
     if (full)
         for (LfgCompatibleContainer::const_iterator itr = CompatibleMapStore.begin(); itr != CompatibleMapStore.end(); ++itr)
-            o << "(" << itr->first << "): " << GetCompatibleString(itr->second.compatibility) << "\n";
+            o << "(" << itr->first.ToString() << "): " << GetCompatibleString(itr->second.compatibility) << "\n";
 
     return o.str();
 }
@@ -739,32 +913,30 @@ std::string LFGQueue::DumpCompatibleInfo(bool full /* = false */) const
 void LFGQueue::FindBestCompatibleInQueue(LfgQueueDataContainer::iterator itrQueue)
 {
     TC_LOG_DEBUG("lfg", "LFGQueue::FindBestCompatibleInQueue: " UI64FMTD, itrQueue->first);
-    std::ostringstream o;
-    o << itrQueue->first;
-    std::string sguid = o.str();
+    LfgCompatibleKeysContainer::const_iterator itKeys = CompatibleKeysStore.find(itrQueue->first);
+    if (itKeys == CompatibleKeysStore.end())
+        return;
 
-    for (LfgCompatibleContainer::const_iterator itr = CompatibleMapStore.begin(); itr != CompatibleMapStore.end(); ++itr)
-        if (itr->second.compatibility == LFG_COMPATIBLES_WITH_LESS_PLAYERS &&
-            std::string::npos != itr->first.find(sguid))
-        {
+    for (std::vector<LfgCompatibilityKey>::const_iterator key = itKeys->second.begin(); key != itKeys->second.end(); ++key)
+    {
+        LfgCompatibleContainer::const_iterator itr = CompatibleMapStore.find(*key);
+        if (itr != CompatibleMapStore.end() && itr->second.compatibility == LFG_COMPATIBLES_WITH_LESS_PLAYERS)
             UpdateBestCompatibleInQueue(itrQueue, itr->first, itr->second.roles);
-        }
+    }
 }
 
-void LFGQueue::UpdateBestCompatibleInQueue(LfgQueueDataContainer::iterator itrQueue, std::string const& key, LfgRolesMap const& roles)
+void LFGQueue::UpdateBestCompatibleInQueue(LfgQueueDataContainer::iterator itrQueue, LfgCompatibilityKey const& key, LfgRolesMap const& roles)
 {
     LfgQueueData& queueData = itrQueue->second;
 
-    uint8 storedSize = queueData.bestCompatible.empty() ? 0 :
-        std::count(queueData.bestCompatible.begin(), queueData.bestCompatible.end(), '|') + 1;
-
-    uint8 size = std::count(key.begin(), key.end(), '|') + 1;
+    uint8 storedSize = queueData.bestCompatible.GetSize();
+    uint8 size = key.GetSize();
 
     if (size <= storedSize)
         return;
 
     TC_LOG_DEBUG("lfg", "LFGQueue::UpdateBestCompatibleInQueue: Changed (%s) to (%s) as best compatible group for " UI64FMTD,
-        queueData.bestCompatible.c_str(), key.c_str(), itrQueue->first);
+        queueData.bestCompatible.ToString().c_str(), key.ToString().c_str(), itrQueue->first);
 
     queueData.bestCompatible = key;
     queueData.tanks = queueData.tanksNeeded;
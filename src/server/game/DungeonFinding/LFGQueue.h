@@ -20,9 +20,17 @@
 
 #include "LFG.h"
 
+#include <array>
+#include <unordered_map>
+
 namespace lfg
 {
 
+enum LfgQueueLimits
+{
+    LFG_MAX_QUEUE_COMBINATION                    = 5        // queued players/groups tried together, MAXGROUPSIZE
+};
+
 enum LfgCompatibility
 {
     LFG_COMPATIBILITY_PENDING,
@@ -48,6 +56,28 @@ struct LfgCompatibilityData
     LfgRolesMap roles;
 };
 
+/// Sorted guids of a combination of queued players/groups, unused slots are 0
+struct LfgCompatibilityKey
+{
+    LfgCompatibilityKey() { guids.fill(0); }
+    explicit LfgCompatibilityKey(LfgGuidList const& check);
+
+    bool IsEmpty() const { return !guids[0]; }
+    void Clear() { guids.fill(0); }
+    uint8 GetSize() const;
+    bool Contains(uint64 guid) const;
+    std::string ToString() const;
+
+    bool operator==(LfgCompatibilityKey const& right) const { return guids == right.guids; }
+
+    std::array<uint64, LFG_MAX_QUEUE_COMBINATION> guids;
+};
+
+struct LfgCompatibilityKeyHash
+{
+    size_t operator()(LfgCompatibilityKey const& key) const;
+};
+
 /// Stores player or group queue info
 struct LfgQueueData
 {
@@ -62,7 +92,10 @@ struct LfgQueueData
     LfgRolesMap roles;                                     ///< Selected Player Role/s
     uint8 type;                                            ///< Queue dungeon type
     uint8 subType;                                         ///< Queue dungeon subtype
-    std::string bestCompatible;                            ///< Best compatible combination of people queued
+    LfgCompatibilityKey bestCompatible;                    ///< Best compatible combination of people queued
+    uint8 singleRoleTanks;                                 ///< Members that can only be tank
+    uint8 singleRoleHealers;                               ///< Members that can only be healer
+    uint8 singleRoleDps;                                   ///< Members that can only be dps
 
     uint8 tanksNeeded;
     uint8 healerNeeded;
@@ -80,7 +113,8 @@ struct LfgWaitTime
 };
 
 typedef std::map<uint32, LfgWaitTime> LfgWaitTimesContainer;
-typedef std::map<std::string, LfgCompatibilityData> LfgCompatibleContainer;
+typedef std::unordered_map<LfgCompatibilityKey, LfgCompatibilityData, LfgCompatibilityKeyHash> LfgCompatibleContainer;
+typedef std::unordered_map<uint64, std::vector<LfgCompatibilityKey> > LfgCompatibleKeysContainer;
 typedef std::map<uint64, LfgQueueData> LfgQueueDataContainer;
 
 /**
@@ -126,21 +160,25 @@ class LFGQueue
         void RemoveFromNewQueue(uint64 guid);
         void RemoveFromCurrentQueue(uint64 guid);
 
-        void SetCompatibles(std::string const& key, LfgCompatibility compatibles);
-        LfgCompatibility GetCompatibles(std::string const& key);
+        void SetCompatibles(LfgCompatibilityKey const& key, LfgCompatibility compatibles);
+        LfgCompatibility GetCompatibles(LfgCompatibilityKey const& key);
         void RemoveFromCompatibles(uint64 guid);
 
-        void SetCompatibilityData(std::string const& key, LfgCompatibilityData const& compatibles);
-        LfgCompatibilityData* GetCompatibilityData(std::string const& key);
+        void SetCompatibilityData(LfgCompatibilityKey const& key, LfgCompatibilityData const& compatibles);
+        LfgCompatibilityData* GetCompatibilityData(LfgCompatibilityKey const& key);
+        LfgCompatibilityData& GetOrCreateCompatibilityData(LfgCompatibilityKey const& key);
         void FindBestCompatibleInQueue(LfgQueueDataContainer::iterator itrQueue);
-        void UpdateBestCompatibleInQueue(LfgQueueDataContainer::iterator itrQueue, std::string const& key, LfgRolesMap const& roles);
+        void UpdateBestCompatibleInQueue(LfgQueueDataContainer::iterator itrQueue, LfgCompatibilityKey const& key, LfgRolesMap const& roles);
 
+        void GetCandidates(uint64 guid, LfgGuidList& candidates);
+        bool CanFillRoles(LfgGuidList const& check, uint64 candidate);
         LfgCompatibility FindNewGroups(LfgGuidList& check, LfgGuidList& all);
         LfgCompatibility CheckCompatibility(LfgGuidList check);
 
         // Queue
         LfgQueueDataContainer QueueDataStore;              ///< Queued groups
         LfgCompatibleContainer CompatibleMapStore;         ///< Compatible dungeons
+        LfgCompatibleKeysContainer CompatibleKeysStore;    ///< Keys of CompatibleMapStore each queued guid is part of
 
         LfgWaitTimesContainer waitTimesAvgStore;           ///< Average wait time to find a group queuing as multiple roles
         LfgWaitTimesContainer waitTimesTankStore;          ///< Average wait time to find a group queuing as tank
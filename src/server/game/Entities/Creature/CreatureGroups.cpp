@@ -36,6 +36,7 @@ void FormationMgr::AddCreatureToGroup(uint32 groupId, Creature* member)
     if (!map)
         return;
 
+    std::lock_guard<std::mutex> guard(map->CreatureGroupHolderLock);
     CreatureGroupHolderType::iterator itr = map->CreatureGroupHolder.find(groupId);
 
     //Add member to an existing group
@@ -66,7 +67,10 @@ void FormationMgr::RemoveCreatureFromGroup(CreatureGroup* group, Creature* membe
             return;
 
         TC_LOG_DEBUG("server", "Deleting group with InstanceID %u", member->GetInstanceId());
-        map->CreatureGroupHolder.erase(group->GetId());
+        {
+            std::lock_guard<std::mutex> guard(map->CreatureGroupHolderLock);
+            map->CreatureGroupHolder.erase(group->GetId());
+        }
         delete group;
     }
 }
@@ -616,7 +616,7 @@ void Guardian::InitStats(uint32 duration)
     if (HasUnitTypeMask(UNIT_MASK_CONTROLABLE_GUARDIAN))
         if (Player* plr = m_owner->ToPlayer())
         {
-            uint32 infoMask = plr->LoadControlableGuardianActionBarInfo(GetEntry());
+            uint32 infoMask = plr->GetControlableGuardianActionBarInfo(GetEntry());
             m_charmInfo->InitCharmCreateSpells(infoMask);
 
             if (infoMask & (1 << CGUARDIAN_IS_HELPER))
@@ -2228,6 +2228,9 @@ void GameObject::EnableCollision(bool enable)
         GetMap()->InsertGameObjectModel(*m_model);*/
 
     m_model->enable(enable ? GetPhaseMask() : 0);
+
+    if (Map* map = FindMap())
+        map->InvalidateLineOfSightCache();
 }
 
 void GameObject::UpdateModel()
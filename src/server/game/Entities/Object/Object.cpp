@@ -116,7 +116,7 @@ std::string Object::GetString() const
 
 Object::Object() : m_PackGUID(sizeof(uint64)+1), 
     m_objectTypeId(TYPEID_OBJECT), m_objectType(TYPEMASK_OBJECT), m_uint32Values(NULL),
-    _changedFields(NULL), m_valuesCount(0), _fieldNotifyFlags(UF_FLAG_NONE), m_inWorld(0),
+    m_valuesCount(0), _fieldNotifyFlags(UF_FLAG_NONE), m_inWorld(0),
     m_objectUpdated(false)
 {
     m_PackGUID.appendPackGUID(0);
@@ -155,7 +155,6 @@ Object::~Object()
     }
 
     delete [] m_uint32Values;
-    delete [] _changedFields;
 
     for(size_t i = 0; i < m_dynamicTab.size(); ++i)
         delete [] m_dynamicTab[i];
@@ -166,8 +165,7 @@ void Object::_InitValues()
     m_uint32Values = new uint32[m_valuesCount];
     memset(m_uint32Values, 0, m_valuesCount*sizeof(uint32));
 
-    _changedFields = new bool[m_valuesCount];
-    memset(_changedFields, 0, m_valuesCount*sizeof(bool));
+    _changedFields.SetCount(m_valuesCount);
 
     for(size_t i = 0; i < m_dynamicTab.size(); ++i)
     {
@@ -322,13 +320,8 @@ void Object::SendUpdateToPlayer(Player* player)
         player->GetSession()->SendPacket(&packet);
 }
 
-void Object::BuildValuesUpdateBlockForPlayer(UpdateData* data, Player* target) const
+void Object::BuildValuesUpdateBlockForPlayer(UpdateData* data, Player* target, ValuesBlockCache* cache) const
 {
-    ByteBuffer buf(500);
-
-    buf << uint8(UPDATETYPE_VALUES);
-    buf.append(GetPackGUID());
-
     UpdateMask updateMask;
     uint32 valCount = m_valuesCount;
     if (GetTypeId() == TYPEID_PLAYER && target != this)
@@ -337,10 +330,34 @@ void Object::BuildValuesUpdateBlockForPlayer(UpdateData* data, Player* target) c
     updateMask.SetCount(valCount);
 
     _SetUpdateBits(&updateMask, target);
+
+    // viewers ending up with the same mask get the same block unless one of
+    // the sent fields is adjusted for the viewer
+    bool const shareable = cache && !_HasViewerDependentValues(updateMask);
+    if (shareable)
+    {
+        for (ValuesBlockCache::const_iterator itr = cache->begin(); itr != cache->end(); ++itr)
+        {
+            if (itr->first == updateMask)
+            {
+                data->AddUpdateBlock(itr->second);
+                return;
+            }
+        }
+    }
+
+    ByteBuffer buf(500);
+
+    buf << uint8(UPDATETYPE_VALUES);
+    buf.append(GetPackGUID());
+
     _BuildValuesUpdate(UPDATETYPE_VALUES, &buf, &updateMask, target);
     _BuildDynamicValuesUpdate(UPDATETYPE_VALUES, &buf, target);
 
     data->AddUpdateBlock(buf);
+
+    if (shareable)
+        cache->push_back(ValuesBlockCache::value_type(updateMask, buf));
 }
 
 void Object::BuildOutOfRangeUpdateBlock(UpdateData* data) const
@@ -1150,7 +1167,7 @@ void Object::_BuildDynamicValuesUpdate(uint8 updatetype, ByteBuffer *data, Playe
 
 void Object::ClearUpdateMask(bool remove)
 {
-    memset(_changedFields, 0, m_valuesCount*sizeof(bool));
+    _changedFields.Clear();
 
     if (m_objectUpdated)
     {
@@ -1163,7 +1180,7 @@ void Object::ClearUpdateMask(bool remove)
     }
 }
 
-void Object::BuildFieldsUpdate(Player* player, UpdateDataMapType& data_map) const
+void Object::BuildFieldsUpdate(Player* player, UpdateDataMapType& data_map, ValuesBlockCache* cache) const
 {
     UpdateDataMapType::iterator iter = data_map.find(player);
 
@@ -1174,7 +1191,7 @@ void Object::BuildFieldsUpdate(Player* player, UpdateDataMapType& data_map) cons
         iter = p.first;
     }
 
-    BuildValuesUpdateBlockForPlayer(&iter->second, iter->first);
+    BuildValuesUpdateBlockForPlayer(&iter->second, iter->first, cache);
 }
 
 void Object::_LoadIntoDataField(char const* data, uint32 startOffset, uint32 count)
@@ -1190,114 +1207,134 @@ void Object::_LoadIntoDataField(char const* data, uint32 startOffset, uint32 cou
     for (uint32 index = 0; index < count; ++index)
     {
         m_uint32Values[startOffset + index] = atol(tokens[index]);
-        _changedFields[startOffset + index] = true;
+        _changedFields.SetBit(startOffset + index);
     }
 }
 
-void Object::GetUpdateFieldData(Player const* target, uint32*& flags, bool& isOwner, bool& isItemOwner, bool& hasSpecialInfo, bool& isPartyMember) const
+UpdateFieldMasks const* Object::GetUpdateFieldData(Player const* target, uint32& visibilityClass, bool& hasSpecialInfo) const
 {
+    UpdateFieldMasks const* masks = NULL;
+    bool isOwner = false;
+
+    visibilityClass = target == this ? UpdateFieldMasks::VISIBILITY_SELF : 0;
+    hasSpecialInfo = false;
+
     // This function assumes updatefield index is always valid
     switch (GetTypeId())
     {
         case TYPEID_ITEM:
         case TYPEID_CONTAINER:
-            flags = ItemUpdateFieldFlags;
-            isOwner = isItemOwner = ((Item*)this)->GetOwnerGUID() == target->GetGUID();
+            masks = &ItemUpdateFieldMasks;
+            isOwner = ((Item*)this)->GetOwnerGUID() == target->GetGUID();
             break;
         case TYPEID_UNIT:
         case TYPEID_PLAYER:
         {
             Player* plr = ToUnit()->GetCharmerOrOwnerPlayerOrPlayerItself();
-            flags = UnitUpdateFieldFlags;
+            masks = &UnitUpdateFieldMasks;
             isOwner = ToUnit()->GetOwnerGUID() == target->GetGUID();
             hasSpecialInfo = ToUnit()->HasAuraTypeWithCaster(SPELL_AURA_EMPATHY, target->GetGUID());
-            isPartyMember = plr && plr->IsInSameGroupWith(target);
+            if (plr && plr->IsInSameGroupWith(target))
+                visibilityClass |= UpdateFieldMasks::VISIBILITY_PARTY;
             break;
         }
         case TYPEID_GAMEOBJECT:
-            flags = GameObjectUpdateFieldFlags;
+            masks = &GameObjectUpdateFieldMasks;
             isOwner = ToGameObject()->GetOwnerGUID() == target->GetGUID();
             break;
         case TYPEID_DYNAMICOBJECT:
-            flags = DynamicObjectUpdateFieldFlags;
+            masks = &DynamicObjectUpdateFieldMasks;
             isOwner = ((DynamicObject*)this)->GetCasterGUID() == target->GetGUID();
             break;
         case TYPEID_CORPSE:
-            flags = CorpseUpdateFieldFlags;
+            masks = &CorpseUpdateFieldMasks;
             isOwner = ToCorpse()->GetOwnerGUID() == target->GetGUID();
             break;
         case TYPEID_AREATRIGGER:
-            flags = AreaTriggerUpdateFieldFlags;
+            masks = &AreaTriggerUpdateFieldMasks;
             isOwner = ToAreaTrigger()->GetUInt64Value(AREATRIGGER_CASTER) == target->GetGUID();
             break;
         case TYPEID_OBJECT:
             break;
     }
+
+    if (isOwner)
+        visibilityClass |= UpdateFieldMasks::VISIBILITY_OWNER;
+
+    return masks;
 }
 
-bool Object::IsUpdateFieldVisible(uint32 flags, bool isSelf, bool isOwner, bool isItemOwner, bool isPartyMember) const
+void Object::_SetUpdateBits(UpdateMask* updateMask, Player* target) const
 {
-    if (flags == UF_FLAG_NONE)
-        return false;
+    uint32 visibilityClass = 0;
+    bool hasSpecialInfo = false;
+    UpdateFieldMasks const* masks = GetUpdateFieldData(target, visibilityClass, hasSpecialInfo);
 
-    if (flags & (UF_FLAG_PUBLIC | UF_FLAG_DYNAMIC))
-        return true;
+    updateMask->SetBlocks(_changedFields.GetBlocks(), masks->GetVisibleMask(visibilityClass));
+    _SetMaskedBits(updateMask, masks, hasSpecialInfo);
+}
 
-    if (flags & UF_FLAG_PRIVATE && isSelf)
-        return true;
+void Object::_SetCreateBits(UpdateMask* updateMask, Player* target) const
+{
+    uint32 visibilityClass = 0;
+    bool hasSpecialInfo = false;
+    UpdateFieldMasks const* masks = GetUpdateFieldData(target, visibilityClass, hasSpecialInfo);
 
-    if (flags & UF_FLAG_OWNER && (isOwner || isItemOwner))
-        return true;
+    // every visible field holding a value
+    uint32 const* visible = masks->GetVisibleMask(visibilityClass);
+    uint32 const* value = m_uint32Values;
+    uint32 const valCount = updateMask->GetCount();
+    for (uint32 block = 0; block < updateMask->GetBlockCount(); ++block)
+    {
+        uint32 const count = std::min<uint32>(32, valCount - block * 32);
 
-    if (flags & UF_FLAG_PARTY_MEMBER && isPartyMember)
-        return true;
+        uint32 bits = 0;
+        for (uint32 bit = 0; bit < count; ++bit, ++value)
+            bits |= uint32(*value != 0) << bit;
 
-    if (flags & UF_FLAG_UNIT_ALL)
-        return true;
+        updateMask->SetBlock(block, bits & visible[block]);
+    }
 
-    return false;
+    updateMask->AddBlocks(masks->GetFlagMask(UF_FLAG_DYNAMIC));
+    _SetMaskedBits(updateMask, masks, hasSpecialInfo);
 }
 
-void Object::_SetUpdateBits(UpdateMask* updateMask, Player* target) const
+void Object::_SetMaskedBits(UpdateMask* updateMask, UpdateFieldMasks const* masks, bool hasSpecialInfo) const
 {
-    bool* indexes = _changedFields;
-    uint32* flags = NULL;
-    bool isSelf = target == this;
-    bool isOwner = false;
-    bool isItemOwner = false;
-    bool hasSpecialInfo = false;
-    bool isPartyMember = false;
+    // fields always sent while the object has their flag
+    for (uint32 bit = 0; bit < UpdateFieldMasks::MAX_FLAG_BITS; ++bit)
+        if (_fieldNotifyFlags & (1 << bit))
+            updateMask->AddBlocks(masks->GetFlagMask(1 << bit));
 
-    GetUpdateFieldData(target, flags, isOwner, isItemOwner, hasSpecialInfo, isPartyMember);
+    if (hasSpecialInfo)
+        updateMask->AddBlocks(masks->GetFlagMask(UF_FLAG_SPECIAL_INFO));
 
-    uint32 valCount = m_valuesCount;
-    if (GetTypeId() == TYPEID_PLAYER && target != this)
-        valCount = PLAYER_END_NOT_SELF;
-
-    for (uint16 index = 0; index < valCount; ++index, ++indexes)
-        if (_fieldNotifyFlags & flags[index] || (flags[index] & UF_FLAG_SPECIAL_INFO && hasSpecialInfo) || (*indexes && IsUpdateFieldVisible(flags[index], isSelf, isOwner, isItemOwner, isPartyMember)))
-            updateMask->SetBit(index);
+    updateMask->Trim();
 }
 
-void Object::_SetCreateBits(UpdateMask* updateMask, Player* target) const
+bool Object::_HasViewerDependentValues(UpdateMask const& updateMask) const
 {
-    uint32* value = m_uint32Values;
-    uint32* flags = NULL;
-    bool isSelf = target == this;
-    bool isOwner = false;
-    bool isItemOwner = false;
-    bool hasSpecialInfo = false;
-    bool isPartyMember = false;
-
-    GetUpdateFieldData(target, flags, isOwner, isItemOwner, hasSpecialInfo, isPartyMember);
-
-    uint32 valCount = m_valuesCount;
-    if (GetTypeId() == TYPEID_PLAYER && target != this)
-        valCount = PLAYER_END_NOT_SELF;
+    // fields _BuildValuesUpdate adjusts for the viewer
+    switch (GetTypeId())
+    {
+        case TYPEID_UNIT:
+        case TYPEID_PLAYER:
+            if (ToUnit()->HasFlag(UNIT_FIELD_AURASTATE, PER_CASTER_AURA_STATE_MASK))
+                return true;
 
-    for (uint16 index = 0; index < valCount; ++index, ++value)
-        if (_fieldNotifyFlags & flags[index] || (flags[index] & UF_FLAG_DYNAMIC) ||(flags[index] & UF_FLAG_SPECIAL_INFO && hasSpecialInfo) || (*value && IsUpdateFieldVisible(flags[index], isSelf, isOwner, isItemOwner, isPartyMember)))
-            updateMask->SetBit(index);
+            return updateMask.GetBit(OBJECT_FIELD_DYNAMIC_FLAGS) || updateMask.GetBit(UNIT_NPC_FLAGS) ||
+                updateMask.GetBit(UNIT_FIELD_AURASTATE) || updateMask.GetBit(UNIT_FIELD_FLAGS) ||
+                updateMask.GetBit(UNIT_FIELD_DISPLAYID) || updateMask.GetBit(UNIT_FIELD_BYTES_2) ||
+                updateMask.GetBit(UNIT_FIELD_FACTIONTEMPLATE);
+        case TYPEID_GAMEOBJECT:
+            return true;
+        case TYPEID_DYNAMICOBJECT:
+            return updateMask.GetBit(DYNAMICOBJECT_BYTES);
+        case TYPEID_AREATRIGGER:
+            return updateMask.GetBit(AREATRIGGER_SPELLVISUALID);
+        default:
+            return false;
+    }
 }
 
 void Object::SetInt32Value(uint16 index, int32 value)
@@ -1307,7 +1344,7 @@ void Object::SetInt32Value(uint16 index, int32 value)
     if (m_int32Values[index] != value)
     {
         m_int32Values[index] = value;
-        _changedFields[index] = true;
+        _changedFields.SetBit(index);
 
         if (m_inWorld == 1 && !m_objectUpdated)
         {
@@ -1331,7 +1368,7 @@ void Object::SetUInt32Value(uint16 index, uint32 value)
     if (m_uint32Values[index] != value)
     {
         m_uint32Values[index] = value;
-        _changedFields[index] = true;
+        _changedFields.SetBit(index);
 
         if (m_inWorld == 1 && !m_objectUpdated)
         {
@@ -1355,8 +1392,8 @@ void Object::SetUInt64Value(uint16 index, uint64 value)
     {
         m_uint32Values[index] = PAIR64_LOPART(value);
         m_uint32Values[index + 1] = PAIR64_HIPART(value);
-        _changedFields[index] = true;
-        _changedFields[index + 1] = true;
+        _changedFields.SetBit(index);
+        _changedFields.SetBit(index + 1);
 
         if (m_inWorld == 1 && !m_objectUpdated)
         {
@@ -1373,8 +1410,8 @@ bool Object::AddUInt64Value(uint16 index, uint64 value)
     {
         m_uint32Values[index] = PAIR64_LOPART(value);
         m_uint32Values[index + 1] = PAIR64_HIPART(value);
-        _changedFields[index] = true;
-        _changedFields[index + 1] = true;
+        _changedFields.SetBit(index);
+        _changedFields.SetBit(index + 1);
 
         if (m_inWorld == 1 && !m_objectUpdated)
         {
@@ -1395,8 +1432,8 @@ bool Object::RemoveUInt64Value(uint16 index, uint64 value)
     {
         m_uint32Values[index] = 0;
         m_uint32Values[index + 1] = 0;
-        _changedFields[index] = true;
-        _changedFields[index + 1] = true;
+        _changedFields.SetBit(index);
+        _changedFields.SetBit(index + 1);
 
         if (m_inWorld == 1 && !m_objectUpdated)
         {
@@ -1417,7 +1454,11 @@ void Object::SetFloatValue(uint16 index, float value)
     if (m_floatValues[index] != value)
     {
         m_floatValues[index] = value;
-        _changedFields[index] = true;
+        _changedFields.SetBit(index);
+
+        // combat reach is the object size used by range searches
+        if (index == UNIT_FIELD_COMBATREACH && isType(TYPEMASK_UNIT))
+            ToUnit()->UpdateGridPosition();
 
         if (m_inWorld == 1 && !m_objectUpdated)
         {
@@ -1441,7 +1482,7 @@ void Object::SetByteValue(uint16 index, uint8 offset, uint8 value)
     {
         m_uint32Values[index] &= ~uint32(uint32(0xFF) << (offset * 8));
         m_uint32Values[index] |= uint32(uint32(value) << (offset * 8));
-        _changedFields[index] = true;
+        _changedFields.SetBit(index);
 
         if (m_inWorld == 1 && !m_objectUpdated)
         {
@@ -1465,7 +1506,7 @@ void Object::SetUInt16Value(uint16 index, uint8 offset, uint16 value)
     {
         m_uint32Values[index] &= ~uint32(uint32(0xFFFF) << (offset * 16));
         m_uint32Values[index] |= uint32(uint32(value) << (offset * 16));
-        _changedFields[index] = true;
+        _changedFields.SetBit(index);
 
         if (m_inWorld == 1 && !m_objectUpdated)
         {
@@ -1535,7 +1576,7 @@ void Object::SetFlag(uint16 index, uint32 newFlag)
     if (oldval != newval)
     {
         m_uint32Values[index] = newval;
-        _changedFields[index] = true;
+        _changedFields.SetBit(index);
 
         if (m_inWorld == 1 && !m_objectUpdated)
         {
@@ -1556,7 +1597,7 @@ void Object::RemoveFlag(uint16 index, uint32 oldFlag)
     if (oldval != newval)
     {
         m_uint32Values[index] = newval;
-        _changedFields[index] = true;
+        _changedFields.SetBit(index);
 
         if (m_inWorld == 1 && !m_objectUpdated)
         {
@@ -1579,7 +1620,7 @@ void Object::SetByteFlag(uint16 index, uint8 offset, uint8 newFlag)
     if (!(uint8(m_uint32Values[index] >> (offset * 8)) & newFlag))
     {
         m_uint32Values[index] |= uint32(uint32(newFlag) << (offset * 8));
-        _changedFields[index] = true;
+        _changedFields.SetBit(index);
 
         if (m_inWorld == 1 && !m_objectUpdated)
         {
@@ -1602,7 +1643,7 @@ void Object::RemoveByteFlag(uint16 index, uint8 offset, uint8 oldFlag)
     if (uint8(m_uint32Values[index] >> (offset * 8)) & oldFlag)
     {
         m_uint32Values[index] &= ~uint32(uint32(oldFlag) << (offset * 8));
-        _changedFields[index] = true;
+        _changedFields.SetBit(index);
 
         if (m_inWorld == 1 && !m_objectUpdated)
         {
@@ -1801,7 +1842,7 @@ void MovementInfo::OutDebug()
 WorldObject::WorldObject(bool isWorldObject): WorldLocation(),
 m_name(""), m_isActive(false), m_isWorldObject(isWorldObject), m_zoneScript(NULL),
 m_transport(NULL), m_currMap(NULL), m_InstanceId(0),
-m_phaseMask(PHASEMASK_NORMAL), m_phaseId(0), m_ignorePhaseIdCheck(false)
+m_phaseMask(PHASEMASK_NORMAL), m_gridPositions(NULL), m_gridPositionSlot(0), m_phaseId(0), m_ignorePhaseIdCheck(false)
 {
     m_serverSideVisibility.SetValue(SERVERSIDE_VISIBILITY_GHOST, GHOST_VISIBILITY_ALIVE | GHOST_VISIBILITY_GHOST);
     m_serverSideVisibilityDetect.SetValue(SERVERSIDE_VISIBILITY_GHOST, GHOST_VISIBILITY_ALIVE);
@@ -1960,6 +2001,49 @@ bool WorldObject::IsWithinLOSInMap(const WorldObject* obj) const
     return IsWithinLOS(ox, oy, oz);
 }
 
+void WorldObject::RemoveNotInLOSInMap(std::list<WorldObject*>& objects) const
+{
+    std::vector<WorldObject*> candidates;
+    std::vector<G3D::Vector3> ends;
+    candidates.reserve(objects.size());
+    ends.reserve(objects.size());
+
+    for (std::list<WorldObject*>::iterator itr = objects.begin(); itr != objects.end();)
+    {
+        WorldObject* obj = *itr;
+        if (!IsInMap(obj))
+        {
+            itr = objects.erase(itr);
+            continue;
+        }
+
+        // Throne of the Four Wind, hack fix for Alakir, same as IsWithinLOSInMap
+        bool const alakir = GetMapId() == 754 && ((obj->ToCreature() && obj->ToCreature()->GetEntry() == 46753) ||
+            (ToCreature() && ToCreature()->GetEntry() == 46753));
+        if (!alakir)
+        {
+            candidates.push_back(obj);
+            ends.push_back(G3D::Vector3(obj->GetPositionX(), obj->GetPositionY(), obj->GetPositionZ() + 2.f));
+        }
+        ++itr;
+    }
+
+    // same guard as IsWithinLOS, GetMap() is only valid in world
+    if (candidates.empty() || !IsInWorld())
+        return;
+
+    std::unique_ptr<bool[]> results(new bool[candidates.size()]);
+    GetMap()->isInLineOfSight(GetPositionX(), GetPositionY(), GetPositionZH() + 2.f, ends.data(), uint32(ends.size()), GetPhaseMask(), results.get());
+
+    std::unordered_set<WorldObject*> blocked;
+    for (size_t i = 0; i < candidates.size(); ++i)
+        if (!results[i])
+            blocked.insert(candidates[i]);
+
+    if (!blocked.empty())
+        objects.remove_if([&blocked](WorldObject* obj) { return blocked.count(obj) != 0; });
+}
+
 bool WorldObject::IsWithinLOS(float ox, float oy, float oz) const
 {
     /*float x, y, z;
@@ -2689,7 +2773,7 @@ void WorldObject::SendPlaySound(uint32 Sound, bool OnlySelf)
 
 void Object::ForceValuesUpdateAtIndex(uint32 i)
 {
-    _changedFields[i] = true;
+    _changedFields.SetBit(i);
     if (m_inWorld == 1 && !m_objectUpdated)
     {
         sObjectAccessor->AddUpdateObject(this);
@@ -2948,7 +3032,7 @@ void WorldObject::AddObjectToRemoveList()
     map->AddObjectToRemoveList(this);
 }
 
-TempSummon* Map::SummonCreature(uint32 entry, Position const& pos, SummonPropertiesEntry const* properties /*= NULL*/, uint32 duration /*= 0*/, Unit* summoner /*= NULL*/, uint64 targetGuid /*= 0*/, uint32 spellId /*= 0*/, int32 vehId /*= 0*/, uint64 viewerGuid /*= 0*/, std::list<uint64>* viewersList /*= NULL*/)
+TempSummon* Map::SummonCreature(uint32 entry, Position const& pos, SummonPropertiesEntry const* properties /*= NULL*/, uint32 duration /*= 0*/, Unit* summoner /*= NULL*/, uint64 targetGuid /*= 0*/, uint32 spellId /*= 0*/, int32 vehId /*= 0*/, uint64 viewerGuid /*= 0*/, std::list<uint64>* viewersList /*= NULL*/, uint32 summonType /*= 0*/)
 {
     if(summoner)
     {
@@ -3067,15 +3151,25 @@ TempSummon* Map::SummonCreature(uint32 entry, Position const& pos, SummonPropert
 
     summon->InitStats(duration);
 
+    if (summonType)
+        summon->SetTempSummonType(TempSummonType(summonType));
+
     if (viewerGuid)
         summon->AddPlayerInPersonnalVisibilityList(viewerGuid);
 
     if (viewersList)
         summon->AddPlayersInPersonnalVisibilityList(*viewersList);
 
-    AddToMap(summon->ToCreature());
-    summon->InitSummon();
-    summon->CastPetAuras(true);
+    AddToMap(summon->ToCreature(), [summon]
+    {
+        summon->InitSummon();
+        summon->CastPetAuras(true);
+    });
+
+    // spawned into the grids of another region, it enters the world (and
+    // gets its AI) once the regions are updated, JustSummoned still follows
+    if (!summon->IsInWorld())
+        return NULL;
 
     //TC_LOG_DEBUG("pets", "Map::SummonCreature summoner %u entry %i mask %i", summoner ? summoner->GetGUID() : 0, entry, mask);
 
@@ -3116,11 +3210,7 @@ TempSummon* WorldObject::SummonCreature(uint32 entry, const Position &pos, uint6
             if(creatures.size() > 50)
                 return NULL;
         }
-        if (TempSummon* summon = map->SummonCreature(entry, pos, properties, duration, isType(TYPEMASK_UNIT) ? (Unit*)this : NULL, targetGuid, spellId))
-        {
-            summon->SetTempSummonType(spwtype);
-            return summon;
-        }
+        return map->SummonCreature(entry, pos, properties, duration, isType(TYPEMASK_UNIT) ? (Unit*)this : NULL, targetGuid, spellId, 0, 0, NULL, spwtype);
     }
 
     return NULL;
@@ -3137,11 +3227,7 @@ TempSummon* WorldObject::SummonCreature(uint32 entry, const Position &pos, TempS
             if(creatures.size() > 50)
                 return NULL;
         }
-        if (TempSummon* summon = map->SummonCreature(entry, pos, NULL, duration, isType(TYPEMASK_UNIT) ? (Unit*)this : NULL, 0, 0, vehId, viewerGuid, viewersList))
-        {
-            summon->SetTempSummonType(spwtype);
-            return summon;
-        }
+        return map->SummonCreature(entry, pos, NULL, duration, isType(TYPEMASK_UNIT) ? (Unit*)this : NULL, 0, 0, vehId, viewerGuid, viewersList, spwtype);
     }
 
     return NULL;
@@ -3272,6 +3358,10 @@ GameObject* WorldObject::SummonGameObject(uint32 entry, float x, float y, float
 
     map->AddToMap(go);
 
+    // spawned into the grids of another region, see Map::AddToMap
+    if (!go->IsInWorld())
+        return NULL;
+
     return go;
 }
 
@@ -3689,6 +3779,7 @@ void WorldObject::MovePositionToCollisionBetween(Position &pos, float distMin, f
 void WorldObject::SetPhaseMask(uint32 newPhaseMask, bool update)
 {
     m_phaseMask = newPhaseMask;
+    UpdateGridPosition();
 
     if (update && IsInWorld())
         UpdateObjectVisibility();
@@ -3813,6 +3904,7 @@ struct WorldObjectChangeAccumulator
     UpdateDataMapType& i_updateDatas;
     WorldObject& i_object;
     std::set<uint64> plr_list;
+    ValuesBlockCache i_blocks;
         WorldObjectChangeAccumulator(WorldObject &obj, UpdateDataMapType &d)
         : i_updateDatas(d), i_object(obj)
     { }
@@ -3859,7 +3951,7 @@ struct WorldObjectChangeAccumulator
         // Only send update once to a player
         if (plr_list.find(player->GetGUID()) == plr_list.end() && player->HaveAtClient(&i_object))
         {
-            i_object.BuildFieldsUpdate(player, i_updateDatas);
+            i_object.BuildFieldsUpdate(player, i_updateDatas, &i_blocks);
             plr_list.insert(player->GetGUID());
         }
     }
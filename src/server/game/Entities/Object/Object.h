@@ -22,9 +22,11 @@
 #include "Common.h"
 #include "UpdateFields.h"
 #include "UpdateData.h"
+#include "UpdateMask.h"
 #include "ObjectDefines.h"
 #include "GridDefines.h"
 #include "Map.h"
+#include "Dynamic/PositionIndex.h"
 
 #include <set>
 #include <string>
@@ -112,7 +114,7 @@ class ByteBuffer;
 class WorldSession;
 class Creature;
 class Player;
-class UpdateMask;
+class UpdateFieldMasks;
 class InstanceScript;
 class Item;
 class GameObject;
@@ -155,6 +157,8 @@ struct ObjectInvisibility final
 };
 
 typedef std::unordered_map<Player*, UpdateData> UpdateDataMapType;
+// values blocks built for the viewers of an object, by update mask
+typedef std::vector<std::pair<UpdateMask, ByteBuffer>> ValuesBlockCache;
 typedef cyber_ptr<Object> C_PTR;
 class Object
 {
@@ -186,7 +190,7 @@ class Object
         virtual void BuildCreateUpdateBlockForPlayer(UpdateData* data, Player* target) const;
         void SendUpdateToPlayer(Player* player);
 
-        void BuildValuesUpdateBlockForPlayer(UpdateData* data, Player* target) const;
+        void BuildValuesUpdateBlockForPlayer(UpdateData* data, Player* target, ValuesBlockCache* cache = NULL) const;
         void BuildOutOfRangeUpdateBlock(UpdateData* data) const;
 
         virtual void DestroyForPlayer(Player* target, bool onDeath = false) const;
@@ -373,7 +377,7 @@ class Object
         virtual bool hasQuest(uint32 /* quest_id */) const { return false; }
         virtual bool hasInvolvedQuest(uint32 /* quest_id */) const { return false; }
         virtual void BuildUpdate(UpdateDataMapType&) {}
-        void BuildFieldsUpdate(Player*, UpdateDataMapType &) const;
+        void BuildFieldsUpdate(Player*, UpdateDataMapType &, ValuesBlockCache* cache = NULL) const;
 
         virtual uint32 GetVignetteId() const { return 0; }
 
@@ -425,12 +429,12 @@ class Object
         std::string _ConcatFields(uint16 startIndex, uint16 size) const;
         void _LoadIntoDataField(const char* data, uint32 startOffset, uint32 count);
 
-        void GetUpdateFieldData(Player const* target, uint32*& flags, bool& isOwner, bool& isItemOwner, bool& hasSpecialInfo, bool& isPartyMember) const;
-
-        bool IsUpdateFieldVisible(uint32 flags, bool isSelf, bool isOwner, bool isItemOwner, bool isPartyMember) const;
+        UpdateFieldMasks const* GetUpdateFieldData(Player const* target, uint32& visibilityClass, bool& hasSpecialInfo) const;
 
         void _SetUpdateBits(UpdateMask* updateMask, Player* target) const;
         void _SetCreateBits(UpdateMask* updateMask, Player* target) const;
+        void _SetMaskedBits(UpdateMask* updateMask, UpdateFieldMasks const* masks, bool hasSpecialInfo) const;
+        bool _HasViewerDependentValues(UpdateMask const& updateMask) const;
         void _BuildMovementUpdate(ByteBuffer * data, uint16 flags) const;
         void _BuildValuesUpdate(uint8 updatetype, ByteBuffer *data, UpdateMask* updateMask, Player* target) const;
         void _BuildDynamicValuesUpdate(uint8 updatetype, ByteBuffer *data, Player* target) const;
@@ -447,7 +451,7 @@ class Object
             float  *m_floatValues;
         };
 
-        bool* _changedFields;
+        UpdateMask _changedFields;
 
         uint16 m_valuesCount;
 
@@ -771,13 +775,22 @@ public:
         return storage_ != nullptr;
     }
 
-    void AddToGrid(ObjectTypeStorage &storage)
+    void AddToGrid(ObjectTypeStorage &storage, Trinity::PositionIndex &positions, uint8 &occupancy, uint8 occupancyBit)
     {
         ASSERT(!IsInGrid());
 
+        ObjectType * const object = static_cast<ObjectType*>(this);
+
         storage_ = &storage;
         offset_ = storage_->size();
-        storage_->emplace_back(static_cast<ObjectType*>(this));
+        storage_->emplace_back(object);
+
+        positions.add(object->GetPositionX(), object->GetPositionY(), object->GetPositionZ(), object->GetObjectSize(), object->GetPhaseMask());
+        object->SetGridPositionSlot(&positions, offset_);
+
+        occupancy_ = &occupancy;
+        occupancyBit_ = occupancyBit;
+        occupancy |= occupancyBit;
     }
 
     void RemoveFromGrid()
@@ -788,19 +801,29 @@ public:
         auto &atOffset = (*storage_)[offset_];
         ASSERT(atOffset == static_cast<ObjectType*>(this));
 
+        Trinity::PositionIndex * const positions = atOffset->GetGridPositions();
+        positions->remove(offset_);
+
         if (atOffset != storage_->back())
         {
             std::swap(atOffset, storage_->back());
             static_cast<SelfType*>(atOffset)->offset_ = offset_;
+            atOffset->SetGridPositionSlot(positions, offset_);
         }
 
         storage_->pop_back();
+        static_cast<ObjectType*>(this)->SetGridPositionSlot(nullptr, 0);
+        if (storage_->empty())
+            *occupancy_ &= ~occupancyBit_;
+
         storage_ = nullptr;
     }
 
 private:
     ObjectTypeStorage *storage_;
     std::size_t offset_;
+    uint8 *occupancy_;
+    uint8 occupancyBit_;
 };
 
 template <class T_VALUES, class T_FLAGS, class FLAG_TYPE, uint8 ARRAY_SIZE>
@@ -838,6 +861,27 @@ class WorldObject : public Object, public WorldLocation
 
         void _Create(uint32 guidlow, HighGuid guidhigh, uint32 phaseMask);
 
+        // Position overloads that also refresh the entry of the object in the position index of its grid cell
+        void Relocate(float x, float y) { WorldLocation::Relocate(x, y); UpdateGridPosition(); }
+        void Relocate(float x, float y, float z) { WorldLocation::Relocate(x, y, z); UpdateGridPosition(); }
+        void Relocate(float x, float y, float z, float orientation) { WorldLocation::Relocate(x, y, z, orientation); UpdateGridPosition(); }
+        void Relocate(float x, float y, float z, float orientation, float positionH) { WorldLocation::Relocate(x, y, z, orientation, positionH); UpdateGridPosition(); }
+        void Relocate(Position const& pos) { WorldLocation::Relocate(pos); UpdateGridPosition(); }
+        void Relocate(Position const* pos) { WorldLocation::Relocate(pos); UpdateGridPosition(); }
+
+        void UpdateGridPosition()
+        {
+            if (m_gridPositions)
+                m_gridPositions->set(m_gridPositionSlot, GetPositionX(), GetPositionY(), GetPositionZH(), GetObjectSize(), GetPhaseMask());
+        }
+
+        Trinity::PositionIndex* GetGridPositions() const { return m_gridPositions; }
+        void SetGridPositionSlot(Trinity::PositionIndex* positions, std::size_t slot)
+        {
+            m_gridPositions = positions;
+            m_gridPositionSlot = slot;
+        }
+
         virtual void RemoveFromWorld()
         {
             if (!IsInWorld())
@@ -997,6 +1041,8 @@ class WorldObject : public Object, public WorldLocation
         }
         bool IsWithinLOS(float x, float y, float z) const;
         bool IsWithinLOSInMap(const WorldObject* obj) const;
+        // removes the objects IsWithinLOSInMap would fail for, tested as one batch
+        void RemoveNotInLOSInMap(std::list<WorldObject*>& objects) const;
         bool GetDistanceOrder(WorldObject const* obj1, WorldObject const* obj2, bool is3D = true) const;
         bool IsInRange(WorldObject const* obj, float minRange, float maxRange, bool is3D = true) const;
         bool IsInRange2d(float x, float y, float minRange, float maxRange) const;
@@ -1181,6 +1227,8 @@ class WorldObject : public Object, public WorldLocation
         //uint32 m_mapId;                                     // object at map with map_id
         uint32 m_InstanceId;                                // in map copy with instance id
         uint32 m_phaseMask;                                 // in area phase state
+        Trinity::PositionIndex* m_gridPositions;            // position index of the grid cell object list, set while in grid
+        std::size_t m_gridPositionSlot;
         uint32 m_phaseId;                                   // special phase. It's new generation phase, when we should check id.
         bool m_ignorePhaseIdCheck;                          // like gm mode.
 
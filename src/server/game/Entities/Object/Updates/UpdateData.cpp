@@ -45,6 +45,15 @@ void UpdateData::AddUpdateBlock(const ByteBuffer &block)
     ++m_blockCount;
 }
 
+void UpdateData::Append(UpdateData const& other)
+{
+    ASSERT(m_map == other.m_map);
+
+    m_outOfRangeGUIDs.insert(other.m_outOfRangeGUIDs.begin(), other.m_outOfRangeGUIDs.end());
+    m_data.append(other.m_data);
+    m_blockCount += other.m_blockCount;
+}
+
 bool UpdateData::BuildPacket(WorldPacket* packet)
 {
     ASSERT(packet->empty());                                // shouldn't happen
@@ -2284,3 +2284,41 @@ uint32 ItemDynamicFieldFlags[ITEM_DYNAMIC_END] =
 {
     UF_FLAG_OWNER,                                          // ITEM_DYNAMIC_MODIFIERS
 };
+
+UpdateFieldMasks::UpdateFieldMasks(uint32 const* flags, uint32 count)
+{
+    uint32 const blocks = (count + 31) / 32;
+
+    for (uint32 bit = 0; bit < MAX_FLAG_BITS; ++bit)
+    {
+        _flagMasks[bit].assign(blocks, 0);
+        for (uint32 index = 0; index < count; ++index)
+            if (flags[index] & (1 << bit))
+                _flagMasks[bit][index / 32] |= 1u << (index % 32);
+    }
+
+    // public, dynamic and unit-all fields are sent to everyone, private ones
+    // to the object itself, owner and party member ones to these viewers
+    for (uint32 visibilityClass = 0; visibilityClass < MAX_VISIBILITY_CLASSES; ++visibilityClass)
+    {
+        uint32 visibleFlags = UF_FLAG_PUBLIC | UF_FLAG_DYNAMIC | UF_FLAG_UNIT_ALL;
+        if (visibilityClass & VISIBILITY_SELF)
+            visibleFlags |= UF_FLAG_PRIVATE;
+        if (visibilityClass & VISIBILITY_OWNER)
+            visibleFlags |= UF_FLAG_OWNER;
+        if (visibilityClass & VISIBILITY_PARTY)
+            visibleFlags |= UF_FLAG_PARTY_MEMBER;
+
+        _visibleMasks[visibilityClass].assign(blocks, 0);
+        for (uint32 index = 0; index < count; ++index)
+            if (flags[index] & visibleFlags)
+                _visibleMasks[visibilityClass][index / 32] |= 1u << (index % 32);
+    }
+}
+
+UpdateFieldMasks const ItemUpdateFieldMasks(ItemUpdateFieldFlags, CONTAINER_END);
+UpdateFieldMasks const UnitUpdateFieldMasks(UnitUpdateFieldFlags, PLAYER_END);
+UpdateFieldMasks const GameObjectUpdateFieldMasks(GameObjectUpdateFieldFlags, GAMEOBJECT_END);
+UpdateFieldMasks const DynamicObjectUpdateFieldMasks(DynamicObjectUpdateFieldFlags, DYNAMICOBJECT_END);
+UpdateFieldMasks const CorpseUpdateFieldMasks(CorpseUpdateFieldFlags, CORPSE_END);
+UpdateFieldMasks const AreaTriggerUpdateFieldMasks(AreaTriggerUpdateFieldFlags, AREATRIGGER_END);
@@ -21,6 +21,8 @@
 #include "UpdateFields.h"
 #include "Define.h"
 
+#include <vector>
+
 enum UpdatefieldFlags
 {
     UF_FLAG_NONE         = 0x000,
@@ -46,4 +48,48 @@ extern uint32 AreaTriggerUpdateFieldFlags[AREATRIGGER_END];
 extern uint32 UnitDynamicFieldFlags[PLAYER_DYNAMIC_END];
 extern uint32 ItemDynamicFieldFlags[ITEM_DYNAMIC_END];
 
+// Fields of an object type grouped by flag and by visibility class of the
+// viewer, built once from the flags tables above. The update mask of a viewer
+// is then a few word-wide operations on the changed fields bitset instead of
+// a flags lookup per field.
+class UpdateFieldMasks
+{
+    public:
+        enum
+        {
+            VISIBILITY_SELF        = 0x1,
+            VISIBILITY_OWNER       = 0x2,                   // owner or item owner
+            VISIBILITY_PARTY       = 0x4,
+            MAX_VISIBILITY_CLASSES = 8,
+
+            MAX_FLAG_BITS          = 10                     // UF_FLAG_PUBLIC .. UF_FLAG_UNK_200
+        };
+
+        UpdateFieldMasks(uint32 const* flags, uint32 count);
+
+        // fields having this flag, a single UF_FLAG_* value
+        uint32 const* GetFlagMask(uint32 flag) const
+        {
+            uint32 bit = 0;
+            while (bit + 1 < MAX_FLAG_BITS && !(flag & (1 << bit)))
+                ++bit;
+
+            return &_flagMasks[bit][0];
+        }
+
+        // fields sent to a viewer of this visibility class when they change
+        uint32 const* GetVisibleMask(uint32 visibilityClass) const { return &_visibleMasks[visibilityClass][0]; }
+
+    private:
+        std::vector<uint32> _flagMasks[MAX_FLAG_BITS];
+        std::vector<uint32> _visibleMasks[MAX_VISIBILITY_CLASSES];
+};
+
+extern UpdateFieldMasks const ItemUpdateFieldMasks;
+extern UpdateFieldMasks const UnitUpdateFieldMasks;
+extern UpdateFieldMasks const GameObjectUpdateFieldMasks;
+extern UpdateFieldMasks const DynamicObjectUpdateFieldMasks;
+extern UpdateFieldMasks const CorpseUpdateFieldMasks;
+extern UpdateFieldMasks const AreaTriggerUpdateFieldMasks;
+
 #endif // _UPDATEFIELDFLAGS_H
@@ -22,6 +22,8 @@
 #include "UpdateFields.h"
 #include "Errors.h"
 
+#include <cstring>
+
 class UpdateMask
 {
     public:
@@ -52,6 +54,32 @@ class UpdateMask
         uint32 GetLength() const { return mBlocks << 2; }
         uint32 GetCount() const { return mCount; }
         uint8* GetMask() { return (uint8*)mUpdateMask; }
+        uint32 const* GetBlocks() const { return mUpdateMask; }
+
+        // Word-wide operations on raw masks covering at least GetBlockCount()
+        // blocks, Trim() clears what they set past GetCount()
+        void SetBlock(uint32 block, uint32 bits)
+        {
+            mUpdateMask[block] = bits;
+        }
+
+        void SetBlocks(uint32 const* mask, uint32 const* filter)
+        {
+            for (uint32 i = 0; i < mBlocks; ++i)
+                mUpdateMask[i] = mask[i] & filter[i];
+        }
+
+        void AddBlocks(uint32 const* mask)
+        {
+            for (uint32 i = 0; i < mBlocks; ++i)
+                mUpdateMask[i] |= mask[i];
+        }
+
+        void Trim()
+        {
+            if (uint32 const tail = mCount & 31)
+                mUpdateMask[mBlocks - 1] &= (1u << tail) - 1;
+        }
 
         void SetCount (uint32 valuesCount)
         {
@@ -95,6 +123,11 @@ class UpdateMask
                 mUpdateMask[i] |= mask.mUpdateMask[i];
         }
 
+        bool operator==(UpdateMask const& mask) const
+        {
+            return mCount == mask.mCount && !memcmp(mUpdateMask, mask.mUpdateMask, mBlocks << 2);
+        }
+
         UpdateMask operator&(UpdateMask const& mask) const
         {
             ASSERT(mask.mCount <= mCount);
@@ -414,7 +414,7 @@ void Pet::SavePetToDB(bool isDelete)
         _SaveAuras(trans);
     _SaveSpells(trans);
     _SaveSpellCooldowns(trans);
-    CharacterDatabase.CommitTransaction(trans);
+    CharacterDatabase.CommitTransaction(trans, GUID_LOPART(GetOwnerGUID()));
 
     //TC_LOG_DEBUG("spell", "SavePetToDB petentry %i, petnumber %i, slotID %i ownerid %i", GetEntry(), m_charmInfo->GetPetNumber(), curentSlot, GetOwnerGUID());
 
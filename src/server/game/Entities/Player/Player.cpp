@@ -85,6 +85,7 @@
 #include "ScenarioMgr.h"
 #include "ObjectVisitors.hpp"
 
+#include <atomic>
 
 #define ZONE_UPDATE_INTERVAL (1*IN_MILLISECONDS)
 
@@ -775,6 +776,8 @@ Player::Player(WorldSession* session) : Unit(true), m_achievementMgr(this), m_re
     m_areaUpdateId = 0;
 
     m_nextSave = sWorld->getIntConfig(CONFIG_INTERVAL_SAVE);
+    memset(m_savedSectionDigest, 0, sizeof(m_savedSectionDigest));
+    m_saveFailed = std::make_shared<std::atomic<bool>>(false);
 
     _resurrectionData = NULL;
 
@@ -2689,6 +2692,12 @@ bool Player::TeleportTo(uint32 mapid, float x, float y, float z, float orientati
             SetSemaphoreTeleportNear(false);
             //setup delayed teleport flag
             SetDelayedTeleportFlag(IsCanDelayTeleport());
+            //leaving a map updated as several regions is delayed until all of them are done
+            if (!IsHasDelayedTeleport() && oldmap && oldmap->IsRegionUpdateInProgress())
+            {
+                SetDelayedTeleportFlag(true);
+                oldmap->AddDelayedTeleport(this);
+            }
             //if teleport spell is casted in Unit::Update() func
             //then we need to delay it until update process will be finished
             if (IsHasDelayedTeleport())
@@ -19193,6 +19202,7 @@ bool Player::LoadFromDB(uint32 guid, SQLQueryHolder *holder)
 
     _LoadGroup(holder->GetPreparedResult(PLAYER_LOGIN_QUERY_LOADGROUP));
     _LoadLootCooldown(holder->GetPreparedResult(PLAYER_LOGIN_QUERY_LOAD_LOOTCOOLDOWN));
+    _LoadControlableGuardianActionBarInfo(holder->GetPreparedResult(PLAYER_LOGIN_QUERY_LOAD_CG_ACTION_BAR_INFO));
 
     _LoadCurrency(holder->GetPreparedResult(PLAYER_LOGIN_QUERY_LOADCURRENCY));
 
@@ -20976,6 +20986,19 @@ void Player::_LoadLootCooldown(PreparedQueryResult result)
     while (result->NextRow());
 }
 
+void Player::_LoadControlableGuardianActionBarInfo(PreparedQueryResult result)
+{
+    if (!result)
+        return;
+
+    do
+    {
+        Field* fields = result->Fetch();
+        m_CGActionBarInfo[fields[0].GetUInt32()] = fields[1].GetUInt16();
+    }
+    while (result->NextRow());
+}
+
 void Player::_SaveLootCooldown(SQLTransaction& trans)
 {
     PreparedStatement* stmt = NULL;
@@ -21545,6 +21568,14 @@ bool Player::_LoadHomeBind(PreparedQueryResult result)
 /***                   SAVE SYSTEM                     ***/
 /*********************************************************/
 
+namespace
+{
+    std::atomic<uint64> SavesCount(0);
+    std::atomic<uint64> StatementsWritten(0);
+    std::atomic<uint64> StatementsSkipped(0);
+    std::atomic<uint64> BytesSkipped(0);
+}
+
 void Player::SaveToDB(bool create /*=false*/)
 {
     // delay auto save at any saves (manual, in code, or autosave)
@@ -21563,27 +21594,10 @@ void Player::SaveToDB(bool create /*=false*/)
     TC_LOG_DEBUG("server", "The value of player %s at save: ", m_name.c_str());
     outDebugValues();
 
-    if (m_vis)
-    {
-        std::ostringstream ps;
-        ps << "REPLACE INTO character_visuals (guid, head, shoulders, chest, waist, legs, feet, wrists, hands, back, main, off, ranged, tabard, shirt) VALUES ("
-            << GetGUIDLow() << ", "
-            << m_vis->m_visHead << ", "
-            << m_vis->m_visShoulders << ", "
-            << m_vis->m_visChest << ", "
-            << m_vis->m_visWaist << ", "
-            << m_vis->m_visLegs << ", "
-            << m_vis->m_visFeet << ", "
-            << m_vis->m_visWrists << ", "
-            << m_vis->m_visHands << ", "
-            << m_vis->m_visBack << ", "
-            << m_vis->m_visMainhand << ", "
-            << m_vis->m_visOffhand << ", "
-            << m_vis->m_visRanged << ", "
-            << m_vis->m_visTabard << ", "
-            << m_vis->m_visShirt << ")";
-        CharacterDatabase.Execute(ps.str().c_str());
-    }
+    // a new character has nothing in the db yet, and a save that did not
+    // commit left the rows behind the digests it recorded
+    if (m_saveFailed->exchange(false) || create)
+        memset(m_savedSectionDigest, 0, sizeof(m_savedSectionDigest));
 
     PreparedStatement* stmt = NULL;
     uint8 index = 0;
@@ -21853,13 +21867,16 @@ void Player::SaveToDB(bool create /*=false*/)
     }
 
     SQLTransaction trans = CharacterDatabase.BeginTransaction();
+    trans->SetFailureFlag(m_saveFailed);
 
     trans->Append(stmt);
 
+    _SaveIfChanged(trans, PLAYER_SAVE_VISUALS, &Player::_SaveVisuals);
+
     if (m_mailsUpdated)                                     //save mails only when needed
         _SaveMail(trans);
 
-    _SaveBGData(trans);
+    _SaveIfChanged(trans, PLAYER_SAVE_BG_DATA, &Player::_SaveBGData);
     _SaveInventory(trans);
     _SaveVoidStorage(trans);
     _SaveQuestStatus(trans);
@@ -21868,30 +21885,33 @@ void Player::SaveToDB(bool create /*=false*/)
     _SaveSeasonalQuestStatus(trans);
     _SaveTalents(trans);
     _SaveSpells(trans);
-    _SaveSpellCooldowns(trans);
+    _SaveIfChanged(trans, PLAYER_SAVE_SPELL_COOLDOWNS, &Player::_SaveSpellCooldowns);
     _SaveActions(trans);
-    _SaveAuras(trans);
+    _SaveIfChanged(trans, PLAYER_SAVE_AURAS, &Player::_SaveAuras);
     _SaveSkills(trans);
     m_achievementMgr.SaveToDB(trans);
     m_reputationMgr.SaveToDB(trans);
     _SaveEquipmentSets(trans);
     GetSession()->SaveTutorialsData(trans);                 // changed only while character in game
-    _SaveGlyphs(trans);
-    _SaveInstanceTimeRestrictions(trans);
+    _SaveIfChanged(trans, PLAYER_SAVE_GLYPHS, &Player::_SaveGlyphs);
+    _SaveIfChanged(trans, PLAYER_SAVE_INSTANCE_TIMES, &Player::_SaveInstanceTimeRestrictions);
     _SaveCurrency(trans);
-    _SaveCUFProfiles(trans);
+    _SaveIfChanged(trans, PLAYER_SAVE_CUF_PROFILES, &Player::_SaveCUFProfiles);
     _SaveArchaeology(trans);
     _SaveBattlePets(trans);
-    _SaveBattlePetSlots(trans);
+    _SaveIfChanged(trans, PLAYER_SAVE_BATTLE_PET_SLOTS, &Player::_SaveBattlePetSlots);
     _SaveHonor();
     _SaveLootCooldown(trans);
 
     // check if stats should only be saved on logout
     // save stats can be out of transaction
     if (m_session->isLogingOut() || !sWorld->getBoolConfig(CONFIG_STATS_SAVE_ONLY_ON_LOGOUT))
-        _SaveStats(trans);
+        _SaveIfChanged(trans, PLAYER_SAVE_STATS, &Player::_SaveStats);
 
-    CharacterDatabase.CommitTransaction(trans);
+    ++SavesCount;
+    StatementsWritten += trans->GetSize();
+
+    CharacterDatabase.CommitTransaction(trans, GetGUIDLow());
 
     // save pet (hunter pet level and experience and all type pets health/mana).
     if (Pet* pet = GetPet())
@@ -22050,6 +22070,62 @@ void Player::SaveGoldToDB(SQLTransaction& trans)
     trans->Append(stmt);
 }
 
+Player::SaveStats Player::GetSaveStats()
+{
+    SaveStats stats;
+    stats.saves = SavesCount;
+    stats.statementsWritten = StatementsWritten;
+    stats.statementsSkipped = StatementsSkipped;
+    stats.bytesSkipped = BytesSkipped;
+    return stats;
+}
+
+// Builds the statements of a section in their own transaction and only appends them to trans
+// if they differ from what the previous save wrote, the db rows are the same otherwise.
+// The digest is taken before the save commits, SaveToDB forgets all of them once one fails.
+void Player::_SaveIfChanged(SQLTransaction& trans, PlayerSaveSection section, void (Player::*saver)(SQLTransaction&))
+{
+    SQLTransaction sectionTrans = CharacterDatabase.BeginTransaction();
+    (this->*saver)(sectionTrans);
+
+    size_t dataSize;
+    uint64 digest = sectionTrans->GetDigest(dataSize);
+    if (digest == m_savedSectionDigest[section])
+    {
+        StatementsSkipped += sectionTrans->GetSize();
+        BytesSkipped += dataSize;
+        return;
+    }
+
+    m_savedSectionDigest[section] = digest;
+    sectionTrans->MoveTo(*trans);
+}
+
+void Player::_SaveVisuals(SQLTransaction& trans)
+{
+    if (!m_vis)
+        return;
+
+    std::ostringstream ps;
+    ps << "REPLACE INTO character_visuals (guid, head, shoulders, chest, waist, legs, feet, wrists, hands, back, main, off, ranged, tabard, shirt) VALUES ("
+        << GetGUIDLow() << ", "
+        << m_vis->m_visHead << ", "
+        << m_vis->m_visShoulders << ", "
+        << m_vis->m_visChest << ", "
+        << m_vis->m_visWaist << ", "
+        << m_vis->m_visLegs << ", "
+        << m_vis->m_visFeet << ", "
+        << m_vis->m_visWrists << ", "
+        << m_vis->m_visHands << ", "
+        << m_vis->m_visBack << ", "
+        << m_vis->m_visMainhand << ", "
+        << m_vis->m_visOffhand << ", "
+        << m_vis->m_visRanged << ", "
+        << m_vis->m_visTabard << ", "
+        << m_vis->m_visShirt << ")";
+    trans->Append(ps.str().c_str());
+}
+
 void Player::_SaveActions(SQLTransaction& trans)
 {
     PreparedStatement* stmt = NULL;
@@ -29558,15 +29634,24 @@ void Player::ActivateSpec(uint8 spec)
     InitSpellForLevel();
     _ApplyOrRemoveItemEquipDependentAuras(0, false);
 
+    // buttons of the previous spec are saved above, the new ones are sent once loaded
+    m_actionButtons.clear();
+
+    PreparedStatement* stmt = CharacterDatabase.GetPreparedStatement(CHAR_SEL_CHARACTER_ACTIONS_SPEC);
+    stmt->setUInt32(0, GetGUIDLow());
+    stmt->setUInt8(1, GetActiveSpec());
+
+    WorldSession* session = GetSession();
+    session->AddQueryCallback(CharacterDatabase.AsyncQuery(stmt), [session, spec](PreparedQueryResult result)
     {
-        PreparedStatement* stmt = CharacterDatabase.GetPreparedStatement(CHAR_SEL_CHARACTER_ACTIONS_SPEC);
-        stmt->setUInt32(0, GetGUIDLow());
-        stmt->setUInt8(1, GetActiveSpec());
-        if (PreparedQueryResult result = CharacterDatabase.Query(stmt))
-            _LoadActions(result);
-    }
+        // the player may have logged out or swapped again meanwhile
+        Player* player = session->GetPlayer();
+        if (!player || player->GetActiveSpec() != spec)
+            return;
 
-    SendActionButtons(1);
+        player->_LoadActions(result);
+        player->SendActionButtons(1);
+    });
     InitialPowers();
 
     //Arena Update
@@ -31581,39 +31666,13 @@ UnitMoveType Player::GetMovementType(uint32 moveflags)
     return MOVE_RUN;
 }
 
-uint32 Player::LoadControlableGuardianActionBarInfo(uint32 entry)
+uint32 Player::GetControlableGuardianActionBarInfo(uint32 entry) const
 {
-    if (!m_CGActionBarInfo.empty())
-    {
-        std::map<uint32, uint16>::iterator itr = m_CGActionBarInfo.find(entry);
-        if (itr != m_CGActionBarInfo.end())
-            return itr->second;
-    }
-
-    uint32 infoMask = 0;
-
-    PreparedStatement* stmt = CharacterDatabase.GetPreparedStatement(CHAR_SEL_CG_ACTION_BAR_INFO);
-    stmt->setUInt64(0, GetGUID());
-    PreparedQueryResult result = CharacterDatabase.Query(stmt);
-    
-    if (result)
-    {
-        do
-        {
-            Field* fields = result->Fetch();
-
-            uint32 _entry = fields[0].GetUInt32();
-            uint16 _infoMask = fields[1].GetUInt16();
-
-            m_CGActionBarInfo[_entry] = _infoMask;
-
-            if (_entry == entry)
-                infoMask = _infoMask;
-
-        } while (result->NextRow());
-    }
+    std::map<uint32, uint16>::const_iterator itr = m_CGActionBarInfo.find(entry);
+    if (itr != m_CGActionBarInfo.end())
+        return itr->second;
 
-    return infoMask;
+    return 0;
 }
 
 void Player::SaveControlableGuardianActionBarInfo(uint32 entry, uint16 infoMask)
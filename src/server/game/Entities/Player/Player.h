@@ -912,10 +912,26 @@ enum PlayerLoginQueryIndex
     PLAYER_LOGIN_QUERY_LOAD_PERSONAL_RATE           = 42,
     PLAYER_LOGIN_QUERY_LOAD_VISUAL                  = 43,
     PLAYER_LOGIN_QUERY_LOAD_LOOTCOOLDOWN            = 44,
+    PLAYER_LOGIN_QUERY_LOAD_CG_ACTION_BAR_INFO      = 45,
 
     MAX_PLAYER_LOGIN_QUERY
 };
 
+// Parts of the character rewritten as a whole on every save, skipped while their content doesn't change
+enum PlayerSaveSection
+{
+    PLAYER_SAVE_VISUALS,
+    PLAYER_SAVE_BG_DATA,
+    PLAYER_SAVE_SPELL_COOLDOWNS,
+    PLAYER_SAVE_AURAS,
+    PLAYER_SAVE_GLYPHS,
+    PLAYER_SAVE_INSTANCE_TIMES,
+    PLAYER_SAVE_CUF_PROFILES,
+    PLAYER_SAVE_BATTLE_PET_SLOTS,
+    PLAYER_SAVE_STATS,
+    MAX_PLAYER_SAVE_SECTIONS
+};
+
 enum PlayerDelayedOperations
 {
     DELAYED_SAVE_PLAYER         = 0x01,
@@ -2035,6 +2051,16 @@ class Player : public Unit, public GridObject<Player>
         void SaveInventoryAndGoldToDB(SQLTransaction& trans);                    // fast save function for item/money cheating preventing
         void SaveGoldToDB(SQLTransaction& trans);
 
+        struct SaveStats
+        {
+            uint64 saves;
+            uint64 statementsWritten;
+            uint64 statementsSkipped;
+            uint64 bytesSkipped;
+        };
+
+        static SaveStats GetSaveStats();
+
         static void SetUInt32ValueInArray(Tokenizer& data, uint16 index, uint32 value);
         static void SetFloatValueInArray(Tokenizer& data, uint16 index, float value);
         static void Customize(uint64 guid, uint8 gender, uint8 skin, uint8 face, uint8 hairStyle, uint8 hairColor, uint8 facialHair);
@@ -2633,6 +2659,12 @@ class Player : public Unit, public GridObject<Player>
         void learnSkillRewardedSpells(uint32 id, uint32 value);
 
         WorldLocation& GetTeleportDest() { return m_teleport_dest; }
+        // far teleport delayed by a region update, see Map::AddDelayedTeleport()
+        void ExecuteDelayedTeleport()
+        {
+            if (IsHasDelayedTeleport())
+                TeleportTo(m_teleport_dest, m_teleport_options);
+        }
         bool IsBeingTeleported() const { return mSemaphoreTeleport_Near || mSemaphoreTeleport_Far; }
         bool IsBeingTeleportedNear() const { return mSemaphoreTeleport_Near; }
         bool IsBeingTeleportedFar() const { return mSemaphoreTeleport_Far; }
@@ -3402,11 +3434,14 @@ class Player : public Unit, public GridObject<Player>
         void _LoadBattlePetSlots(PreparedQueryResult result);
         void _LoadHonor();
         void _LoadLootCooldown(PreparedQueryResult result);
+        void _LoadControlableGuardianActionBarInfo(PreparedQueryResult result);
 
         /*********************************************************/
         /***                   SAVE SYSTEM                     ***/
         /*********************************************************/
 
+        void _SaveIfChanged(SQLTransaction& trans, PlayerSaveSection section, void (Player::*saver)(SQLTransaction&));
+        void _SaveVisuals(SQLTransaction& trans);
         void _SaveActions(SQLTransaction& trans);
         void _SaveAuras(SQLTransaction& trans);
         void _SaveInventory(SQLTransaction& trans);
@@ -3453,6 +3488,8 @@ class Player : public Unit, public GridObject<Player>
 
         uint32 m_team;
         uint32 m_nextSave;
+        uint64 m_savedSectionDigest[MAX_PLAYER_SAVE_SECTIONS];  // digest of each section as last written, 0 if never
+        std::shared_ptr<std::atomic<bool>> m_saveFailed;        // set by the db thread if a save did not commit
         time_t m_speakTime;
         uint32 m_speakCount;
         Difficulty m_dungeonDifficulty;
@@ -3609,7 +3646,7 @@ class Player : public Unit, public GridObject<Player>
         bool CheckZAxis(uint32 opcode, float delta, float new_x, float new_y, float new_z, uint32 cur_mflags, uint32 new_mflags);
         UnitMoveType GetMovementType(uint32 moveFlags);
 
-        uint32 LoadControlableGuardianActionBarInfo(uint32 entry);
+        uint32 GetControlableGuardianActionBarInfo(uint32 entry) const;
         void SaveControlableGuardianActionBarInfo(uint32 entry, uint16 infoMask);
 
         std::map<uint32, uint16> m_CGActionBarInfo;
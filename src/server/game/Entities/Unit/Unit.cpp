@@ -101,6 +101,19 @@ static bool isDamageCapAura[TOTAL_AURAS];
 // Prepare lists
 static bool procPrepared = InitTriggerAuraData();
 
+// Orders Unit::m_appliedAuraIndex by spell id
+struct AppliedAuraIndexOrder
+{
+    bool operator()(std::pair<uint32, AuraApplication*> const& left, uint32 right) const { return left.first < right; }
+    bool operator()(uint32 left, std::pair<uint32, AuraApplication*> const& right) const { return left < right.first; }
+};
+
+// Orders Unit::m_procAuraIndex by spell id
+struct ProcAuraIndexOrder
+{
+    bool operator()(uint32 left, std::pair<uint32, AuraApplication*> const& right) const { return left < right.second->GetBase()->GetId(); }
+};
+
 DamageInfo::DamageInfo(Unit* _attacker, Unit* _victim, uint32 _damage, SpellInfo const* _spellInfo, SpellSchoolMask _schoolMask, DamageEffectType _damageType, uint32 m_damageBeforeHit)
 : m_attacker(_attacker), m_victim(_victim), m_damage(_damage), m_spellInfo(_spellInfo), m_schoolMask(_schoolMask),
 m_damageType(_damageType), m_attackType(BASE_ATTACK), m_damageBeforeHit(m_damageBeforeHit)
@@ -230,7 +243,8 @@ Unit::Unit(bool isWorldObject): WorldObject(isWorldObject)
     for (uint8 i = 0; i < MAX_GAMEOBJECT_SLOT; ++i)
         m_ObjectSlot[i] = 0;
 
-    m_auraUpdateIterator = m_ownedAuras.end();
+    m_auraClock = 0;
+    m_procAuraIndexGeneration = 0;
 
     m_interruptMask = 0;
     m_transform = 0;
@@ -2096,7 +2110,7 @@ void Unit::CalcAbsorbResist(Unit* victim, SpellSchoolMask schoolMask, DamageEffe
     // We're going to call functions which can modify content of the list during iteration over it's elements
     // Let's copy the list so we can prevent iterator invalidation
     AuraEffectList vSchoolAbsorbCopy(victim->GetAuraEffectsByType(SPELL_AURA_SCHOOL_ABSORB));
-    vSchoolAbsorbCopy.sort(Trinity::AbsorbAuraOrderPred());
+    std::stable_sort(vSchoolAbsorbCopy.begin(), vSchoolAbsorbCopy.end(), Trinity::AbsorbAuraOrderPred());
 
     // absorb without mana cost
     for (AuraEffectList::iterator itr = vSchoolAbsorbCopy.begin(); (itr != vSchoolAbsorbCopy.end()) && (dmgInfo.GetDamage() > 0); ++itr)
@@ -3451,22 +3465,35 @@ void Unit::_UpdateSpells(uint32 time)
         }
     }
 
-    // m_auraUpdateIterator can be updated in indirect called code at aura remove to skip next planned to update but removed auras
-    for (m_auraUpdateIterator = m_ownedAuras.begin(); m_auraUpdateIterator != m_ownedAuras.end();)
+    uint64 const now = m_auraClock + time;
+
+    // only auras with something due are updated, each with the time elapsed
+    // since its last update. Auras added or changed meanwhile are queued at
+    // m_auraClock + 1 and still get their update in this pass
+    while (!m_auraUpdateQueue.empty() && std::get<0>(*m_auraUpdateQueue.begin()) <= now)
     {
-        Aura* i_aura = m_auraUpdateIterator->second;
-        ++m_auraUpdateIterator;                            // need shift to next for allow update if need into aura update
-        i_aura->UpdateOwner(time, this);
+        Aura* aura = std::get<2>(*m_auraUpdateQueue.begin());
+        m_auraUpdateQueue.erase(m_auraUpdateQueue.begin());
+        aura->SetUpdateQueueTime(0);
+
+        uint32 const diff = uint32(now - aura->GetUpdateClock());
+        aura->SetUpdateClock(&m_auraClock, now);
+        aura->UpdateOwner(diff, this);
+
+        m_updatedAuras.push_back(aura);
+        if (!aura->IsRemoved())
+            ScheduleAuraUpdate(aura, now + aura->GetUpdateDelay());
     }
 
+    m_auraClock = now;
+
     // remove expired auras - do that after updates(used in scripts?)
-    for (AuraMap::iterator i = m_ownedAuras.begin(); i != m_ownedAuras.end();)
-    {
-        if (i->second->IsExpired())
-            RemoveOwnedAura(i, AURA_REMOVE_BY_EXPIRE);
-        else
-            ++i;
-    }
+    // only updated auras can have run out
+    for (Aura* aura : m_updatedAuras)
+        if (!aura->IsRemoved() && aura->IsExpired())
+            RemoveOwnedAura(aura, AURA_REMOVE_BY_EXPIRE);
+
+    m_updatedAuras.clear();
 
     for (VisibleAuraMap::iterator itr = m_visibleAuras.begin(); itr != m_visibleAuras.end(); ++itr)
         if (itr->second->IsNeedClientUpdate())
@@ -3885,6 +3912,9 @@ void Unit::_AddAura(UnitAura* aura, Unit* caster)
 
     m_ownedAuras.insert(AuraMap::value_type(aura->GetId(), aura));
 
+    aura->SetUpdateClock(&m_auraClock, m_auraClock);
+    ScheduleAuraUpdate(aura, m_auraClock + 1);
+
     _RemoveNoStackAurasDueToAura(aura);
 
     if (aura->IsRemoved())
@@ -3949,6 +3979,9 @@ AuraApplication * Unit::_CreateAuraApplication(Aura* aura, uint32 effMask)
 
     AuraApplication * aurApp = new AuraApplication(this, caster, aura, effMask);
     m_appliedAuras.insert(AuraApplicationMap::value_type(aurId, aurApp));
+    m_appliedAuraIndex.insert(std::upper_bound(m_appliedAuraIndex.begin(), m_appliedAuraIndex.end(), aurId, AppliedAuraIndexOrder()),
+        AppliedAuraIndex::value_type(aurId, aurApp));
+    _AddToProcAuraIndex(aurApp);
 
     if (aurSpellInfo->AuraInterruptFlags)
     {
@@ -4039,6 +4072,9 @@ void Unit::_UnapplyAura(AuraApplicationMap::iterator &i, AuraRemoveMode removeMo
 
     // Remove all pointers from lists here to prevent possible pointer invalidation on spellcast/auraapply/auraremove
     m_appliedAuras.erase(i);
+    m_appliedAuraIndex.erase(std::find(std::lower_bound(m_appliedAuraIndex.begin(), m_appliedAuraIndex.end(), aura->GetId(), AppliedAuraIndexOrder()),
+        m_appliedAuraIndex.end(), AppliedAuraIndex::value_type(aura->GetId(), aurApp)));
+    _RemoveFromProcAuraIndex(aurApp);
 
     if (aura->GetSpellInfo()->AuraInterruptFlags)
     {
@@ -4174,14 +4210,127 @@ void Unit::_RemoveNoStackAurasDueToAura(Aura* aura)
     }
 }
 
+void Unit::_AddToProcAuraIndex(AuraApplication* aurApp)
+{
+    if (uint32 procFlags = sSpellMgr->GetSpellProcFlagsMask(aurApp->GetBase()->GetSpellInfo()))
+        m_procAuraIndex.insert(std::upper_bound(m_procAuraIndex.begin(), m_procAuraIndex.end(), aurApp->GetBase()->GetId(), ProcAuraIndexOrder()),
+            ProcAuraIndex::value_type(procFlags, aurApp));
+}
+
+void Unit::_RemoveFromProcAuraIndex(AuraApplication* aurApp)
+{
+    for (ProcAuraIndex::iterator itr = m_procAuraIndex.begin(); itr != m_procAuraIndex.end(); ++itr)
+    {
+        if (itr->second == aurApp)
+        {
+            m_procAuraIndex.erase(itr);
+            return;
+        }
+    }
+}
+
+Unit::ProcAuraIndex const& Unit::_GetProcAuraIndex()
+{
+    // proc tables were reloaded since the index was built
+    if (m_procAuraIndexGeneration != sSpellMgr->GetSpellProcDataGeneration())
+    {
+        m_procAuraIndexGeneration = sSpellMgr->GetSpellProcDataGeneration();
+        m_procAuraIndex.clear();
+        for (AuraApplicationMap::const_iterator itr = m_appliedAuras.begin(); itr != m_appliedAuras.end(); ++itr)
+            if (uint32 procFlags = sSpellMgr->GetSpellProcFlagsMask(itr->second->GetBase()->GetSpellInfo()))
+                m_procAuraIndex.push_back(ProcAuraIndex::value_type(procFlags, itr->second));
+    }
+
+    return m_procAuraIndex;
+}
+
 void Unit::_RegisterAuraEffect(AuraEffect* aurEff, bool apply)
 {
+    AuraEffectList& effects = m_modAuras[aurEff->GetAuraType()];
+
     m_auraEffectListLock.acquire();
     if (apply)
-        m_modAuras[aurEff->GetAuraType()].emplace_back(aurEff);
+        effects.emplace_back(aurEff);
     else
-        m_modAuras[aurEff->GetAuraType()].remove(aurEff);
+        effects.erase(std::remove(effects.begin(), effects.end(), aurEff), effects.end());
     m_auraEffectListLock.release();
+
+    InvalidateAuraTotals(aurEff->GetAuraType());
+}
+
+void Unit::ScheduleAuraUpdate(Aura* aura, uint64 time)
+{
+    RecursiveGuard _aura_lock(m_aura_lock);
+
+    if (uint64 queued = aura->GetUpdateQueueTime())
+        m_auraUpdateQueue.erase(std::make_tuple(queued, aura->GetId(), aura));
+
+    m_auraUpdateQueue.insert(std::make_tuple(time, aura->GetId(), aura));
+    aura->SetUpdateQueueTime(time);
+}
+
+void Unit::UnscheduleAuraUpdate(Aura* aura)
+{
+    RecursiveGuard _aura_lock(m_aura_lock);
+
+    if (uint64 queued = aura->GetUpdateQueueTime())
+        m_auraUpdateQueue.erase(std::make_tuple(queued, aura->GetId(), aura));
+
+    aura->SetUpdateQueueTime(0);
+
+    // timers of a removed aura stay as they are now
+    aura->SyncTimers();
+    aura->SetUpdateClock(NULL, 0);
+}
+
+void Unit::InvalidateAuraTotals(AuraType auratype)
+{
+    TRINITY_GUARD(ACE_Thread_Mutex, m_auraEffectListLock);
+
+    std::unordered_map<uint32, AuraTotalCache>::iterator itr = m_auraTotals.find(auratype);
+    if (itr == m_auraTotals.end())
+        return;
+
+    ++itr->second.generation;
+    itr->second.entries.clear();
+}
+
+bool Unit::GetCachedAuraTotal(AuraType auratype, uint32 variant, uint32 arg, double& value, uint32& generation) const
+{
+    TRINITY_GUARD(ACE_Thread_Mutex, m_auraEffectListLock);
+
+    AuraTotalCache const& cache = m_auraTotals[auratype];
+    generation = cache.generation;
+
+    for (AuraTotalCache::Entry const& entry : cache.entries)
+    {
+        if (entry.variant == variant && entry.arg == arg)
+        {
+            value = entry.value;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void Unit::SetCachedAuraTotal(AuraType auratype, uint32 variant, uint32 arg, double value, uint32 generation) const
+{
+    TRINITY_GUARD(ACE_Thread_Mutex, m_auraEffectListLock);
+
+    AuraTotalCache& cache = m_auraTotals[auratype];
+    if (cache.generation != generation)
+        return;
+
+    // misc masks are few per aura type, this only guards against unbounded growth
+    if (cache.entries.size() >= 16)
+        cache.entries.clear();
+
+    AuraTotalCache::Entry entry;
+    entry.variant = variant;
+    entry.arg = arg;
+    entry.value = value;
+    cache.entries.push_back(entry);
 }
 
 // All aura base removes should go threw this function!
@@ -4191,9 +4340,7 @@ void Unit::RemoveOwnedAura(AuraMap::iterator &i, AuraRemoveMode removeMode)
     Aura* aura = i->second;
     ASSERT(!aura->IsRemoved());
 
-    // if unit currently update aura list then make safe update iterator shift to next
-    if (m_auraUpdateIterator == i)
-        ++m_auraUpdateIterator;
+    UnscheduleAuraUpdate(aura);
 
     m_ownedAurasLock.acquire();
     m_ownedAuras.erase(i);
@@ -4933,7 +5080,7 @@ void Unit::_ApplyAllAuraStatMods()
         (*i).second->GetBase()->HandleAllEffects(i->second, AURA_EFFECT_HANDLE_STAT, true);
 }
 
-std::list<AuraEffect*> Unit::GetAuraEffectsByMechanic(uint32 mechanic_mask) const
+Unit::AuraEffectList Unit::GetAuraEffectsByMechanic(uint32 mechanic_mask) const
 {
     AuraEffectList list;
     for (AuraApplicationMap::const_iterator iter = m_appliedAuras.begin(); iter != m_appliedAuras.end(); ++iter)
@@ -5006,7 +5153,8 @@ AuraEffect* Unit::GetAuraEffect(AuraType type, SpellFamilyNames family, uint32 f
 
 AuraApplication * Unit::GetAuraApplication(uint32 spellId, uint64 casterGUID, uint64 itemCasterGUID, uint32 reqEffMask, AuraApplication * except) const
 {
-    for (AuraApplicationMap::const_iterator itr = m_appliedAuras.lower_bound(spellId); itr != m_appliedAuras.upper_bound(spellId); ++itr)
+    AppliedAuraIndex::const_iterator itr = std::lower_bound(m_appliedAuraIndex.begin(), m_appliedAuraIndex.end(), spellId, AppliedAuraIndexOrder());
+    for (; itr != m_appliedAuraIndex.end() && itr->first == spellId; ++itr)
     {
         Aura const* aura = itr->second->GetBase();
         if (((aura->GetEffectMask() & reqEffMask) == reqEffMask) && (!casterGUID || aura->GetCasterGUID() == casterGUID) && (!itemCasterGUID || aura->GetCastItemGUID() == itemCasterGUID) && (!except || except != itr->second))
@@ -5302,6 +5450,7 @@ uint32 Unit::GetDiseasesByCaster(uint64 casterGUID, bool remove)
     uint32 diseases = 0;
     for (AuraType const* itr = &diseaseAuraTypes[0]; itr && itr[0] != SPELL_AURA_NONE; ++itr)
     {
+        // removing an aura shifts the list, the scan restarts after every removal
         for (AuraEffectList::iterator i = m_modAuras[*itr].begin(); i != m_modAuras[*itr].end();)
         {
             // Get auras with disease dispel type by caster
@@ -5346,7 +5495,7 @@ uint32 Unit::GetDoTsByCaster(uint64 casterGUID) const
     return dots;
 }
 
-std::list<AuraEffect*> Unit::GetTotalNotStuckAuraEffectByType(AuraType auratype) const
+Unit::AuraEffectList Unit::GetTotalNotStuckAuraEffectByType(AuraType auratype) const
 {
     AuraEffectList FinishedEffectList;
     std::multimap<SpellGroup, AuraEffect*> SameEffectSpellGroup;
@@ -5369,6 +5518,15 @@ std::list<AuraEffect*> Unit::GetTotalNotStuckAuraEffectByType(AuraType auratype)
 
 int32 Unit::GetTotalAuraModifier(AuraType auratype, bool raid) const
 {
+    if (m_modAuras[auratype].empty())
+        return 0;
+
+    uint32 const variant = raid ? AURA_TOTAL_MODIFIER_RAID : AURA_TOTAL_MODIFIER;
+    uint32 generation;
+    double cached;
+    if (GetCachedAuraTotal(auratype, variant, 0, cached, generation))
+        return int32(cached);
+
     std::map<SpellGroup, int32> SameEffectSpellGroup;
     int32 modifier = 0;
     int32 raidModifier = 0;
@@ -5393,7 +5551,9 @@ int32 Unit::GetTotalAuraModifier(AuraType auratype, bool raid) const
     for (std::map<SpellGroup, int32>::const_iterator itr = SameEffectSpellGroup.begin(); itr != SameEffectSpellGroup.end(); ++itr)
         modifier += itr->second;
 
-    return modifier + raidModifier;
+    modifier += raidModifier;
+    SetCachedAuraTotal(auratype, variant, 0, modifier, generation);
+    return modifier;
 }
 
 int32 Unit::GetTotalForAurasModifier(std::list<AuraType> *auratypelist) const
@@ -5460,6 +5620,15 @@ float Unit::GetTotalForAurasMultiplier(std::list<AuraType> *auratypelist) const
 
 float Unit::GetTotalAuraMultiplier(AuraType auratype, bool raid) const
 {
+    if (m_modAuras[auratype].empty())
+        return 1.0f;
+
+    uint32 const variant = raid ? AURA_TOTAL_MULTIPLIER_RAID : AURA_TOTAL_MULTIPLIER;
+    uint32 generation;
+    double cached;
+    if (GetCachedAuraTotal(auratype, variant, 0, cached, generation))
+        return float(cached);
+
     std::map<SpellGroup, int32> SameEffectSpellGroup;
     float multiplier = 1.0f;
     int32 raidModifier = 0;
@@ -5485,6 +5654,7 @@ float Unit::GetTotalAuraMultiplier(AuraType auratype, bool raid) const
     if (raidModifier)
         AddPct(multiplier, raidModifier);
 
+    SetCachedAuraTotal(auratype, variant, 0, multiplier, generation);
     return multiplier;
 }
 
@@ -5512,6 +5682,14 @@ float Unit::GetTotalPositiveAuraMultiplierByMiscMask(AuraType auratype, uint32 m
 
 int32 Unit::GetMaxPositiveAuraModifier(AuraType auratype)
 {
+    if (m_modAuras[auratype].empty())
+        return 0;
+
+    uint32 generation;
+    double cached;
+    if (GetCachedAuraTotal(auratype, AURA_TOTAL_MAX_POSITIVE, 0, cached, generation))
+        return int32(cached);
+
     int32 modifier = 0;
 
     AuraEffectList mTotalAuraList = GetAuraEffectsByType(auratype);
@@ -5524,11 +5702,20 @@ int32 Unit::GetMaxPositiveAuraModifier(AuraType auratype)
                 modifier = eff->GetAmount();
     }
 
+    SetCachedAuraTotal(auratype, AURA_TOTAL_MAX_POSITIVE, 0, modifier, generation);
     return modifier;
 }
 
 int32 Unit::GetMaxNegativeAuraModifier(AuraType auratype) const
 {
+    if (m_modAuras[auratype].empty())
+        return 0;
+
+    uint32 generation;
+    double cached;
+    if (GetCachedAuraTotal(auratype, AURA_TOTAL_MAX_NEGATIVE, 0, cached, generation))
+        return int32(cached);
+
     int32 modifier = 0;
 
     AuraEffectList mTotalAuraList = GetAuraEffectsByType(auratype);
@@ -5541,11 +5728,20 @@ int32 Unit::GetMaxNegativeAuraModifier(AuraType auratype) const
                 modifier = eff->GetAmount();
     }
 
+    SetCachedAuraTotal(auratype, AURA_TOTAL_MAX_NEGATIVE, 0, modifier, generation);
     return modifier;
 }
 
 int32 Unit::GetTotalAuraModifierByMiscMask(AuraType auratype, uint32 misc_mask) const
 {
+    if (m_modAuras[auratype].empty())
+        return 0;
+
+    uint32 generation;
+    double cached;
+    if (GetCachedAuraTotal(auratype, AURA_TOTAL_MODIFIER_MISC_MASK, misc_mask, cached, generation))
+        return int32(cached);
+
     std::map<SpellGroup, int32> SameEffectSpellGroup;
     int32 modifier = 0;
 
@@ -5571,11 +5767,21 @@ int32 Unit::GetTotalAuraModifierByMiscMask(AuraType auratype, uint32 misc_mask)
     for (std::map<SpellGroup, int32>::const_iterator itr = SameEffectSpellGroup.begin(); itr != SameEffectSpellGroup.end(); ++itr)
         modifier += itr->second;
 
+    SetCachedAuraTotal(auratype, AURA_TOTAL_MODIFIER_MISC_MASK, misc_mask, modifier, generation);
     return modifier;
 }
 
 float Unit::GetTotalAuraMultiplierByMiscMask(AuraType auratype, uint32 misc_mask, bool raid, bool miscB) const
 {
+    if (m_modAuras[auratype].empty())
+        return 1.0f;
+
+    uint32 const variant = AURA_TOTAL_MULTIPLIER_MISC_MASK | (raid ? 0x100 : 0) | (miscB ? 0x200 : 0);
+    uint32 generation;
+    double cached;
+    if (GetCachedAuraTotal(auratype, variant, misc_mask, cached, generation))
+        return float(cached);
+
     std::map<SpellGroup, int32> SameEffectSpellGroup;
     float multiplier = 1.0f;
     int32 raidModifier = 0;
@@ -5604,11 +5810,21 @@ float Unit::GetTotalAuraMultiplierByMiscMask(AuraType auratype, uint32 misc_mask
     if (raidModifier)
         AddPct(multiplier, raidModifier);
 
+    SetCachedAuraTotal(auratype, variant, misc_mask, multiplier, generation);
     return multiplier;
 }
 
 int32 Unit::GetMaxPositiveAuraModifierByMiscMask(AuraType auratype, uint32 misc_mask, AuraEffect const* except) const
 {
+    if (m_modAuras[auratype].empty())
+        return 0;
+
+    // results excluding an effect are not cached
+    uint32 generation;
+    double cached;
+    if (!except && GetCachedAuraTotal(auratype, AURA_TOTAL_MAX_POSITIVE_MISC_MASK, misc_mask, cached, generation))
+        return int32(cached);
+
     int32 modifier = 0;
 
     AuraEffectList mTotalAuraList = GetAuraEffectsByType(auratype);
@@ -5620,11 +5836,21 @@ int32 Unit::GetMaxPositiveAuraModifierByMiscMask(AuraType auratype, uint32 misc_
             modifier = (*i)->GetAmount();
     }
 
+    if (!except)
+        SetCachedAuraTotal(auratype, AURA_TOTAL_MAX_POSITIVE_MISC_MASK, misc_mask, modifier, generation);
     return modifier;
 }
 
 int32 Unit::GetMaxNegativeAuraModifierByMiscMask(AuraType auratype, uint32 misc_mask) const
 {
+    if (m_modAuras[auratype].empty())
+        return 0;
+
+    uint32 generation;
+    double cached;
+    if (GetCachedAuraTotal(auratype, AURA_TOTAL_MAX_NEGATIVE_MISC_MASK, misc_mask, cached, generation))
+        return int32(cached);
+
     int32 modifier = 0;
 
     AuraEffectList mTotalAuraList = GetAuraEffectsByType(auratype);
@@ -5637,11 +5863,20 @@ int32 Unit::GetMaxNegativeAuraModifierByMiscMask(AuraType auratype, uint32 misc_
                 modifier = eff->GetAmount();
     }
 
+    SetCachedAuraTotal(auratype, AURA_TOTAL_MAX_NEGATIVE_MISC_MASK, misc_mask, modifier, generation);
     return modifier;
 }
 
 int32 Unit::GetTotalAuraModifierByMiscValue(AuraType auratype, int32 misc_value) const
 {
+    if (m_modAuras[auratype].empty())
+        return 0;
+
+    uint32 generation;
+    double cached;
+    if (GetCachedAuraTotal(auratype, AURA_TOTAL_MODIFIER_MISC_VALUE, uint32(misc_value), cached, generation))
+        return int32(cached);
+
     std::map<SpellGroup, int32> SameEffectSpellGroup;
     int32 modifier = 0;
 
@@ -5659,11 +5894,20 @@ int32 Unit::GetTotalAuraModifierByMiscValue(AuraType auratype, int32 misc_value)
     for (std::map<SpellGroup, int32>::const_iterator itr = SameEffectSpellGroup.begin(); itr != SameEffectSpellGroup.end(); ++itr)
         modifier += itr->second;
 
+    SetCachedAuraTotal(auratype, AURA_TOTAL_MODIFIER_MISC_VALUE, uint32(misc_value), modifier, generation);
     return modifier;
 }
 
 float Unit::GetTotalAuraMultiplierByMiscValue(AuraType auratype, int32 misc_value) const
 {
+    if (m_modAuras[auratype].empty())
+        return 1.0f;
+
+    uint32 generation;
+    double cached;
+    if (GetCachedAuraTotal(auratype, AURA_TOTAL_MULTIPLIER_MISC_VALUE, uint32(misc_value), cached, generation))
+        return float(cached);
+
     std::map<SpellGroup, int32> SameEffectSpellGroup;
     float multiplier = 1.0f;
 
@@ -5681,6 +5925,7 @@ float Unit::GetTotalAuraMultiplierByMiscValue(AuraType auratype, int32 misc_valu
     for (std::map<SpellGroup, int32>::const_iterator itr = SameEffectSpellGroup.begin(); itr != SameEffectSpellGroup.end(); ++itr)
         AddPct(multiplier, itr->second);
 
+    SetCachedAuraTotal(auratype, AURA_TOTAL_MULTIPLIER_MISC_VALUE, uint32(misc_value), multiplier, generation);
     return multiplier;
 }
 
@@ -17978,7 +18223,7 @@ struct ProcTriggeredData
     bool isProcOneEff;
 };
 
-typedef std::list< ProcTriggeredData > ProcTriggeredList;
+typedef std::vector< ProcTriggeredData > ProcTriggeredList;
 
 // List of auras that CAN be trigger but may not exist in spell_proc_event
 // in most case need for drop charges
@@ -18183,14 +18428,21 @@ void Unit::ProcDamageAndSpellFor(bool isVictim, Unit* target, uint32 procFlag, u
     HealInfo healInfo = HealInfo(actor, actionTarget, dmgInfoProc->GetDamage(), procSpell, procSpell ? SpellSchoolMask(procSpell->SchoolMask) : SPELL_SCHOOL_MASK_NORMAL);
     ProcEventInfo eventInfo = ProcEventInfo(actor, actionTarget, target, procFlag, 0, 0, procExtra, NULL, dmgInfoProc, &healInfo);
 
+    // only auras that may proc on one of the event flags are looked at, the
+    // index is walked by position as it has no stable iterators
+    ProcAuraIndex const& procAuras = _GetProcAuraIndex();
     ProcTriggeredList procTriggered;
     // Fill procTriggered list
-    for (AuraApplicationMap::const_iterator itr = GetAppliedAuras().begin(); itr!= GetAppliedAuras().end(); ++itr)
+    for (size_t index = 0; index < procAuras.size(); ++index)
     {
+        if (!(procAuras[index].first & procFlag))
+            continue;
+
+        AuraApplication* aurApp = procAuras[index].second;
         // Do not allow auras to proc from effect triggered by itself
-        if (procAura && procAura->Id == itr->first)
+        if (procAura && procAura->Id == aurApp->GetBase()->GetId())
             continue;
-        ProcTriggeredData triggerData(itr->second->GetBase());
+        ProcTriggeredData triggerData(aurApp->GetBase());
         SpellInfo const* spellProto = triggerData.aura->GetSpellInfo();
 
         if (getLevel() < spellProto->SpellLevel)
@@ -18229,7 +18481,7 @@ void Unit::ProcDamageAndSpellFor(bool isVictim, Unit* target, uint32 procFlag, u
 
         // Custom MoP Script
         // Breath of Fire DoT shoudn't remove Breath of Fire disorientation - Hack Fix
-        if (procSpell && procSpell->Id == 123725 && itr->first == 123393)
+        if (procSpell && procSpell->Id == 123725 && triggerData.aura->GetId() == 123393)
             continue;
 
         if (procSpell && !(procSpell->AuraInterruptFlags & (AURA_INTERRUPT_FLAG_TAKE_DAMAGE)))
@@ -18267,11 +18519,11 @@ void Unit::ProcDamageAndSpellFor(bool isVictim, Unit* target, uint32 procFlag, u
 
         for (uint8 i = 0; i < MAX_SPELL_EFFECTS; ++i)
         {
-            if (itr->second->HasEffect(i))
+            if (aurApp->HasEffect(i))
             {
                 if (!IsTriggeredAtSpellProcEvent(target, spellProto, procSpell, procFlag, procExtra, attType, isVictim, active, triggerData.spellProcEvent, i, triggerData.aura->GetCastItemGUID()))
                     continue;
-                AuraEffect* aurEff = itr->second->GetBase()->GetEffect(i);
+                AuraEffect* aurEff = triggerData.aura->GetEffect(i);
                 // Skip this auras
                 if (isNonTriggerAura[aurEff->GetAuraType()])
                     continue;
@@ -18300,10 +18552,10 @@ void Unit::ProcDamageAndSpellFor(bool isVictim, Unit* target, uint32 procFlag, u
                         break;
                     }
                 if(!foundProc)
-                    procTriggered.push_front(triggerData);
+                    procTriggered.push_back(triggerData);
             }
             else
-                procTriggered.push_front(triggerData);
+                procTriggered.push_back(triggerData);
         }
     }
 
@@ -18318,8 +18570,8 @@ void Unit::ProcDamageAndSpellFor(bool isVictim, Unit* target, uint32 procFlag, u
     if (procExtra & (PROC_EX_INTERNAL_TRIGGERED | PROC_EX_INTERNAL_CANT_PROC))
         SetCantProc(true);
 
-    // Handle effects proceed this time
-    for (ProcTriggeredList::const_iterator i = procTriggered.begin(); i != procTriggered.end(); ++i)
+    // Handle effects proceed this time, latest collected first
+    for (ProcTriggeredList::const_reverse_iterator i = procTriggered.rbegin(); i != procTriggered.rend(); ++i)
     {
         // look for aura in auras list, it may be removed while proc event processing
         if (i->aura->IsRemoved())
@@ -18767,7 +19019,7 @@ void Unit::ProcDamageAndSpellFor(bool isVictim, Unit* target, uint32 procFlag, u
             SetCantProc(false);
 }
 
-void Unit::GetProcAurasTriggeredOnEvent(std::list<AuraApplication*>& aurasTriggeringProc, std::list<AuraApplication*>* procAuras, ProcEventInfo eventInfo)
+void Unit::GetProcAurasTriggeredOnEvent(std::vector<AuraApplication*>& aurasTriggeringProc, std::list<AuraApplication*>* procAuras, ProcEventInfo eventInfo)
 {
     // use provided list of auras which can proc
     if (procAuras)
@@ -18786,12 +19038,17 @@ void Unit::GetProcAurasTriggeredOnEvent(std::list<AuraApplication*>& aurasTrigge
     // or generate one on our own
     else
     {
-        for (AuraApplicationMap::iterator itr = GetAppliedAuras().begin(); itr!= GetAppliedAuras().end(); ++itr)
+        ProcAuraIndex const& indexedAuras = _GetProcAuraIndex();
+        for (size_t index = 0; index < indexedAuras.size(); ++index)
         {
-            if (itr->second->GetBase()->IsProcTriggeredOnEvent(itr->second, eventInfo))
+            if (!(indexedAuras[index].first & eventInfo.GetTypeMask()))
+                continue;
+
+            AuraApplication* aurApp = indexedAuras[index].second;
+            if (aurApp->GetBase()->IsProcTriggeredOnEvent(aurApp, eventInfo))
             {
-                itr->second->GetBase()->PrepareProcToTrigger(itr->second, eventInfo);
-                aurasTriggeringProc.push_back(itr->second);
+                aurApp->GetBase()->PrepareProcToTrigger(aurApp, eventInfo);
+                aurasTriggeringProc.push_back(aurApp);
             }
         }
     }
@@ -18807,12 +19064,12 @@ void Unit::TriggerAurasProcOnEvent(std::list<AuraApplication*>* myProcAuras, std
 {
     // prepare data for self trigger
     ProcEventInfo myProcEventInfo = ProcEventInfo(this, actionTarget, actionTarget, typeMaskActor, spellTypeMask, spellPhaseMask, hitMask, spell, damageInfo, healInfo);
-    std::list<AuraApplication*> myAurasTriggeringProc;
+    std::vector<AuraApplication*> myAurasTriggeringProc;
     GetProcAurasTriggeredOnEvent(myAurasTriggeringProc, myProcAuras, myProcEventInfo);
 
     // prepare data for target trigger
     ProcEventInfo targetProcEventInfo = ProcEventInfo(this, actionTarget, this, typeMaskActionTarget, spellTypeMask, spellPhaseMask, hitMask, spell, damageInfo, healInfo);
-    std::list<AuraApplication*> targetAurasTriggeringProc;
+    std::vector<AuraApplication*> targetAurasTriggeringProc;
     if (typeMaskActionTarget)
         GetProcAurasTriggeredOnEvent(targetAurasTriggeringProc, targetProcAuras, targetProcEventInfo);
 
@@ -18822,9 +19079,9 @@ void Unit::TriggerAurasProcOnEvent(std::list<AuraApplication*>* myProcAuras, std
         TriggerAurasProcOnEvent(targetProcEventInfo, targetAurasTriggeringProc);
 }
 
-void Unit::TriggerAurasProcOnEvent(ProcEventInfo& eventInfo, std::list<AuraApplication*>& aurasTriggeringProc)
+void Unit::TriggerAurasProcOnEvent(ProcEventInfo& eventInfo, std::vector<AuraApplication*>& aurasTriggeringProc)
 {
-    for (std::list<AuraApplication*>::iterator itr = aurasTriggeringProc.begin(); itr != aurasTriggeringProc.end(); ++itr)
+    for (std::vector<AuraApplication*>::iterator itr = aurasTriggeringProc.begin(); itr != aurasTriggeringProc.end(); ++itr)
     {
         if (!(*itr)->GetRemoveMode())
             (*itr)->GetBase()->TriggerProcOnEvent(*itr, eventInfo);
@@ -24043,6 +24300,7 @@ void Unit::UpdateOrientation(float orientation)
 void Unit::UpdateHeight(float newZ)
 {
     SetPositionH(newZ);
+    UpdateGridPosition();
     if (IsVehicle())
         GetVehicleKit()->RelocatePassengers();
 }
@@ -39,6 +39,7 @@
 #include "WorldSession.h"
 #include "Timer.h"
 #include <list>
+#include <tuple>
 #include <mutex>
 #include "../DynamicObject/DynamicObject.h"
 
@@ -1388,7 +1389,7 @@ class Unit : public WorldObject
         typedef std::multimap<uint32,  Aura*> AuraMap;
         typedef std::multimap<uint32,  AuraApplication*> AuraApplicationMap;
         typedef std::multimap<AuraStateType,  AuraApplication*> AuraStateAurasMap;
-        typedef std::list<AuraEffect*> AuraEffectList;
+        typedef std::vector<AuraEffect*> AuraEffectList;
         typedef std::list<Aura*> AuraList;
         typedef std::list<AuraApplication *> AuraApplicationList;
         typedef std::list<DiminishingReturn> Diminishing;
@@ -1661,10 +1662,10 @@ class Unit : public WorldObject
         void ProcDamageAndSpell(Unit* victim, uint32 procAttacker, uint32 procVictim, uint32 procEx, DamageInfo* dmgInfoProc, WeaponAttackType attType = BASE_ATTACK, SpellInfo const* procSpell = NULL, SpellInfo const* procAura = NULL, std::list<uint32>* mSpellModsList = NULL);
         void ProcDamageAndSpellFor(bool isVictim, Unit* target, uint32 procFlag, uint32 procExtra, WeaponAttackType attType, SpellInfo const* procSpell, DamageInfo* dmgInfoProc, SpellInfo const* procAura = NULL, std::list<uint32>* mSpellModsList = NULL);
 
-        void GetProcAurasTriggeredOnEvent(std::list<AuraApplication*>& aurasTriggeringProc, std::list<AuraApplication*>* procAuras, ProcEventInfo eventInfo);
+        void GetProcAurasTriggeredOnEvent(std::vector<AuraApplication*>& aurasTriggeringProc, std::list<AuraApplication*>* procAuras, ProcEventInfo eventInfo);
         void TriggerAurasProcOnEvent(CalcDamageInfo& damageInfo);
         void TriggerAurasProcOnEvent(std::list<AuraApplication*>* myProcAuras, std::list<AuraApplication*>* targetProcAuras, Unit* actionTarget, uint32 typeMaskActor, uint32 typeMaskActionTarget, uint32 spellTypeMask, uint32 spellPhaseMask, uint32 hitMask, Spell* spell, DamageInfo* damageInfo, HealInfo* healInfo);
-        void TriggerAurasProcOnEvent(ProcEventInfo& eventInfo, std::list<AuraApplication*>& procAuras);
+        void TriggerAurasProcOnEvent(ProcEventInfo& eventInfo, std::vector<AuraApplication*>& procAuras);
 
         void HandleEmoteCommand(uint32 anim_id);
         void AttackerStateUpdate (Unit* victim, WeaponAttackType attType = BASE_ATTACK, bool extra = false, uint32 replacementAttackTrigger = 0, uint32 replacementAttackAura = 0);
@@ -1971,6 +1972,11 @@ class Unit : public WorldObject
         void _RemoveNoStackAurasDueToAura(Aura* aura);
         void _RegisterAuraEffect(AuraEffect* aurEff, bool apply);
 
+        // owned auras are only updated when something of them is due
+        uint64 GetAuraClock() const { return m_auraClock; }
+        void ScheduleAuraUpdate(Aura* aura, uint64 time);
+        void UnscheduleAuraUpdate(Aura* aura);
+
         // m_ownedAuras container management
         AuraMap      & GetOwnedAuras()       { return m_ownedAuras; }
         AuraMap const& GetOwnedAuras() const { return m_ownedAuras; }
@@ -2020,6 +2026,11 @@ class Unit : public WorldObject
         void _RemoveAllAuraStatMods();
         void _ApplyAllAuraStatMods();
 
+        // AuraEffectList is a vector, applying or removing an aura effect
+        // invalidates iterators into the list of its type. Only const units
+        // hand out the live list, and its users must not apply or remove
+        // auras while iterating it. Non-const units return a copy that stays
+        // valid while auras change.
         AuraEffectList const& GetAuraEffectsByType(AuraType type) const { return m_modAuras[type]; }
         AuraEffectList GetAuraEffectsByMechanic(uint32 mechanic_mask) const;
         AuraEffectList GetTotalNotStuckAuraEffectByType(AuraType auratype) const;
@@ -2064,6 +2075,10 @@ class Unit : public WorldObject
         uint32 GetDiseasesByCaster(uint64 casterGUID, bool remove = false);
         uint32 GetDoTsByCaster(uint64 casterGUID) const;
 
+        // drops the cached totals of an aura type, called whenever an effect
+        // of that type is registered, unregistered or changes its amount
+        void InvalidateAuraTotals(AuraType auratype);
+
         int32 GetTotalAuraModifier(AuraType auratype, bool raid = false) const;
         int32 GetTotalForAurasModifier(std::list<AuraType> *auratypelist) const;
         float GetTotalForAurasMultiplier(std::list<AuraType> *auratypelist) const;
@@ -2675,10 +2690,66 @@ class Unit : public WorldObject
         AuraMap m_ownedAuras;
         AuraApplicationMap m_appliedAuras;
         AuraList m_removedAuras;
-        AuraMap::iterator m_auraUpdateIterator;
+        // owned auras ordered by the owner clock of their next update
+        typedef std::set<std::tuple<uint64, uint32, Aura*> > AuraUpdateQueue;
+        uint64 m_auraClock;                        // time spent in _UpdateSpells so far
+        AuraUpdateQueue m_auraUpdateQueue;
+        std::vector<Aura*> m_updatedAuras;
         uint32 m_removedAurasCount;
 
         AuraEffectList m_modAuras[TOTAL_AURAS];
+
+        // m_appliedAuras flattened and sorted by spell id for the lookups by
+        // spell id, HasAura and GetAura* are called far more often than
+        // auras are applied or removed
+        typedef std::vector<std::pair<uint32, AuraApplication*> > AppliedAuraIndex;
+        AppliedAuraIndex m_appliedAuraIndex;
+
+        // the applied auras that can proc at all with the union of the proc
+        // flags they may proc on, in m_appliedAuras order so that procs keep
+        // being handled in the same order; rebuilt when the proc tables change
+        typedef std::vector<std::pair<uint32, AuraApplication*> > ProcAuraIndex;
+        ProcAuraIndex m_procAuraIndex;
+        uint32 m_procAuraIndexGeneration;
+
+        // aggregated GetTotalAuraModifier & co results per aura type, the
+        // generation is bumped on invalidation so that a total computed
+        // concurrently with a change is not stored
+        enum AuraTotalVariant
+        {
+            AURA_TOTAL_MODIFIER,
+            AURA_TOTAL_MODIFIER_RAID,
+            AURA_TOTAL_MULTIPLIER,
+            AURA_TOTAL_MULTIPLIER_RAID,
+            AURA_TOTAL_MAX_POSITIVE,
+            AURA_TOTAL_MAX_NEGATIVE,
+            AURA_TOTAL_MODIFIER_MISC_MASK,
+            AURA_TOTAL_MULTIPLIER_MISC_MASK,                // | raid << 8 | miscB << 9
+            AURA_TOTAL_MAX_POSITIVE_MISC_MASK,
+            AURA_TOTAL_MAX_NEGATIVE_MISC_MASK,
+            AURA_TOTAL_MODIFIER_MISC_VALUE,
+            AURA_TOTAL_MULTIPLIER_MISC_VALUE
+        };
+
+        struct AuraTotalCache
+        {
+            struct Entry
+            {
+                uint32 variant;
+                uint32 arg;
+                double value;
+            };
+
+            AuraTotalCache() : generation(0) { }
+
+            uint32 generation;
+            std::vector<Entry> entries;
+        };
+
+        bool GetCachedAuraTotal(AuraType auratype, uint32 variant, uint32 arg, double& value, uint32& generation) const;
+        void SetCachedAuraTotal(AuraType auratype, uint32 variant, uint32 arg, double value, uint32 generation) const;
+
+        mutable std::unordered_map<uint32, AuraTotalCache> m_auraTotals;
         AuraList m_scAuras;                        // casted singlecast auras
         AuraList m_my_Auras;                       // casted auras
         AuraApplicationList m_interruptableAuras;             // auras which have interrupt mask applied on unit
@@ -2727,6 +2798,9 @@ class Unit : public WorldObject
 
         void DisableSpline(bool clearFlags = true);
     private:
+        void _AddToProcAuraIndex(AuraApplication* aurApp);
+        void _RemoveFromProcAuraIndex(AuraApplication* aurApp);
+        ProcAuraIndex const& _GetProcAuraIndex();
         bool SpellProcCheck(Unit* victim, SpellInfo const* spellProto, SpellInfo const* procSpell, uint8 effect);
         bool SpellProcTriggered(Unit* victim, DamageInfo* dmgInfoProc, AuraEffect* triggeredByAura, SpellInfo const* procSpell, uint32 procFlag, uint32 procEx, double cooldown);
         void CalculateFromDummy(Unit* victim, float &amount, SpellInfo const* spellProto, uint32 mask = 131071, bool damage = true) const; //mask for all 16 effect
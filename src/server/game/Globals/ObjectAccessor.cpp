@@ -38,38 +38,132 @@
 #include "World.h"
 #include "ThreadPoolMgr.hpp"
 
+#include <algorithm>
 #include <cmath>
+#include <memory>
+#include <unordered_map>
+#include <vector>
 
 namespace {
 
-class ValuesUpdateRequest
+// Changed objects are handed to the pool in chunks, building the values
+// update of a single object is too cheap to be worth a task of its own
+std::size_t const ValuesUpdateChunkSize = 64;
+
+// Parts built for the same player are merged up to this many bytes of
+// update blocks, what goes beyond is sent in further packets
+std::size_t const ValuesUpdateMaxPacketSize = 64 * 1024;
+
+typedef std::pair<Map const*, uint32> UpdateOrderKey;
+typedef std::vector<std::pair<UpdateOrderKey, Object*>> UpdateQueue;
+
+// Objects of the same cell are mostly seen by the same players, grouping them
+// keeps the grid walks of a chunk local and its UpdateData per player large
+UpdateOrderKey GetUpdateOrderKey(Object* obj)
+{
+    WorldObject const* source;
+    if (obj->isType(TYPEMASK_ITEM))
+        source = static_cast<Item*>(obj)->GetOwner();
+    else
+        source = static_cast<WorldObject*>(obj);
+
+    if (!source || !source->IsInWorld())
+        return UpdateOrderKey(nullptr, 0);
+
+    CellCoord const coord = Trinity::ComputeCellCoord(source->GetPositionX(), source->GetPositionY());
+    return UpdateOrderKey(source->GetMap(), coord.GetId());
+}
+
+class ValuesUpdateChunk
 {
 public:
-    ValuesUpdateRequest(Object *obj)
-        : m_obj(obj)
+    ValuesUpdateChunk(UpdateQueue::const_iterator begin, UpdateQueue::const_iterator end)
+        : m_begin(begin), m_end(end)
     { }
 
     void operator()()
     {
-        UpdateDataMapType update_players;
-        m_obj->BuildUpdate(update_players);
+        for (UpdateQueue::const_iterator itr = m_begin; itr != m_end; ++itr)
+            itr->second->BuildUpdate(m_updatePlayers);
+    }
 
-        WorldPacket packet;
-        for (UpdateDataMapType::iterator iter = update_players.begin(); iter != update_players.end(); ++iter)
+    UpdateDataMapType& GetUpdatePlayers() { return m_updatePlayers; }
+
+private:
+    UpdateQueue::const_iterator m_begin;
+    UpdateQueue::const_iterator m_end;
+    UpdateDataMapType m_updatePlayers;
+};
+
+typedef std::vector<std::pair<Player*, std::vector<UpdateData*>>> FlushQueue;
+
+// Merges the parts built by every chunk for a player and sends them in as few
+// packets as ValuesUpdateMaxPacketSize allows
+class ValuesUpdateFlush
+{
+public:
+    ValuesUpdateFlush(FlushQueue::iterator begin, FlushQueue::iterator end, std::atomic<uint64>& blocks, std::atomic<uint64>& packets, std::atomic<uint64>& bytes)
+        : m_begin(begin), m_end(end), m_blocks(blocks), m_packets(packets), m_bytes(bytes), m_sentBlocks(0), m_sentPackets(0), m_sentBytes(0)
+    { }
+
+    void operator()()
+    {
+        m_sentBlocks = 0;
+        m_sentPackets = 0;
+        m_sentBytes = 0;
+
+        for (FlushQueue::iterator itr = m_begin; itr != m_end; ++itr)
         {
-            if (iter->second.BuildPacket(&packet))
-                iter->first->SendDirectMessage(&packet);
-            packet.clear();
+            // a single part holds the blocks of at most one chunk of objects
+            UpdateData* data = itr->second.front();
+            for (std::size_t i = 1; i < itr->second.size(); ++i)
+            {
+                UpdateData* part = itr->second[i];
+                if (data->GetDataSize() + part->GetDataSize() > ValuesUpdateMaxPacketSize)
+                {
+                    Send(itr->first, *data);
+                    data = part;
+                }
+                else
+                    data->Append(*part);
+            }
+
+            Send(itr->first, *data);
         }
+
+        m_blocks.fetch_add(m_sentBlocks, std::memory_order_relaxed);
+        m_packets.fetch_add(m_sentPackets, std::memory_order_relaxed);
+        m_bytes.fetch_add(m_sentBytes, std::memory_order_relaxed);
     }
 
 private:
-    Object *m_obj;
+    void Send(Player* player, UpdateData& data)
+    {
+        m_sentBlocks += data.GetBlockCount();
+
+        WorldPacket packet;
+        if (data.BuildPacket(&packet))
+        {
+            ++m_sentPackets;
+            m_sentBytes += packet.size();
+            player->SendDirectMessage(&packet);
+        }
+    }
+
+    FlushQueue::iterator m_begin;
+    FlushQueue::iterator m_end;
+    std::atomic<uint64>& m_blocks;
+    std::atomic<uint64>& m_packets;
+    std::atomic<uint64>& m_bytes;
+    uint64 m_sentBlocks;
+    uint64 m_sentPackets;
+    uint64 m_sentBytes;
 };
 
 } // namespace
 
 ObjectAccessor::ObjectAccessor()
+    : i_updatedObjects(0), i_updateBlocks(0), i_updatePackets(0), i_updateBytes(0)
 {
 }
 
@@ -299,8 +393,10 @@ void ObjectAccessor::AddCorpse(Corpse* corpse)
     }
 }
 
-void ObjectAccessor::AddCorpsesToGrid(GridCoord const& gridpair, Grid& grid, Map* map)
+void ObjectAccessor::AddCorpsesToGrid(Cell const& cell, NGrid& grid, Map* map)
 {
+    GridCoord const gridpair(cell.GridX(), cell.GridY());
+
     CorpseReadGuard guard(i_corpseLock);
 
     for (Player2CorpsesMapType::iterator iter = i_player2corpse.begin(); iter != i_player2corpse.end(); ++iter)
@@ -315,10 +411,10 @@ void ObjectAccessor::AddCorpsesToGrid(GridCoord const& gridpair, Grid& grid, Map
             if (map->Instanceable())
             {
                 if (iter->second->GetInstanceId() == map->GetInstanceId())
-                    grid.AddWorldObject(iter->second);
+                    grid.AddWorldObject(cell.CellX(), cell.CellY(), iter->second);
             }
             else
-                grid.AddWorldObject(iter->second);
+                grid.AddWorldObject(cell.CellX(), cell.CellY(), iter->second);
         }
     }
 }
@@ -415,11 +511,72 @@ void ObjectAccessor::Update(uint32 /*diff*/)
             std::swap(objectsToUpdate, i_objects);
     }
 
+    UpdateQueue queue;
+    queue.reserve(objectsToUpdate.size());
     for (auto &obj : objectsToUpdate)
         if (obj && obj->IsInWorld())
-            sThreadPoolMgr->schedule(ValuesUpdateRequest(obj));
+            queue.emplace_back(GetUpdateOrderKey(obj), obj);
+
+    if (queue.empty())
+        return;
+
+    std::sort(queue.begin(), queue.end(), [](UpdateQueue::value_type const &a, UpdateQueue::value_type const &b) {
+        return a.first < b.first;
+    });
+
+    // Build the blocks of every chunk, each chunk keeps one UpdateData per player
+    std::vector<std::unique_ptr<ValuesUpdateChunk>> chunks;
+    chunks.reserve((queue.size() + ValuesUpdateChunkSize - 1) / ValuesUpdateChunkSize);
+
+    {
+        Trinity::TaskGroup requests;
+        for (std::size_t i = 0; i < queue.size(); i += ValuesUpdateChunkSize)
+        {
+            auto const end = queue.begin() + std::min(i + ValuesUpdateChunkSize, queue.size());
+            chunks.emplace_back(new ValuesUpdateChunk(queue.begin() + i, end));
+
+            ValuesUpdateChunk* chunk = chunks.back().get();
+            requests.run([chunk] { (*chunk)(); });
+        }
+        requests.wait();
+    }
 
-    sThreadPoolMgr->wait();
+    // Gather the parts built for the same player by different chunks
+    FlushQueue flushQueue;
+    std::unordered_map<Player*, std::size_t> flushIndex;
+    for (auto &chunk : chunks)
+    {
+        for (auto &update : chunk->GetUpdatePlayers())
+        {
+            auto const inserted = flushIndex.emplace(update.first, flushQueue.size());
+            if (inserted.second)
+                flushQueue.emplace_back(update.first, std::vector<UpdateData*>());
+
+            flushQueue[inserted.first->second].second.push_back(&update.second);
+        }
+    }
+
+    {
+        Trinity::TaskGroup flushes;
+        for (std::size_t i = 0; i < flushQueue.size(); i += ValuesUpdateChunkSize)
+        {
+            auto const end = flushQueue.begin() + std::min(i + ValuesUpdateChunkSize, flushQueue.size());
+            flushes.run(ValuesUpdateFlush(flushQueue.begin() + i, end, i_updateBlocks, i_updatePackets, i_updateBytes));
+        }
+        flushes.wait();
+    }
+
+    i_updatedObjects.fetch_add(queue.size(), std::memory_order_relaxed);
+}
+
+ValuesUpdateStats ObjectAccessor::GetValuesUpdateStats() const
+{
+    ValuesUpdateStats stats;
+    stats.objects = i_updatedObjects.load(std::memory_order_relaxed);
+    stats.blocks = i_updateBlocks.load(std::memory_order_relaxed);
+    stats.packets = i_updatePackets.load(std::memory_order_relaxed);
+    stats.bytes = i_updateBytes.load(std::memory_order_relaxed);
+    return stats;
 }
 
 void ObjectAccessor::UnloadAll()
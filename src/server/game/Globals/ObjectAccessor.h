@@ -32,6 +32,7 @@
 #include "SpinLock.hpp"
 
 #include <ting/shared_mutex.hpp>
+#include <atomic>
 #include <mutex>
 #include <set>
 
@@ -43,6 +44,8 @@ class DynamicObject;
 class WorldObject;
 class Vehicle;
 class Map;
+class NGrid;
+struct Cell;
 class WorldRunnable;
 class Transport;
 
@@ -86,6 +89,15 @@ class HashMapHolder
         static MapType  m_objectMap;
 };
 
+// Totals of the values update pipeline since startup
+struct ValuesUpdateStats
+{
+    uint64 objects;                                         // changed objects processed
+    uint64 blocks;                                          // values update blocks built
+    uint64 packets;                                         // SMSG_UPDATE_OBJECT packets sent
+    uint64 bytes;                                           // size of these packets before compression
+};
+
 class ObjectAccessor
 {
     typedef Trinity::SpinLock ObjectLock;
@@ -260,9 +272,11 @@ class ObjectAccessor
         Corpse* GetCorpseForPlayerGUID(uint64 guid);
         void RemoveCorpse(Corpse* corpse);
         void AddCorpse(Corpse* corpse);
-        void AddCorpsesToGrid(GridCoord const& gridpair, Grid& grid, Map* map);
+        void AddCorpsesToGrid(Cell const& cell, NGrid& grid, Map* map);
         Corpse* ConvertCorpseForPlayer(uint64 player_guid, bool insignia = false);
 
+        ValuesUpdateStats GetValuesUpdateStats() const;
+
         //Thread unsafe
         void Update(uint32 diff);
         void RemoveOldCorpses();
@@ -279,6 +293,11 @@ class ObjectAccessor
         std::set<Object*> i_objects;
         ObjectLock i_objectLock;
 
+        std::atomic<uint64> i_updatedObjects;
+        std::atomic<uint64> i_updateBlocks;
+        std::atomic<uint64> i_updatePackets;
+        std::atomic<uint64> i_updateBytes;
+
         Player2CorpsesMapType i_player2corpse;
         CorpseLock i_corpseLock;
 };
@@ -68,13 +68,18 @@ inline void Cell::Visit(CellCoord const& standing_cell, Visitor &&visitor, Map&
 
     //ALWAYS visit standing cell first!!! Since we deal with small radiuses
     //it is very essential to call visitor for standing cell firstly...
-    map.Visit(*this, std::forward<Visitor>(visitor));
+    uint32 visitedCells = 0;
+    uint32 skippedCells = 0;
+    ++(map.Visit(*this, std::forward<Visitor>(visitor)) ? visitedCells : skippedCells);
 
     //no jokes here... Actually placing ASSERT() here was good idea, but
     //we had some problems with DynamicObjects, which pass radius = 0.0f (DB issue?)
     //maybe it is better to just return when radius <= 0.0f?
     if (radius <= 0.0f)
+    {
+        Map::AddCellVisitStats(visitedCells, skippedCells);
         return;
+    }
 
     //lets limit the upper value for search radius
     if (radius > SIZE_OF_GRIDS)
@@ -84,14 +89,21 @@ inline void Cell::Visit(CellCoord const& standing_cell, Visitor &&visitor, Map&
     CellArea area = Cell::CalculateCellArea(x_off, y_off, radius);
     //if radius fits inside standing cell
     if (!area)
+    {
+        Map::AddCellVisitStats(visitedCells, skippedCells);
         return;
+    }
 
     //visit all cells, found in CalculateCellArea()
     //if radius is known to reach cell area more than 4x4 then we should call optimized VisitCircle
     //currently this technique works with MAX_NUMBER_OF_CELLS 16 and higher, with lower values
     //there are nothing to optimize because SIZE_OF_GRID_CELL is too big...
     if ((area.high_bound.x_coord > (area.low_bound.x_coord + 4)) && (area.high_bound.y_coord > (area.low_bound.y_coord + 4)))
-        return VisitCircle(visitor, map, area.low_bound, area.high_bound, standing_cell);
+    {
+        VisitCircle(visitor, map, area.low_bound, area.high_bound, standing_cell, visitedCells, skippedCells);
+        Map::AddCellVisitStats(visitedCells, skippedCells);
+        return;
+    }
 
     // loop the cell range
     for (uint32 x = area.low_bound.x_coord; x <= area.high_bound.x_coord; ++x)
@@ -104,10 +116,12 @@ inline void Cell::Visit(CellCoord const& standing_cell, Visitor &&visitor, Map&
             {
                 Cell r_zone(cellCoord);
                 r_zone.data.Part.nocreate = this->data.Part.nocreate;
-                map.Visit(r_zone, std::forward<Visitor>(visitor));
+                ++(map.Visit(r_zone, std::forward<Visitor>(visitor)) ? visitedCells : skippedCells);
             }
         }
     }
+
+    Map::AddCellVisitStats(visitedCells, skippedCells);
 }
 
 template <typename Visitor>
@@ -119,7 +133,7 @@ inline void Cell::Visit(CellCoord const& standing_cell, Visitor &&visitor, Map&
 }
 
 template <typename Visitor>
-inline void Cell::VisitCircle(Visitor &visitor, Map& map, CellCoord const& begin_cell, CellCoord const& end_cell, CellCoord const &standing_cell) const
+inline void Cell::VisitCircle(Visitor &visitor, Map& map, CellCoord const& begin_cell, CellCoord const& end_cell, CellCoord const &standing_cell, uint32 &visitedCells, uint32 &skippedCells) const
 {
     //here is an algorithm for 'filling' circum-squared octagon
     uint32 x_shift = (uint32)ceilf((end_cell.x_coord - begin_cell.x_coord) * 0.3f - 0.5f);
@@ -137,7 +151,7 @@ inline void Cell::VisitCircle(Visitor &visitor, Map& map, CellCoord const& begin
             {
                 Cell r_zone(cellCoord);
                 r_zone.data.Part.nocreate = this->data.Part.nocreate;
-                map.Visit(r_zone, visitor);
+                ++(map.Visit(r_zone, visitor) ? visitedCells : skippedCells);
             }
         }
     }
@@ -165,7 +179,7 @@ inline void Cell::VisitCircle(Visitor &visitor, Map& map, CellCoord const& begin
             {
                 Cell r_zone_left(cellCoord_left);
                 r_zone_left.data.Part.nocreate = this->data.Part.nocreate;
-                map.Visit(r_zone_left, visitor);
+                ++(map.Visit(r_zone_left, visitor) ? visitedCells : skippedCells);
             }
 
             //right trapezoid cell visit
@@ -174,7 +188,7 @@ inline void Cell::VisitCircle(Visitor &visitor, Map& map, CellCoord const& begin
             {
                 Cell r_zone_right(cellCoord_right);
                 r_zone_right.data.Part.nocreate = this->data.Part.nocreate;
-                map.Visit(r_zone_right, visitor);
+                ++(map.Visit(r_zone_right, visitor) ? visitedCells : skippedCells);
             }
         }
     }
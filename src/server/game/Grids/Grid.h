@@ -55,16 +55,17 @@ public:
     typedef Trinity::TypeMapContainer<WorldObjectTypeList> WorldObjectMap;
 
 public:
+    // occupancy is the mask of non-empty object lists of the container, see NGrid
     template <typename SpecificObject>
-    void AddWorldObject(SpecificObject *obj)
+    void AddWorldObject(SpecificObject *obj, uint8 &occupancy)
     {
-        i_worldObjects.template insert<SpecificObject>(obj);
+        i_worldObjects.template insert<SpecificObject>(obj, occupancy);
     }
 
     template<typename SpecificObject>
-    void AddGridObject(SpecificObject *obj)
+    void AddGridObject(SpecificObject *obj, uint8 &occupancy)
     {
-        i_gridObjects.template insert<SpecificObject>(obj);
+        i_gridObjects.template insert<SpecificObject>(obj, occupancy);
     }
 
     template <typename T>
@@ -87,6 +88,19 @@ public:
         visitor.Visit(i_worldObjects);
     }
 
+    // Visit only the object lists set in occupancy
+    template <typename T>
+    void Visit(Trinity::TypeContainerVisitor<T, GridObjectMap> &visitor, uint8 occupancy)
+    {
+        visitor.Visit(i_gridObjects, occupancy);
+    }
+
+    template <typename T>
+    void Visit(Trinity::TypeContainerVisitor<T, WorldObjectMap> &visitor, uint8 occupancy)
+    {
+        visitor.Visit(i_worldObjects, occupancy);
+    }
+
 private:
     GridObjectMap i_gridObjects;
     WorldObjectMap i_worldObjects;
@@ -27,6 +27,8 @@
 #include "Timer.h"
 #include "Util.h"
 
+#include <cstring>
+
 #define DEFAULT_VISIBILITY_NOTIFY_PERIOD      1000
 
 class GridInfo final
@@ -103,7 +105,10 @@ public:
     NGrid(int32 x, int32 y, time_t expiry, bool unload = true)
         : i_GridInfo(expiry, unload), i_x(x), i_y(y)
         , i_cellstate(GRID_STATE_INVALID), i_GridObjectDataLoaded(false)
-    { }
+    {
+        std::memset(i_gridOccupancy, 0, sizeof(i_gridOccupancy));
+        std::memset(i_worldOccupancy, 0, sizeof(i_worldOccupancy));
+    }
 
     Grid & GetGrid(const uint32 x, const uint32 y)
     {
@@ -141,11 +146,40 @@ public:
             cell.Visit(visitor);
     }
 
-    // Visit a single Grid (cell) in NGrid (grid)
-    template <typename Visitor>
-    void VisitGrid(const uint32 x, const uint32 y, Visitor &&visitor)
+    template <typename SpecificObject>
+    void AddWorldObject(const uint32 x, const uint32 y, SpecificObject *obj)
     {
-        GetGrid(x, y).Visit(visitor);
+        GetGrid(x, y).AddWorldObject(obj, i_worldOccupancy[x * MAX_NUMBER_OF_CELLS + y]);
+    }
+
+    template <typename SpecificObject>
+    void AddGridObject(const uint32 x, const uint32 y, SpecificObject *obj)
+    {
+        GetGrid(x, y).AddGridObject(obj, i_gridOccupancy[x * MAX_NUMBER_OF_CELLS + y]);
+    }
+
+    // Visit a single Grid (cell) in NGrid (grid), only the object lists that are not empty.
+    // Returns false if the cell holds nothing of the visited container.
+    template <typename T>
+    bool VisitGrid(const uint32 x, const uint32 y, Trinity::TypeContainerVisitor<T, Grid::GridObjectMap> visitor)
+    {
+        uint8 const occupancy = i_gridOccupancy[x * MAX_NUMBER_OF_CELLS + y];
+        if (!occupancy)
+            return false;
+
+        GetGrid(x, y).Visit(visitor, occupancy);
+        return true;
+    }
+
+    template <typename T>
+    bool VisitGrid(const uint32 x, const uint32 y, Trinity::TypeContainerVisitor<T, Grid::WorldObjectMap> visitor)
+    {
+        uint8 const occupancy = i_worldOccupancy[x * MAX_NUMBER_OF_CELLS + y];
+        if (!occupancy)
+            return false;
+
+        GetGrid(x, y).Visit(visitor, occupancy);
+        return true;
     }
 
     template <typename T>
@@ -164,6 +198,11 @@ private:
     GridState i_cellstate;
     Grid i_cells[MAX_NUMBER_OF_CELLS * MAX_NUMBER_OF_CELLS];
     bool i_GridObjectDataLoaded;
+
+    // one bit per object type and cell, set while the cell holds objects of that type;
+    // lets cell visits skip empty cells without touching their containers
+    uint8 i_gridOccupancy[MAX_NUMBER_OF_CELLS * MAX_NUMBER_OF_CELLS];
+    uint8 i_worldOccupancy[MAX_NUMBER_OF_CELLS * MAX_NUMBER_OF_CELLS];
 };
 
 #endif
@@ -20,6 +20,7 @@
 #define TRINITY_GRIDNOTIFIERS_H
 
 #include "UpdateData.h"
+#include "SerializedPacket.h"
 
 #include "Corpse.h"
 #include "AreaTrigger.h"
@@ -83,12 +84,13 @@ namespace Trinity
     {
         WorldObject* i_source;
         WorldPacket const* i_message;
+        SerializedPacket i_serializedMessage;
         uint32 i_phaseMask;
         float i_distSq;
         uint32 team;
         Player const* skipped_receiver;
         MessageDistDeliverer(WorldObject* src, WorldPacket const* msg, float dist, bool own_team_only = false, Player const* skipped = NULL)
-            : i_source(src), i_message(msg), i_phaseMask(src->GetPhaseMask()), i_distSq(dist * dist)
+            : i_source(src), i_message(msg), i_serializedMessage(*msg), i_phaseMask(src->GetPhaseMask()), i_distSq(dist * dist)
             , team((own_team_only && src->GetTypeId() == TYPEID_PLAYER) ? ((Player*)src)->GetTeam() : 0)
             , skipped_receiver(skipped)
         { }
@@ -113,7 +115,7 @@ namespace Trinity
                 return;
 
             if (WorldSession* session = player->GetSession())
-                session->SendPacket(i_message);
+                session->SendPacket(i_serializedMessage);
         }
     };
 
@@ -408,6 +410,51 @@ namespace Trinity
         uint32 _phaseMask;
     };
 
+    // Candidate prefilter of the searchers: checks built on source->IsWithinDistInMap(target, range) can
+    // declare that sphere with GetSearchArea(), their operator() then only sees the objects inside it.
+    namespace Detail
+    {
+        template <typename Check>
+        inline auto GetSearchArea(Check const& check, PositionIndex::SearchArea& area, int) -> decltype(check.GetSearchArea(area))
+        {
+            return check.GetSearchArea(area);
+        }
+
+        template <typename Check>
+        inline bool GetSearchArea(Check const& /*check*/, PositionIndex::SearchArea& /*area*/, long)
+        {
+            return false;
+        }
+    }
+
+    inline bool GetObjectRangeSearchArea(WorldObject const* source, float range, PositionIndex::SearchArea& area)
+    {
+        // distances between passengers of a transport use their transport offsets
+        if (source->GetTransport())
+            return false;
+
+        area.x = source->GetPositionX();
+        area.y = source->GetPositionY();
+        area.z = source->GetPositionZH();                   // hover height included, as in _IsWithinDist
+        area.radius = range + source->GetObjectSize();
+        area.is3D = true;
+        return true;
+    }
+
+    // Calls func for the objects of m in the phase of the searcher and in the search area of check,
+    // until func returns false
+    template <typename Check, typename T, typename Function>
+    inline void SelectCandidates(Check const& check, uint32 phaseMask, std::vector<T*>& m, PositionIndex const& positions, Function&& func)
+    {
+        PositionIndex::SearchArea area;
+        bool const hasArea = Detail::GetSearchArea(check, area, 0);
+
+        positions.select(phaseMask, hasArea ? &area : nullptr, [&m, &func](std::size_t index)
+        {
+            return func(m[index]);
+        });
+    }
+
     // Unit searchers
 
     // First accepted by Check Unit if any
@@ -421,8 +468,8 @@ namespace Trinity
         UnitSearcher(WorldObject const* searcher, Unit* & result, Check & check)
             : i_phaseMask(searcher->GetPhaseMask()), i_object(result), i_check(check) {}
 
-        void Visit(CreatureMapType &m);
-        void Visit(PlayerMapType &m);
+        void Visit(CreatureMapType &m, PositionIndex const &positions);
+        void Visit(PlayerMapType &m, PositionIndex const &positions);
 
         template <typename NotInterested>
         void Visit(NotInterested &) {}
@@ -439,8 +486,8 @@ namespace Trinity
         UnitLastSearcher(WorldObject const* searcher, Unit* & result, Check & check)
             : i_phaseMask(searcher->GetPhaseMask()), i_object(result), i_check(check) {}
 
-        void Visit(CreatureMapType &m);
-        void Visit(PlayerMapType &m);
+        void Visit(CreatureMapType &m, PositionIndex const &positions);
+        void Visit(PlayerMapType &m, PositionIndex const &positions);
 
         template <typename NotInterested>
         void Visit(NotInterested &) {}
@@ -457,8 +504,8 @@ namespace Trinity
         UnitListSearcher(WorldObject const* searcher, std::list<Unit*> &objects, Check & check)
             : i_phaseMask(searcher->GetPhaseMask()), i_objects(objects), i_check(check) {}
 
-        void Visit(PlayerMapType &m);
-        void Visit(CreatureMapType &m);
+        void Visit(PlayerMapType &m, PositionIndex const &positions);
+        void Visit(CreatureMapType &m, PositionIndex const &positions);
 
         template <typename NotInterested>
         void Visit(NotInterested &) {}
@@ -564,7 +611,7 @@ namespace Trinity
         PlayerSearcher(WorldObject const* searcher, Player* & result, Check & check)
             : i_phaseMask(searcher->GetPhaseMask()), i_object(result), i_check(check) {}
 
-        void Visit(PlayerMapType &m);
+        void Visit(PlayerMapType &m, PositionIndex const &positions);
 
         template <typename NotInterested>
         void Visit(NotInterested &) {}
@@ -580,7 +627,7 @@ namespace Trinity
         PlayerListSearcher(WorldObject const* searcher, std::list<Player*> &objects, Check & check)
             : i_phaseMask(searcher->GetPhaseMask()), i_objects(objects), i_check(check) {}
 
-        void Visit(PlayerMapType &m);
+        void Visit(PlayerMapType &m, PositionIndex const &positions);
 
         template <typename NotInterested>
         void Visit(NotInterested &) {}
@@ -597,7 +644,7 @@ namespace Trinity
             : i_phaseMask(searcher->GetPhaseMask()), i_object(result), i_check(check)
         { }
 
-        void Visit(PlayerMapType &m);
+        void Visit(PlayerMapType &m, PositionIndex const &positions);
 
         template <typename NotInterested>
         void Visit(NotInterested &) {}
@@ -886,6 +933,10 @@ namespace Trinity
                 else
                     return false;
             }
+            bool GetSearchArea(PositionIndex::SearchArea& area) const
+            {
+                return GetObjectRangeSearchArea(i_obj, i_range, area);
+            }
         private:
             WorldObject const* i_obj;
             Unit const* i_funit;
@@ -912,6 +963,10 @@ namespace Trinity
 
                 return i_obj->IsWithinDistInMap(u, i_range) && !i_funit->IsFriendlyTo(u);
             }
+            bool GetSearchArea(PositionIndex::SearchArea& area) const
+            {
+                return GetObjectRangeSearchArea(i_obj, i_range, area);
+            }
         private:
             WorldObject const* i_obj;
             Unit const* i_funit;
@@ -933,6 +988,10 @@ namespace Trinity
                     && u->GetCreatureType() != CREATURE_TYPE_CRITTER
                     && i_funit->canSeeOrDetect(u);
             }
+            bool GetSearchArea(PositionIndex::SearchArea& area) const
+            {
+                return GetObjectRangeSearchArea(i_funit, i_range, area);
+            }
         private:
             Unit const* i_funit;
             float i_range;
@@ -961,6 +1020,10 @@ namespace Trinity
                 else
                     return false;
             }
+            bool GetSearchArea(PositionIndex::SearchArea& area) const
+            {
+                return GetObjectRangeSearchArea(i_obj, i_range, area);
+            }
         private:
             WorldObject const* i_obj;
             Unit const* i_funit;
@@ -988,6 +1051,10 @@ namespace Trinity
                     return false;
             }
 
+            bool GetSearchArea(PositionIndex::SearchArea& area) const
+            {
+                return GetObjectRangeSearchArea(i_obj, i_range, area);
+            }
         private:
             WorldObject const* i_obj;
             Unit const* i_funit;
@@ -1013,6 +1080,10 @@ namespace Trinity
                 return !_refUnit->IsHostileTo(u) && u->IsAlive() && _source->IsWithinDistInMap(u, _range);
             }
 
+            bool GetSearchArea(PositionIndex::SearchArea& area) const
+            {
+                return GetObjectRangeSearchArea(_source, _range, area);
+            }
         private:
             WorldObject const* _source;
             Unit const* _refUnit;
@@ -1031,6 +1102,10 @@ namespace Trinity
 
                 return false;
             }
+            bool GetSearchArea(PositionIndex::SearchArea& area) const
+            {
+                return GetObjectRangeSearchArea(i_obj, i_range, area);
+            }
         private:
             WorldObject const* i_obj;
             float i_range;
@@ -1071,6 +1146,10 @@ namespace Trinity
 
                 return false;
             }
+            bool GetSearchArea(PositionIndex::SearchArea& area) const
+            {
+                return GetObjectRangeSearchArea(i_obj, i_range, area);
+            }
         private:
             WorldObject const* i_obj;
             Unit const* i_funit;
@@ -1096,6 +1175,10 @@ namespace Trinity
 
                 return false;
             }
+            bool GetSearchArea(PositionIndex::SearchArea& area) const
+            {
+                return GetObjectRangeSearchArea(i_obj, i_range, area);
+            }
         private:
             WorldObject const* i_obj;
             Unit const* i_funit;
@@ -1130,6 +1213,10 @@ namespace Trinity
 
                 return false;
             }
+            bool GetSearchArea(PositionIndex::SearchArea& area) const
+            {
+                return GetObjectRangeSearchArea(i_obj, i_range, area);
+            }
         private:
             bool i_targetForPlayer;
             WorldObject const* i_obj;
@@ -1203,6 +1290,10 @@ namespace Trinity
                 return true;
             }
 
+            bool GetSearchArea(PositionIndex::SearchArea& area) const
+            {
+                return GetObjectRangeSearchArea(me, m_range, area);
+            }
     private:
             Unit const* me;
             float m_range;
@@ -1234,6 +1325,10 @@ namespace Trinity
             return true;
         }
 
+        bool GetSearchArea(PositionIndex::SearchArea& area) const
+        {
+            return GetObjectRangeSearchArea(me, m_range, area);
+        }
     private:
         Creature const *me;
         float m_range;
@@ -1268,6 +1363,10 @@ namespace Trinity
                 return true;
             }
             float GetLastRange() const { return m_range; }
+            bool GetSearchArea(PositionIndex::SearchArea& area) const
+            {
+                return GetObjectRangeSearchArea(me, m_range, area);
+            }
         private:
             Creature const* me;
             float m_range;
@@ -1409,6 +1508,10 @@ namespace Trinity
                 return true;
             }
 
+            bool GetSearchArea(PositionIndex::SearchArea& area) const
+            {
+                return GetObjectRangeSearchArea(_obj, _range, area);
+            }
         private:
             WorldObject const* _obj;
             float _range;
@@ -1432,6 +1535,10 @@ namespace Trinity
 
                 return false;
             }
+            bool GetSearchArea(PositionIndex::SearchArea& area) const
+            {
+                return GetObjectRangeSearchArea(i_obj, i_range, area);
+            }
         private:
             WorldObject const* i_obj;
             float i_range;
@@ -1456,6 +1563,10 @@ namespace Trinity
 
                 return false;
             }
+            bool GetSearchArea(PositionIndex::SearchArea& area) const
+            {
+                return GetObjectRangeSearchArea(i_obj, i_range, area);
+            }
         private:
             WorldObject const* i_obj;
             float i_range;
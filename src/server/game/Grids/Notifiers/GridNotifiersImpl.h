@@ -334,69 +334,81 @@ void Trinity::GameObjectListSearcher<Check>::Visit(GameObjectMapType &m)
 // Unit searchers
 
 template<class Check>
-void Trinity::UnitSearcher<Check>::Visit(CreatureMapType &m)
+void Trinity::UnitSearcher<Check>::Visit(CreatureMapType &m, PositionIndex const &positions)
 {
     // already found
     if (i_object)
         return;
 
-    for (auto &creature : m)
+    SelectCandidates(i_check, i_phaseMask, m, positions, [this](Creature* creature)
     {
-        if (creature->InSamePhase(i_phaseMask) && i_check(creature))
-        {
-            i_object = creature;
-            return;
-        }
-    }
+        if (!i_check(creature))
+            return true;
+
+        i_object = creature;
+        return false;
+    });
 }
 
 template<class Check>
-void Trinity::UnitSearcher<Check>::Visit(PlayerMapType &m)
+void Trinity::UnitSearcher<Check>::Visit(PlayerMapType &m, PositionIndex const &positions)
 {
     // already found
     if (i_object)
         return;
 
-    for (auto &player : m)
+    SelectCandidates(i_check, i_phaseMask, m, positions, [this](Player* player)
     {
-        if (player->InSamePhase(i_phaseMask) && i_check(player))
-        {
-            i_object = player;
-            return;
-        }
-    }
+        if (!i_check(player))
+            return true;
+
+        i_object = player;
+        return false;
+    });
 }
 
 template<class Check>
-void Trinity::UnitLastSearcher<Check>::Visit(CreatureMapType &m)
+void Trinity::UnitLastSearcher<Check>::Visit(CreatureMapType &m, PositionIndex const &positions)
 {
-    for (auto &creature : m)
-        if (creature->InSamePhase(i_phaseMask) && i_check(creature))
+    SelectCandidates(i_check, i_phaseMask, m, positions, [this](Creature* creature)
+    {
+        if (i_check(creature))
             i_object = creature;
+        return true;
+    });
 }
 
 template<class Check>
-void Trinity::UnitLastSearcher<Check>::Visit(PlayerMapType &m)
+void Trinity::UnitLastSearcher<Check>::Visit(PlayerMapType &m, PositionIndex const &positions)
 {
-    for (auto &player : m)
-        if (player->InSamePhase(i_phaseMask) && i_check(player))
+    SelectCandidates(i_check, i_phaseMask, m, positions, [this](Player* player)
+    {
+        if (i_check(player))
             i_object = player;
+        return true;
+    });
 }
 
 template<class Check>
-void Trinity::UnitListSearcher<Check>::Visit(PlayerMapType &m)
+void Trinity::UnitListSearcher<Check>::Visit(PlayerMapType &m, PositionIndex const &positions)
 {
-    for (auto &player : m)
-        if (player->InSamePhase(i_phaseMask) && i_check(player))
+    SelectCandidates(i_check, i_phaseMask, m, positions, [this](Player* player)
+    {
+        if (i_check(player))
             i_objects.push_back(player);
+        return true;
+    });
 }
 
 template<class Check>
-void Trinity::UnitListSearcher<Check>::Visit(CreatureMapType &m)
+void Trinity::UnitListSearcher<Check>::Visit(CreatureMapType &m, PositionIndex const &positions)
 {
-    for (auto &creature : m)
-        if (creature->InSamePhase(i_phaseMask) && i_check(creature))
+    SelectCandidates(i_check, i_phaseMask, m, positions, [this](Creature* creature)
+    {
+        if (i_check(creature))
             i_objects.push_back(creature);
+        return true;
+    });
 }
 
 template<class Check>
@@ -443,36 +455,42 @@ void Trinity::CreatureListSearcher<Check>::Visit(CreatureMapType &m)
 }
 
 template<class Check>
-void Trinity::PlayerListSearcher<Check>::Visit(PlayerMapType &m)
+void Trinity::PlayerListSearcher<Check>::Visit(PlayerMapType &m, PositionIndex const &positions)
 {
-    for (auto &player : m)
-        if (player->InSamePhase(i_phaseMask) && i_check(player))
+    SelectCandidates(i_check, i_phaseMask, m, positions, [this](Player* player)
+    {
+        if (i_check(player))
             i_objects.push_back(player);
+        return true;
+    });
 }
 
 template<class Check>
-void Trinity::PlayerSearcher<Check>::Visit(PlayerMapType &m)
+void Trinity::PlayerSearcher<Check>::Visit(PlayerMapType &m, PositionIndex const &positions)
 {
     // already found
     if (i_object)
         return;
 
-    for (auto &player : m)
+    SelectCandidates(i_check, i_phaseMask, m, positions, [this](Player* player)
     {
-        if (player->InSamePhase(i_phaseMask) && i_check(player))
-        {
-            i_object = player;
-            return;
-        }
-    }
+        if (!i_check(player))
+            return true;
+
+        i_object = player;
+        return false;
+    });
 }
 
 template<class Check>
-void Trinity::PlayerLastSearcher<Check>::Visit(PlayerMapType& m)
+void Trinity::PlayerLastSearcher<Check>::Visit(PlayerMapType &m, PositionIndex const &positions)
 {
-    for (auto &player : m)
-        if (player->InSamePhase(i_phaseMask) && i_check(player))
+    SelectCandidates(i_check, i_phaseMask, m, positions, [this](Player* player)
+    {
+        if (i_check(player))
             i_object = player;
+        return true;
+    });
 }
 
 template<class Builder>
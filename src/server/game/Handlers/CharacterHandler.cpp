@@ -254,6 +254,10 @@ bool LoginQueryHolder::Initialize()
     stmt->setUInt32(0, lowGuid);
     res &= SetPreparedQuery(PLAYER_LOGIN_QUERY_LOAD_LOOTCOOLDOWN, stmt);
 
+    stmt = CharacterDatabase.GetPreparedStatement(CHAR_SEL_CG_ACTION_BAR_INFO);
+    stmt->setUInt64(0, m_guid);
+    res &= SetPreparedQuery(PLAYER_LOGIN_QUERY_LOAD_CG_ACTION_BAR_INFO, stmt);
+
     return res;
 }
 
@@ -849,7 +853,8 @@ void WorldSession::HandlePlayerLoginOpcode(WorldPacket& recvData)
         return;
     }
 
-    _charLoginCallback = CharacterDatabase.DelayQueryHolder((SQLQueryHolder*)holder);
+    // ordered after any save of the character still queued from a previous session
+    _charLoginCallback = CharacterDatabase.DelayQueryHolder((SQLQueryHolder*)holder, GUID_LOPART(playerGuid));
 }
 
 void WorldSession::HandleLoadScreenOpcode(WorldPacket& recvPacket)
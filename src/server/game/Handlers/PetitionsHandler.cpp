@@ -289,20 +289,31 @@ void WorldSession::HandlePetitionQueryOpcode(WorldPacket & recvData)
 
     TC_LOG_DEBUG("network", "CMSG_PETITION_QUERY Petition GUID %u Guild GUID %u", GUID_LOPART(petitionguid), guildguid);
 
-    SendPetitionQueryOpcode(petitionguid);
+    PreparedStatement* stmt = CharacterDatabase.GetPreparedStatement(CHAR_SEL_PETITION);
+
+    stmt->setUInt32(0, GUID_LOPART(petitionguid));
+
+    uint64 petitionGuid = petitionguid;
+    AddQueryCallback(CharacterDatabase.AsyncQuery(stmt), [this, petitionGuid](PreparedQueryResult result)
+    {
+        SendPetitionQueryCallback(result, petitionGuid);
+    });
 }
 
 void WorldSession::SendPetitionQueryOpcode(uint64 petitionguid)
 {
-    ObjectGuid ownerguid;
-    uint32 type;
-    std::string name = "NO_NAME_FOR_GUID";
-
     PreparedStatement* stmt = CharacterDatabase.GetPreparedStatement(CHAR_SEL_PETITION);
 
     stmt->setUInt32(0, GUID_LOPART(petitionguid));
 
-    PreparedQueryResult result = CharacterDatabase.Query(stmt);
+    SendPetitionQueryCallback(CharacterDatabase.Query(stmt), petitionguid);
+}
+
+void WorldSession::SendPetitionQueryCallback(PreparedQueryResult result, uint64 petitionguid)
+{
+    ObjectGuid ownerguid;
+    uint32 type;
+    std::string name = "NO_NAME_FOR_GUID";
 
     if (result)
     {
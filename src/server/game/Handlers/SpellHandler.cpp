@@ -431,34 +431,50 @@ void WorldSession::HandleOpenItemOpcode(WorldPacket& recvPacket)
 
         stmt->setUInt32(0, item->GetGUIDLow());
 
-        PreparedQueryResult result = CharacterDatabase.Query(stmt);
-
-        if (result)
-        {
-            Field* fields = result->Fetch();
-            uint32 entry = fields[0].GetUInt32();
-            uint32 flags = fields[1].GetUInt32();
-
-            item->SetUInt64Value(ITEM_FIELD_GIFTCREATOR, 0);
-            item->SetEntry(entry);
-            item->SetUInt32Value(ITEM_FIELD_FLAGS, flags);
-            item->SetState(ITEM_CHANGED, pUser);
-        }
-        else
+        uint64 itemGuid = item->GetGUID();
+        AddQueryCallback(CharacterDatabase.AsyncQuery(stmt), [this, itemGuid](PreparedQueryResult result)
         {
-            TC_LOG_ERROR("network", "Wrapped item %u don't have record in character_gifts table and will deleted", item->GetGUIDLow());
-            pUser->DestroyItem(item->GetBagSlot(), item->GetSlot(), true);
-            return;
-        }
+            HandleOpenWrappedItemCallback(result, itemGuid);
+        });
+    }
+    else
+        pUser->SendLoot(item->GetGUID(), LOOT_CORPSE);
+}
 
-        stmt = CharacterDatabase.GetPreparedStatement(CHAR_DEL_GIFT);
+void WorldSession::HandleOpenWrappedItemCallback(PreparedQueryResult result, uint64 itemGuid)
+{
+    Player* pUser = _player;
+    if (!pUser)
+        return;
 
-        stmt->setUInt32(0, item->GetGUIDLow());
+    // the item may have been moved away or already unwrapped by an earlier request
+    Item* item = pUser->GetItemByGuid(itemGuid);
+    if (!item || !item->HasFlag(ITEM_FIELD_FLAGS, ITEM_FLAG_WRAPPED))
+        return;
 
-        CharacterDatabase.Execute(stmt);
+    if (result)
+    {
+        Field* fields = result->Fetch();
+        uint32 entry = fields[0].GetUInt32();
+        uint32 flags = fields[1].GetUInt32();
+
+        item->SetUInt64Value(ITEM_FIELD_GIFTCREATOR, 0);
+        item->SetEntry(entry);
+        item->SetUInt32Value(ITEM_FIELD_FLAGS, flags);
+        item->SetState(ITEM_CHANGED, pUser);
     }
     else
-        pUser->SendLoot(item->GetGUID(), LOOT_CORPSE);
+    {
+        TC_LOG_ERROR("network", "Wrapped item %u don't have record in character_gifts table and will deleted", item->GetGUIDLow());
+        pUser->DestroyItem(item->GetBagSlot(), item->GetSlot(), true);
+        return;
+    }
+
+    PreparedStatement* stmt = CharacterDatabase.GetPreparedStatement(CHAR_DEL_GIFT);
+
+    stmt->setUInt32(0, item->GetGUIDLow());
+
+    CharacterDatabase.Execute(stmt);
 }
 
 void WorldSession::HandleGameObjectUseOpcode(WorldPacket & recvData)
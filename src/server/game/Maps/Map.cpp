@@ -36,6 +36,12 @@
 #include "ChallengeMgr.h"
 #include "ScenarioMgr.h"
 #include "ObjectGridLoader.h"
+#include "ThreadPoolMgr.hpp"
+#include "OutdoorPvPMgr.h"
+#include "BattlefieldMgr.h"
+
+#include <ace/Mem_Map.h>
+#include <ace/OS_NS_unistd.h>
 
 namespace {
 
@@ -45,6 +51,15 @@ union u_map_magic
     uint32 asUInt;
 };
 
+// cells reached by Cell::Visit over all maps, see Map::Visit
+std::atomic<uint64> VisitedCells(0);
+std::atomic<uint64> SkippedCells(0);
+
+// line of sight results over all maps, see Map::isInLineOfSight
+std::atomic<uint64> LineOfSightLookups(0);
+std::atomic<uint64> LineOfSightHits(0);
+std::atomic<uint32> NextLineOfSightSerial(1);
+
 u_map_magic MapMagic        = { {'M','A','P','S'} };
 u_map_magic MapVersionMagic = { {'v','1','.','8'} };
 u_map_magic MapAreaMagic    = { {'A','R','E','A'} };
@@ -139,11 +154,9 @@ void VisitNearbyCellsOf(Map *map, WorldObject* obj, GridVisitor &&gridVisitor, W
             // marked cells are those that have been visited
             // don't visit the same cell twice
             uint32 cell_id = (y * TOTAL_NUMBER_OF_CELLS_PER_MAP) + x;
-            if (map->isCellMarked(cell_id))
+            if (map->markCell(cell_id))
                 continue;
 
-            map->markCell(cell_id);
-
             Cell cell(CellCoord(x, y));
             cell.SetNoCreate();
 
@@ -153,6 +166,79 @@ void VisitNearbyCellsOf(Map *map, WorldObject* obj, GridVisitor &&gridVisitor, W
     }
 }
 
+template <typename GridVisitor, typename WorldVisitor>
+void UpdatePlayerAndNearbyCells(Map *map, Player *player, uint32 diff, GridVisitor &&gridVisitor, WorldVisitor &&worldVisitor)
+{
+    WorldSession* session = player->GetSession();
+    MapSessionFilter updater(session);
+
+    session->Update(diff, updater);
+    // Can be not in world after WorldSession::Update
+    if (player->IsInWorld())
+    {
+        player->Update(diff);
+        VisitNearbyCellsOf(map, player, std::forward<GridVisitor>(gridVisitor), std::forward<WorldVisitor>(worldVisitor));
+    }
+}
+
+// region of the map updated by the current thread, see Map::UpdateRegion()
+thread_local Map const* UpdatingRegionMap = nullptr;
+thread_local uint16 UpdatingRegion = 0;
+
+// Cluster id of every grid holding an active object, grids closer than
+// 2 * MAP_REGION_HALO_GRIDS + 3 to each other end up in the same cluster.
+// Halos of different clusters are then at least two grids apart: objects at
+// the edge of a halo act at most one grid further (visibility, activation
+// and spell ranges are below the grid size), so no cell is visited or
+// modified by two regions.
+typedef uint16 GridClusterMap[MAX_NUMBER_OF_GRIDS][MAX_NUMBER_OF_GRIDS];
+
+uint16 ClusterActiveGrids(GridClusterMap &clusters)
+{
+    int32 const reach = 2 * MAP_REGION_HALO_GRIDS + 2;
+
+    uint16 count = 0;
+    std::vector<GridCoord> pending;
+
+    for (uint32 x = 0; x < MAX_NUMBER_OF_GRIDS; ++x)
+    {
+        for (uint32 y = 0; y < MAX_NUMBER_OF_GRIDS; ++y)
+        {
+            // 0 - no active object, uint16(-1) - not yet assigned
+            if (clusters[x][y] != uint16(-1))
+                continue;
+
+            clusters[x][y] = ++count;
+            pending.push_back(GridCoord(x, y));
+
+            while (!pending.empty())
+            {
+                GridCoord const p = pending.back();
+                pending.pop_back();
+
+                uint32 const lowX = p.x_coord > uint32(reach) ? p.x_coord - reach : 0;
+                uint32 const lowY = p.y_coord > uint32(reach) ? p.y_coord - reach : 0;
+                uint32 const highX = std::min<uint32>(p.x_coord + reach, MAX_NUMBER_OF_GRIDS - 1);
+                uint32 const highY = std::min<uint32>(p.y_coord + reach, MAX_NUMBER_OF_GRIDS - 1);
+
+                for (uint32 nx = lowX; nx <= highX; ++nx)
+                {
+                    for (uint32 ny = lowY; ny <= highY; ++ny)
+                    {
+                        if (clusters[nx][ny] != uint16(-1))
+                            continue;
+
+                        clusters[nx][ny] = count;
+                        pending.push_back(GridCoord(nx, ny));
+                    }
+                }
+            }
+        }
+    }
+
+    return count;
+}
+
 struct CorpseGridReset final
 {
     void Visit(CorpseMapType &m)
@@ -179,6 +265,21 @@ void Map::ObjectUpdater::updateCollected(uint32 diff)
     }
 }
 
+Map::CellVisitStats Map::GetCellVisitStats()
+{
+    CellVisitStats stats;
+    stats.visitedCells = VisitedCells.load(std::memory_order_relaxed);
+    stats.skippedCells = SkippedCells.load(std::memory_order_relaxed);
+    return stats;
+}
+
+void Map::AddCellVisitStats(uint32 visitedCells, uint32 skippedCells)
+{
+    VisitedCells.fetch_add(visitedCells, std::memory_order_relaxed);
+    if (skippedCells)
+        SkippedCells.fetch_add(skippedCells, std::memory_order_relaxed);
+}
+
 Map::~Map()
 {
     sScriptMgr->OnDestroyMap(this);
@@ -196,8 +297,6 @@ Map::~Map()
 
     if (!m_scriptSchedule.empty())
         sScriptMgr->DecreaseScheduledScriptCount(m_scriptSchedule.size());
-
-    MMAP::MMapFactory::createOrGetMMapManager()->unloadMapInstance(GetId(), GetInstanceId());
 }
 
 bool Map::ExistMap(uint32 mapid, int gx, int gy)
@@ -352,6 +451,7 @@ void Map::LoadMapAndVMap(int gx, int gy)
     {
         LoadVMap(gx, gy);                                   // Only load the data for the base map
         LoadMMap(gx, gy);
+        InvalidateLineOfSightCache();
     }
 }
 
@@ -360,8 +460,11 @@ _creatureToMoveLock(false), i_mapEntry (sMapStore.LookupEntry(id)), i_spawnMode(
 m_unloadTimer(0), m_VisibleDistance(DEFAULT_VISIBILITY_DISTANCE),
 m_VisibilityNotifyPeriod(DEFAULT_VISIBILITY_NOTIFY_PERIOD),
 i_gridExpiry(expiry), i_scriptLock(false), i_grids(), i_gridMaps(),
-m_activeNonPlayersIter(m_activeNonPlayers.end())
+m_activeNonPlayersIter(m_activeNonPlayers.end()), i_regionUpdateActive(false), i_gridRegions(),
+_lineOfSightSerial(NextLineOfSightSerial.fetch_add(1, std::memory_order_relaxed)), _lineOfSightGeneration(0)
 {
+    resetMarkedCells();
+
     m_parentMap = (_parent ? _parent : this);
 
     //lets initialize visibility distance for map
@@ -398,22 +501,22 @@ float Map::GetVisibilityRange(uint32 zoneId /*= 0*/, uint32 areaId /*= 0*/) cons
 void Map::AddToGrid(Player *obj, Cell const &cell)
 {
     auto const ngrid = getNGrid(cell.GridX(), cell.GridY());
-    ngrid->GetGrid(cell.CellX(), cell.CellY()).AddWorldObject(obj);
+    ngrid->AddWorldObject(cell.CellX(), cell.CellY(), obj);
 }
 
 void Map::AddToGrid(GameObject *obj, Cell const &cell)
 {
     auto const ngrid = getNGrid(cell.GridX(), cell.GridY());
-    ngrid->GetGrid(cell.CellX(), cell.CellY()).AddGridObject(obj);
+    ngrid->AddGridObject(cell.CellX(), cell.CellY(), obj);
 }
 
 void Map::AddToGrid(Creature *obj, Cell const &cell)
 {
     auto const ngrid = getNGrid(cell.GridX(), cell.GridY());
     if (obj->IsWorldObject())
-        ngrid->GetGrid(cell.CellX(), cell.CellY()).AddWorldObject(obj);
+        ngrid->AddWorldObject(cell.CellX(), cell.CellY(), obj);
     else
-        ngrid->GetGrid(cell.CellX(), cell.CellY()).AddGridObject(obj);
+        ngrid->AddGridObject(cell.CellX(), cell.CellY(), obj);
 
     obj->SetCurrentCell(cell);
 }
@@ -437,18 +540,16 @@ void Map::SwitchGridContainers(Creature* obj, bool on)
     auto const ngrid = getNGrid(cell.GridX(), cell.GridY());
     ASSERT(ngrid != nullptr);
 
-    auto &grid = ngrid->GetGrid(cell.CellX(), cell.CellY());
-
     obj->RemoveFromGrid();
 
     if (on)
     {
-        grid.AddWorldObject(obj);
+        ngrid->AddWorldObject(cell.CellX(), cell.CellY(), obj);
         AddWorldObject(obj);
     }
     else
     {
-        grid.AddGridObject(obj);
+        ngrid->AddGridObject(cell.CellX(), cell.CellY(), obj);
         RemoveWorldObject(obj);
     }
 
@@ -529,6 +630,16 @@ void Map::EnsureGridLoadedForActiveObject(const Cell &cell, WorldObject* object)
         TC_LOG_DEBUG("maps", "Active object " UI64FMTD " triggers loading of grid [%u, %u] on map %u", object->GetGUID(), cell.GridX(), cell.GridY(), GetId());
         ResetGridExpiry(*ngrid, 0.1f);
         ngrid->SetGridState(GRID_STATE_ACTIVE);
+
+        // active objects tend to walk on, read the navmesh tiles around
+        // the grid before they are needed
+        MMAP::MMapManager* mmap = MMAP::MMapFactory::createOrGetMMapManager();
+        int gx = (MAX_NUMBER_OF_GRIDS - 1) - cell.GridX();
+        int gy = (MAX_NUMBER_OF_GRIDS - 1) - cell.GridY();
+        for (int dx = -1; dx <= 1; ++dx)
+            for (int dy = -1; dy <= 1; ++dy)
+                if (dx || dy)
+                    mmap->prefetchTile(GetId(), gx + dx, gy + dy);
     }
 }
 
@@ -537,6 +648,8 @@ bool Map::EnsureGridLoaded(const Cell &cell)
 {
     EnsureGridCreated(GridCoord(cell.GridX(), cell.GridY()));
 
+    GridLoadGuardType guard(i_gridLoadLock);
+
     auto const ngrid = getNGrid(cell.GridX(), cell.GridY());
     ASSERT(ngrid != nullptr);
 
@@ -550,7 +663,7 @@ bool Map::EnsureGridLoaded(const Cell &cell)
     Trinity::ObjectGridLoader::LoadN(*ngrid, this, cell);
 
     // Add resurrectable corpses to world object list in grid
-    sObjectAccessor->AddCorpsesToGrid(GridCoord(cell.GridX(), cell.GridY()), ngrid->GetGrid(cell.CellX(), cell.CellY()), this);
+    sObjectAccessor->AddCorpsesToGrid(cell, *ngrid, this);
 
     Balance();
     return true;
@@ -605,13 +718,15 @@ void Map::InitializeObject(Creature* obj)
 }
 
 template<class T>
-bool Map::AddToMap(T *obj)
+bool Map::AddToMap(T *obj, AddedHandler onAdded)
 {
     //TODO: Needs clean up. An object should not be added to map twice.
     if (obj->IsInWorld())
     {
         ASSERT(obj->IsInGrid());
         obj->UpdateObjectVisibility(true);
+        if (onAdded)
+            onAdded();
         return true;
     }
 
@@ -627,6 +742,16 @@ bool Map::AddToMap(T *obj)
     }
 
     Cell cell(cellCoord);
+
+    // grids of other regions are being visited, the object is added once
+    // all regions are updated
+    if (!IsOwnedByUpdatingRegion(cell))
+    {
+        RegionGuardType guard(i_regionLock);
+        i_deferredObjects.push_back({ obj, std::move(onAdded) });
+        return true;
+    }
+
     if (obj->isActiveObject())
         EnsureGridLoadedForActiveObject(cell, obj);
     else
@@ -648,6 +773,9 @@ bool Map::AddToMap(T *obj)
     //something, such as vehicle, needs to be update immediately
     //also, trigger needs to cast spell, if not update, cannot see visual
     obj->UpdateObjectVisibility(true);
+
+    if (onAdded)
+        onAdded();
     return true;
 }
 
@@ -659,47 +787,254 @@ bool Map::IsGridLoaded(const GridCoord &p) const
 
 void Map::Update(const uint32 t_diff)
 {
+    SyncQueryCheck syncQueryCheck(sWorld->getBoolConfig(CONFIG_MAP_UPDATE_ASSERT_SYNC_QUERIES));
+
+    if (PrepareRegionUpdate(t_diff))
+    {
+        Trinity::TaskGroup regions;
+        for (std::size_t index = 0; index < i_regions.size(); ++index)
+            regions.run([this, index, t_diff] { UpdateRegion(index, t_diff); });
+        regions.wait();
+
+        FinishRegionUpdate(t_diff);
+        return;
+    }
+
     // for creature
     auto gridObjectUpdate(Trinity::makeGridVisitor(i_objectUpdater));
     // for pets
     auto worldObjectUpdate(Trinity::makeWorldVisitor(i_objectUpdater));
 
-    _dynamicTree.update(t_diff);
+    {
+        DynamicTreeWriteGuard guard(_dynamicTreeLock);
+        _dynamicTree.update(t_diff);
+    }
 
     /// update active cells around players and active objects
     resetMarkedCells();
 
     // update worldsessions for existing players
     for (m_mapRefIter = m_mapRefManager.begin(); m_mapRefIter != m_mapRefManager.end(); ++m_mapRefIter)
-    {
         if (Player* player = m_mapRefIter->getSource())
+            UpdatePlayerAndNearbyCells(this, player, t_diff, gridObjectUpdate, worldObjectUpdate);
+
+    // non-player active objects, increasing iterator in the loop in case of object removal
+    for (auto &obj: m_activeNonPlayers)
+        if (obj && obj->IsInWorld())
+            VisitNearbyCellsOf(this, obj, gridObjectUpdate, worldObjectUpdate);
+
+    i_objectUpdater.updateCollected(t_diff);
+
+    FinishUpdate(t_diff);
+}
+
+bool Map::PrepareRegionUpdate(const uint32 t_diff)
+{
+    // instances and battlegrounds are small and already updated in parallel
+    if (Instanceable() || !sWorld->getBoolConfig(CONFIG_MAP_REGION_UPDATE))
+        return false;
+
+    if (GetPlayerCount() < sWorld->getIntConfig(CONFIG_MAP_REGION_MIN_PLAYERS))
+        return false;
+
+    // zone scripts are shared by every object of their zone
+    if (sOutdoorPvPMgr->HasZoneOnMap(GetId()) || sBattlefieldMgr->HasZoneOnMap(GetId()))
+        return false;
+
+    GridClusterMap clusters = { };
+    auto const markActiveGrid = [&clusters](WorldObject const* obj)
+    {
+        GridCoord const p = Trinity::ComputeGridCoord(obj->GetPositionX(), obj->GetPositionY());
+        clusters[p.x_coord][p.y_coord] = uint16(-1);
+    };
+
+    // players being teleported inside the map may land anywhere, they are
+    // updated in FinishRegionUpdate() after all regions are done
+    auto const canBeInRegion = [](Player const* player)
+    {
+        return player->IsInWorld() && player->IsPositionValid() && !player->IsBeingTeleportedNear();
+    };
+
+    for (auto itr = m_mapRefManager.begin(); itr != m_mapRefManager.end(); ++itr)
+        if (Player* player = itr->getSource())
+            if (canBeInRegion(player))
+                markActiveGrid(player);
+
+    for (auto const &obj : m_activeNonPlayers)
+        if (obj && obj->IsInWorld() && obj->IsPositionValid())
+            markActiveGrid(obj);
+
+    uint16 const regionCount = ClusterActiveGrids(clusters);
+    if (regionCount < 2)
+        return false;
+
+    // every region owns the grids around its active objects, the grids
+    // between the halos of different regions are owned by none of them
+    memset(i_gridRegions, 0, sizeof(i_gridRegions));
+    for (uint32 x = 0; x < MAX_NUMBER_OF_GRIDS; ++x)
+    {
+        for (uint32 y = 0; y < MAX_NUMBER_OF_GRIDS; ++y)
         {
-            // player->GetSession()->Update(t_diff, MapSessionFilter(player->GetSession()));
+            if (!clusters[x][y])
+                continue;
 
-            WorldSession* session = player->GetSession();
-            MapSessionFilter updater(session);
+            uint32 const lowX = x > MAP_REGION_HALO_GRIDS ? x - MAP_REGION_HALO_GRIDS : 0;
+            uint32 const lowY = y > MAP_REGION_HALO_GRIDS ? y - MAP_REGION_HALO_GRIDS : 0;
+            uint32 const highX = std::min<uint32>(x + MAP_REGION_HALO_GRIDS, MAX_NUMBER_OF_GRIDS - 1);
+            uint32 const highY = std::min<uint32>(y + MAP_REGION_HALO_GRIDS, MAX_NUMBER_OF_GRIDS - 1);
 
-            session->Update(t_diff, updater);
-            // Can be not in world after WorldSession::Update
-            if (player->IsInWorld())
-            {
-                // uint32 _s = getMSTime();
-                player->Update(t_diff);
-                VisitNearbyCellsOf(this, player, gridObjectUpdate, worldObjectUpdate);
-                // uint32 _ms = GetMSTimeDiffToNow(_s);
-                // if (_ms > 100)
-                    // TC_LOG_DEBUG("diff","player->Update: type - player, g:%u Diff - %ums diff %u", player->GetGUIDLow(), _ms, t_diff);
-            }
+            for (uint32 hx = lowX; hx <= highX; ++hx)
+                for (uint32 hy = lowY; hy <= highY; ++hy)
+                    i_gridRegions[hx][hy] = clusters[x][y];
         }
     }
 
-    // non-player active objects, increasing iterator in the loop in case of object removal
-    for (auto &obj: m_activeNonPlayers)
-        if (obj && obj->IsInWorld())
+    i_regions.resize(regionCount);
+
+    for (auto itr = m_mapRefManager.begin(); itr != m_mapRefManager.end(); ++itr)
+    {
+        Player* player = itr->getSource();
+        if (!player)
+            continue;
+
+        if (canBeInRegion(player))
+        {
+            GridCoord const p = Trinity::ComputeGridCoord(player->GetPositionX(), player->GetPositionY());
+            i_regions[clusters[p.x_coord][p.y_coord] - 1].players.push_back(player);
+        }
+        else
+            i_regionBorderPlayers.push_back(player);
+    }
+
+    for (auto const &obj : m_activeNonPlayers)
+    {
+        if (!obj || !obj->IsInWorld() || !obj->IsPositionValid())
+            continue;
+
+        GridCoord const p = Trinity::ComputeGridCoord(obj->GetPositionX(), obj->GetPositionY());
+        i_regions[clusters[p.x_coord][p.y_coord] - 1].activeObjects.push_back(obj);
+    }
+
+    TC_LOG_DEBUG("maps", "Map %u is updated as %u regions (%u players outside of regions)",
+                 GetId(), uint32(regionCount), uint32(i_regionBorderPlayers.size()));
+
+    {
+        DynamicTreeWriteGuard guard(_dynamicTreeLock);
+        _dynamicTree.update(t_diff);
+    }
+
+    resetMarkedCells();
+    i_regionUpdateActive = true;
+    return true;
+}
+
+void Map::UpdateRegion(std::size_t index, const uint32 t_diff)
+{
+    SyncQueryCheck syncQueryCheck(sWorld->getBoolConfig(CONFIG_MAP_UPDATE_ASSERT_SYNC_QUERIES));
+
+    Map const* const previousMap = UpdatingRegionMap;
+    uint16 const previousRegion = UpdatingRegion;
+    UpdatingRegionMap = this;
+    UpdatingRegion = uint16(index + 1);
+
+    MapRegion &region = i_regions[index];
+
+    auto gridObjectUpdate(Trinity::makeGridVisitor(region.objectUpdater));
+    auto worldObjectUpdate(Trinity::makeWorldVisitor(region.objectUpdater));
+
+    for (auto const &player : region.players)
+        UpdatePlayerAndNearbyCells(this, player, t_diff, gridObjectUpdate, worldObjectUpdate);
+
+    for (auto const &obj : region.activeObjects)
+        if (obj->IsInWorld())
             VisitNearbyCellsOf(this, obj, gridObjectUpdate, worldObjectUpdate);
 
+    region.objectUpdater.updateCollected(t_diff);
+
+    UpdatingRegionMap = previousMap;
+    UpdatingRegion = previousRegion;
+}
+
+void Map::FinishRegionUpdate(const uint32 t_diff)
+{
+    i_regionUpdateActive = false;
+    i_regions.clear();
+
+    // relocations that would have crossed into another region
+    for (auto const &relocation : i_deferredRelocations)
+        if (relocation.player->IsInWorld() && relocation.player->GetMap() == this)
+            PlayerRelocation(relocation.player, relocation.x, relocation.y, relocation.z, relocation.orientation);
+
+    i_deferredRelocations.clear();
+
+    // objects spawned by a region outside of its grids, their handlers may
+    // add further objects
+    std::vector<DeferredObject> deferredObjects;
+    deferredObjects.swap(i_deferredObjects);
+
+    for (auto &deferred : deferredObjects)
+    {
+        WorldObject* const obj = deferred.obj;
+        switch (obj->GetTypeId())
+        {
+            case TYPEID_UNIT:
+                AddToMap(obj->ToCreature(), std::move(deferred.onAdded));
+                break;
+            case TYPEID_GAMEOBJECT:
+                AddToMap(obj->ToGameObject(), std::move(deferred.onAdded));
+                break;
+            case TYPEID_DYNAMICOBJECT:
+                AddToMap(obj->ToDynObject(), std::move(deferred.onAdded));
+                break;
+            case TYPEID_AREATRIGGER:
+                AddToMap(obj->ToAreaTrigger(), std::move(deferred.onAdded));
+                break;
+            case TYPEID_CORPSE:
+                AddToMap(static_cast<Corpse*>(obj), std::move(deferred.onAdded));
+                break;
+            default:
+                break;
+        }
+    }
+
+    auto gridObjectUpdate(Trinity::makeGridVisitor(i_objectUpdater));
+    auto worldObjectUpdate(Trinity::makeWorldVisitor(i_objectUpdater));
+
+    // cells already visited by the regions are still marked, only the
+    // surroundings of these players are updated here
+    for (auto const &player : i_regionBorderPlayers)
+        if (player->GetMap() == this)
+            UpdatePlayerAndNearbyCells(this, player, t_diff, gridObjectUpdate, worldObjectUpdate);
+
+    i_regionBorderPlayers.clear();
+
     i_objectUpdater.updateCollected(t_diff);
 
+    // a player listed twice is teleported once, the first call resets its flag
+    for (auto const &player : i_delayedTeleports)
+        if (player->IsInWorld() && player->GetMap() == this)
+            player->ExecuteDelayedTeleport();
+
+    i_delayedTeleports.clear();
+
+    FinishUpdate(t_diff);
+}
+
+bool Map::IsCrossRegionMove(Cell const& oldCell, Cell const& newCell) const
+{
+    return i_gridRegions[oldCell.GridX()][oldCell.GridY()] != i_gridRegions[newCell.GridX()][newCell.GridY()];
+}
+
+bool Map::IsOwnedByUpdatingRegion(Cell const& cell) const
+{
+    if (!i_regionUpdateActive)
+        return true;
+
+    return UpdatingRegionMap == this && i_gridRegions[cell.GridX()][cell.GridY()] == UpdatingRegion;
+}
+
+void Map::FinishUpdate(const uint32 t_diff)
+{
     ///- Process necessary scripts
     if (!m_scriptSchedule.empty())
     {
@@ -760,6 +1095,16 @@ void Map::PlayerRelocation(Player* player, float x, float y, float z, float orie
     Cell old_cell(player->GetPositionX(), player->GetPositionY());
     Cell new_cell(x, y);
 
+    // moving into grids of another region is finished after all regions are updated
+    if (i_regionUpdateActive && IsCrossRegionMove(old_cell, new_cell))
+    {
+        DeferredPlayerRelocation const relocation = { player, x, y, z, orientation };
+
+        RegionGuardType guard(i_regionLock);
+        i_deferredRelocations.push_back(relocation);
+        return;
+    }
+
     player->Relocate(x, y, z, orientation);
     if (player->IsVehicle())
         player->GetVehicleKit()->RelocatePassengers();
@@ -813,6 +1158,7 @@ void Map::AddCreatureToMoveList(Creature* c, float x, float y, float z, float an
     if (_creatureToMoveLock) //can this happen?
         return;
 
+    RegionGuardType guard(i_regionLock);
     if (c->_moveState == CREATURE_CELL_MOVE_NONE)
         _creaturesToMove.push_back(c);
     c->SetNewCellPosition(x, y, z, ang);
@@ -1054,6 +1400,7 @@ bool Map::UnloadGrid(GridContainerType::iterator itr, bool unloadAll)
             // x and y are swapped
             VMAP::VMapFactory::createOrGetVMapManager()->unloadMap(GetId(), gx, gy);
             MMAP::MMapFactory::createOrGetMMapManager()->unloadMap(GetId(), gx, gy);
+            InvalidateLineOfSightCache();
         }
         else
             ((MapInstanced*)m_parentMap)->RemoveGridMapReference(GridCoord(gx, gy));
@@ -1097,6 +1444,7 @@ void Map::UnloadAll()
 // *****************************
 GridMap::GridMap()
 {
+    _mapping = nullptr;
     _flags = 0;
     // Area data
     _gridArea = 0;
@@ -1126,64 +1474,102 @@ GridMap::~GridMap()
     unloadData();
 }
 
+namespace {
+
+typedef std::vector<std::unique_ptr<uint8[]>> MapSectionCopies;
+
+// Returns the array of count elements at offset and moves offset past it,
+// null if the section does not fit in the file. Sections the file layout
+// leaves misaligned for T (e.g. int16 flight bounds after the int8 height
+// arrays) are copied to storage owned by copies.
+template <typename T>
+T const* MapSection(uint8 const* data, std::size_t length, std::size_t& offset, MapSectionCopies& copies, std::size_t count = 1)
+{
+    std::size_t const size = sizeof(T) * count;
+    if (offset > length || length - offset < size)
+        return nullptr;
+
+    uint8 const* section = data + offset;
+    offset += size;
+
+    if (reinterpret_cast<uintptr_t>(section) % alignof(T) != 0)
+    {
+        copies.emplace_back(new uint8[size]);
+        memcpy(copies.back().get(), section, size);
+        section = copies.back().get();
+    }
+
+    return reinterpret_cast<T const*>(section);
+}
+
+} // namespace
+
 bool GridMap::loadData(char *filename)
 {
     // Unload old data if exist
     unloadData();
 
-    map_fileheader header;
     // Not return error if file not found
-    FILE* in = fopen(filename, "rb");
-    if (!in)
+    if (ACE_OS::access(filename, R_OK) != 0)
         return true;
 
-    if (fread(&header, sizeof(header), 1, in) != 1)
+    _mapping = new ACE_Mem_Map();
+    if (_mapping->map(filename, static_cast<size_t>(-1), O_RDONLY, ACE_DEFAULT_FILE_PERMS, PROT_READ, ACE_MAP_PRIVATE) != 0)
+    {
+        TC_LOG_ERROR("maps", "Map file '%s' could not be mapped", filename);
+        unloadData();
+        return false;
+    }
+
+    // the mapping stays valid without the descriptor, don't keep one per loaded grid
+    _mapping->close_handle();
+
+    uint8 const* data = static_cast<uint8 const*>(_mapping->addr());
+    std::size_t const length = _mapping->size();
+
+    std::size_t offset = 0;
+    map_fileheader const* header = MapSection<map_fileheader>(data, length, offset, _sectionCopies);
+    if (!header)
     {
-        fclose(in);
+        unloadData();
         return false;
     }
 
-    if (header.mapMagic.asUInt == MapMagic.asUInt && header.versionMagic.asUInt == MapVersionMagic.asUInt)
+    if (header->mapMagic.asUInt == MapMagic.asUInt && header->versionMagic.asUInt == MapVersionMagic.asUInt)
     {
         // loadup area data
-        if (header.areaMapOffset && !loadAreaData(in, header.areaMapOffset, header.areaMapSize))
+        if (header->areaMapOffset && !loadAreaData(data, length, header->areaMapOffset))
         {
             TC_LOG_ERROR("maps", "Error loading map area data\n");
-            fclose(in);
+            unloadData();
             return false;
         }
         // loadup height data
-        if (header.heightMapOffset && !loadHeightData(in, header.heightMapOffset, header.heightMapSize))
+        if (header->heightMapOffset && !loadHeightData(data, length, header->heightMapOffset))
         {
             TC_LOG_ERROR("maps", "Error loading map height data\n");
-            fclose(in);
+            unloadData();
             return false;
         }
         // loadup liquid data
-        if (header.liquidMapOffset && !loadLiquidData(in, header.liquidMapOffset, header.liquidMapSize))
+        if (header->liquidMapOffset && !loadLiquidData(data, length, header->liquidMapOffset))
         {
             TC_LOG_ERROR("maps", "Error loading map liquids data\n");
-            fclose(in);
+            unloadData();
             return false;
         }
-        fclose(in);
         return true;
     }
     TC_LOG_ERROR("maps", "Map file '%s' is from an incompatible clientversion. Please recreate using the mapextractor.", filename);
-    fclose(in);
+    unloadData();
     return false;
 }
 
 void GridMap::unloadData()
 {
-    delete[] _areaMap;
-    delete[] m_V9;
-    delete[] m_V8;
-    delete[] _maxHeight;
-    delete[] _minHeight;
-    delete[] _liquidEntry;
-    delete[] _liquidFlags;
-    delete[] _liquidMap;
+    delete _mapping;
+    _mapping = nullptr;
+    _sectionCopies.clear();
     _areaMap = NULL;
     m_V9 = NULL;
     m_V8 = NULL;
@@ -1195,61 +1581,56 @@ void GridMap::unloadData()
     _gridGetHeight = &GridMap::getHeightFromFlat;
 }
 
-bool GridMap::loadAreaData(FILE* in, uint32 offset, uint32 /*size*/)
+bool GridMap::loadAreaData(uint8 const* data, std::size_t length, uint32 offset)
 {
-    map_areaHeader header;
-    fseek(in, offset, SEEK_SET);
-
-    if (fread(&header, sizeof(header), 1, in) != 1 || header.fourcc != MapAreaMagic.asUInt)
+    std::size_t pos = offset;
+    map_areaHeader const* header = MapSection<map_areaHeader>(data, length, pos, _sectionCopies);
+    if (!header || header->fourcc != MapAreaMagic.asUInt)
         return false;
 
-    _gridArea = header.gridArea;
-    if (!(header.flags & MAP_AREA_NO_AREA))
+    _gridArea = header->gridArea;
+    if (!(header->flags & MAP_AREA_NO_AREA))
     {
-        _areaMap = new uint16[16 * 16];
-        if (fread(_areaMap, sizeof(uint16), 16*16, in) != 16*16)
+        _areaMap = MapSection<uint16>(data, length, pos, _sectionCopies, 16 * 16);
+        if (!_areaMap)
             return false;
     }
     return true;
 }
 
-bool GridMap::loadHeightData(FILE* in, uint32 offset, uint32 /*size*/)
+bool GridMap::loadHeightData(uint8 const* data, std::size_t length, uint32 offset)
 {
-    map_heightHeader header;
-    fseek(in, offset, SEEK_SET);
-
-    if (fread(&header, sizeof(header), 1, in) != 1 || header.fourcc != MapHeightMagic.asUInt)
+    std::size_t pos = offset;
+    map_heightHeader const* header = MapSection<map_heightHeader>(data, length, pos, _sectionCopies);
+    if (!header || header->fourcc != MapHeightMagic.asUInt)
         return false;
 
-    _gridHeight = header.gridHeight;
-    if (!(header.flags & MAP_HEIGHT_NO_HEIGHT))
+    _gridHeight = header->gridHeight;
+    if (!(header->flags & MAP_HEIGHT_NO_HEIGHT))
     {
-        if ((header.flags & MAP_HEIGHT_AS_INT16))
+        if ((header->flags & MAP_HEIGHT_AS_INT16))
         {
-            m_uint16_V9 = new uint16 [129*129];
-            m_uint16_V8 = new uint16 [128*128];
-            if (fread(m_uint16_V9, sizeof(uint16), 129*129, in) != 129*129 ||
-                fread(m_uint16_V8, sizeof(uint16), 128*128, in) != 128*128)
+            m_uint16_V9 = MapSection<uint16>(data, length, pos, _sectionCopies, 129*129);
+            m_uint16_V8 = MapSection<uint16>(data, length, pos, _sectionCopies, 128*128);
+            if (!m_uint16_V9 || !m_uint16_V8)
                 return false;
-            _gridIntHeightMultiplier = (header.gridMaxHeight - header.gridHeight) / 65535;
+            _gridIntHeightMultiplier = (header->gridMaxHeight - header->gridHeight) / 65535;
             _gridGetHeight = &GridMap::getHeightFromUint16;
         }
-        else if ((header.flags & MAP_HEIGHT_AS_INT8))
+        else if ((header->flags & MAP_HEIGHT_AS_INT8))
         {
-            m_uint8_V9 = new uint8 [129*129];
-            m_uint8_V8 = new uint8 [128*128];
-            if (fread(m_uint8_V9, sizeof(uint8), 129*129, in) != 129*129 ||
-                fread(m_uint8_V8, sizeof(uint8), 128*128, in) != 128*128)
+            m_uint8_V9 = MapSection<uint8>(data, length, pos, _sectionCopies, 129*129);
+            m_uint8_V8 = MapSection<uint8>(data, length, pos, _sectionCopies, 128*128);
+            if (!m_uint8_V9 || !m_uint8_V8)
                 return false;
-            _gridIntHeightMultiplier = (header.gridMaxHeight - header.gridHeight) / 255;
+            _gridIntHeightMultiplier = (header->gridMaxHeight - header->gridHeight) / 255;
             _gridGetHeight = &GridMap::getHeightFromUint8;
         }
         else
         {
-            m_V9 = new float [129*129];
-            m_V8 = new float [128*128];
-            if (fread(m_V9, sizeof(float), 129*129, in) != 129*129 ||
-                fread(m_V8, sizeof(float), 128*128, in) != 128*128)
+            m_V9 = MapSection<float>(data, length, pos, _sectionCopies, 129*129);
+            m_V8 = MapSection<float>(data, length, pos, _sectionCopies, 128*128);
+            if (!m_V9 || !m_V8)
                 return false;
             _gridGetHeight = &GridMap::getHeightFromFloat;
         }
@@ -1257,47 +1638,42 @@ bool GridMap::loadHeightData(FILE* in, uint32 offset, uint32 /*size*/)
     else
         _gridGetHeight = &GridMap::getHeightFromFlat;
 
-    if (header.flags & MAP_HEIGHT_HAS_FLIGHT_BOUNDS)
+    if (header->flags & MAP_HEIGHT_HAS_FLIGHT_BOUNDS)
     {
-        _maxHeight = new int16[3 * 3];
-        _minHeight = new int16[3 * 3];
-        if (fread(_maxHeight, sizeof(int16), 3 * 3, in) != 3 * 3 ||
-            fread(_minHeight, sizeof(int16), 3 * 3, in) != 3 * 3)
+        _maxHeight = MapSection<int16>(data, length, pos, _sectionCopies, 3 * 3);
+        _minHeight = MapSection<int16>(data, length, pos, _sectionCopies, 3 * 3);
+        if (!_maxHeight || !_minHeight)
             return false;
     }
 
     return true;
 }
 
-bool GridMap::loadLiquidData(FILE* in, uint32 offset, uint32 /*size*/)
+bool GridMap::loadLiquidData(uint8 const* data, std::size_t length, uint32 offset)
 {
-    map_liquidHeader header;
-    fseek(in, offset, SEEK_SET);
-
-    if (fread(&header, sizeof(header), 1, in) != 1 || header.fourcc != MapLiquidMagic.asUInt)
+    std::size_t pos = offset;
+    map_liquidHeader const* header = MapSection<map_liquidHeader>(data, length, pos, _sectionCopies);
+    if (!header || header->fourcc != MapLiquidMagic.asUInt)
         return false;
 
-    _liquidType   = header.liquidType;
-    _liquidOffX  = header.offsetX;
-    _liquidOffY  = header.offsetY;
-    _liquidWidth = header.width;
-    _liquidHeight = header.height;
-    _liquidLevel  = header.liquidLevel;
+    _liquidType   = header->liquidType;
+    _liquidOffX  = header->offsetX;
+    _liquidOffY  = header->offsetY;
+    _liquidWidth = header->width;
+    _liquidHeight = header->height;
+    _liquidLevel  = header->liquidLevel;
 
-    if (!(header.flags & MAP_LIQUID_NO_TYPE))
+    if (!(header->flags & MAP_LIQUID_NO_TYPE))
     {
-        _liquidEntry = new uint16[16*16];
-        if (fread(_liquidEntry, sizeof(uint16), 16*16, in) != 16*16)
-            return false;
-
-        _liquidFlags = new uint8[16*16];
-        if (fread(_liquidFlags, sizeof(uint8), 16*16, in) != 16*16)
+        _liquidEntry = MapSection<uint16>(data, length, pos, _sectionCopies, 16*16);
+        _liquidFlags = MapSection<uint8>(data, length, pos, _sectionCopies, 16*16);
+        if (!_liquidEntry || !_liquidFlags)
             return false;
     }
-    if (!(header.flags & MAP_LIQUID_NO_HEIGHT))
+    if (!(header->flags & MAP_LIQUID_NO_HEIGHT))
     {
-        _liquidMap = new float[uint32(_liquidWidth) * uint32(_liquidHeight)];
-        if (fread(_liquidMap, sizeof(float), _liquidWidth*_liquidHeight, in) != (uint32(_liquidWidth) * uint32(_liquidHeight)))
+        _liquidMap = MapSection<float>(data, length, pos, _sectionCopies, uint32(_liquidWidth) * uint32(_liquidHeight));
+        if (!_liquidMap)
             return false;
     }
     return true;
@@ -1418,7 +1794,7 @@ float GridMap::getHeightFromUint8(float x, float y) const
     y_int&=(MAP_RESOLUTION - 1);
 
     int32 a, b, c;
-    uint8 *V9_h1_ptr = &m_uint8_V9[x_int*128 + x_int + y_int];
+    uint8 const* V9_h1_ptr = &m_uint8_V9[x_int*128 + x_int + y_int];
     if (x+y < 1)
     {
         if (x > y)
@@ -1485,7 +1861,7 @@ float GridMap::getHeightFromUint16(float x, float y) const
     y_int&=(MAP_RESOLUTION - 1);
 
     int32 a, b, c;
-    uint16 *V9_h1_ptr = &m_uint16_V9[x_int*128 + x_int + y_int];
+    uint16 const* V9_h1_ptr = &m_uint16_V9[x_int*128 + x_int + y_int];
     if (x+y < 1)
     {
         if (x > y)
@@ -2066,10 +2442,153 @@ float Map::GetWaterLevel(float x, float y) const
         return 0;
 }
 
+namespace {
+
+// Results are cached per thread and only reused for a query with exactly the
+// same endpoints, maps are told apart by serial and every change of dynamic
+// collision bumps the generation of the map. Static geometry of instances
+// is loaded through their parent map, the lifetime bounds how long a
+// result stays around.
+uint32 const LineOfSightLifetime = 500;
+uint32 const LineOfSightCacheSize = 2048;
+
+struct LineOfSightKey
+{
+    uint32 coords[6];           // bit patterns of the endpoint coordinates
+    uint32 phasemask;
+};
+
+struct LineOfSightEntry
+{
+    uint32 map;                 // 0 for an empty slot, map serials start at 1
+    uint32 generation;
+    uint32 time;
+    LineOfSightKey key;
+    bool result;
+};
+
+thread_local LineOfSightEntry LineOfSightCache[LineOfSightCacheSize];
+
+LineOfSightKey MakeLineOfSightKey(float x1, float y1, float z1, float x2, float y2, float z2, uint32 phasemask)
+{
+    float const coords[6] = { x1, y1, z1, x2, y2, z2 };
+
+    LineOfSightKey key;
+    static_assert(sizeof(coords) == sizeof(key.coords), "float must be 32 bits");
+    memcpy(key.coords, coords, sizeof(coords));
+    key.phasemask = phasemask;
+    return key;
+}
+
+LineOfSightEntry& LineOfSightSlot(uint32 map, LineOfSightKey const& key)
+{
+    uint32 hash = map * 2654435761u;
+    for (uint32 coord : key.coords)
+        hash = (hash ^ coord) * 16777619u;
+    hash ^= key.phasemask;
+    return LineOfSightCache[(hash ^ (hash >> 16)) & (LineOfSightCacheSize - 1)];
+}
+
+bool FindLineOfSight(LineOfSightEntry const& entry, uint32 map, uint32 generation, LineOfSightKey const& key, uint32 now, bool& result)
+{
+    LineOfSightLookups.fetch_add(1, std::memory_order_relaxed);
+
+    if (entry.map != map || entry.generation != generation || getMSTimeDiff(entry.time, now) > LineOfSightLifetime)
+        return false;
+
+    if (entry.key.phasemask != key.phasemask || memcmp(entry.key.coords, key.coords, sizeof(key.coords)) != 0)
+        return false;
+
+    LineOfSightHits.fetch_add(1, std::memory_order_relaxed);
+    result = entry.result;
+    return true;
+}
+
+void StoreLineOfSight(LineOfSightEntry& entry, uint32 map, uint32 generation, LineOfSightKey const& key, uint32 now, bool result)
+{
+    entry.map = map;
+    entry.generation = generation;
+    entry.time = now;
+    entry.key = key;
+    entry.result = result;
+}
+
+} // namespace
+
 bool Map::isInLineOfSight(float x1, float y1, float z1, float x2, float y2, float z2, uint32 phasemask, DynamicTreeCallback* dCallback /*= nullptr*/) const
 {
-    return VMAP::VMapFactory::createOrGetVMapManager()->isInLineOfSight(GetId(), x1, y1, z1, x2, y2, z2)
-        && _dynamicTree.isInLineOfSight(x1, y1, z1, x2, y2, z2, phasemask, dCallback);
+    // the callback wants the gameobject in the way, only the result is cached
+    if (dCallback)
+        return CheckLineOfSight(x1, y1, z1, x2, y2, z2, phasemask, dCallback);
+
+    // read before testing, a change of collision meanwhile makes the result stale
+    uint32 const generation = _lineOfSightGeneration.load(std::memory_order_relaxed);
+    uint32 const now = getMSTime();
+
+    LineOfSightKey const key = MakeLineOfSightKey(x1, y1, z1, x2, y2, z2, phasemask);
+    LineOfSightEntry& entry = LineOfSightSlot(_lineOfSightSerial, key);
+
+    bool result;
+    if (FindLineOfSight(entry, _lineOfSightSerial, generation, key, now, result))
+        return result;
+
+    result = CheckLineOfSight(x1, y1, z1, x2, y2, z2, phasemask, nullptr);
+    StoreLineOfSight(entry, _lineOfSightSerial, generation, key, now, result);
+    return result;
+}
+
+void Map::isInLineOfSight(float x1, float y1, float z1, G3D::Vector3 const* ends, uint32 count, uint32 phasemask, bool* results) const
+{
+    uint32 const generation = _lineOfSightGeneration.load(std::memory_order_relaxed);
+    uint32 const now = getMSTime();
+
+    std::vector<uint32> misses;
+    misses.reserve(count);
+
+    for (uint32 i = 0; i < count; ++i)
+    {
+        LineOfSightKey const key = MakeLineOfSightKey(x1, y1, z1, ends[i].x, ends[i].y, ends[i].z, phasemask);
+        if (!FindLineOfSight(LineOfSightSlot(_lineOfSightSerial, key), _lineOfSightSerial, generation, key, now, results[i]))
+            misses.push_back(i);
+    }
+
+    if (misses.empty())
+        return;
+
+    VMAP::IVMapManager* vmgr = VMAP::VMapFactory::createOrGetVMapManager();
+    for (uint32 i : misses)
+        results[i] = vmgr->isInLineOfSight(GetId(), x1, y1, z1, ends[i].x, ends[i].y, ends[i].z);
+
+    // every segment still open is tested under a single read lock
+    {
+        DynamicTreeReadGuard guard(_dynamicTreeLock);
+        for (uint32 i : misses)
+            if (results[i])
+                results[i] = _dynamicTree.isInLineOfSight(x1, y1, z1, ends[i].x, ends[i].y, ends[i].z, phasemask);
+    }
+
+    for (uint32 i : misses)
+    {
+        LineOfSightKey const key = MakeLineOfSightKey(x1, y1, z1, ends[i].x, ends[i].y, ends[i].z, phasemask);
+        StoreLineOfSight(LineOfSightSlot(_lineOfSightSerial, key), _lineOfSightSerial, generation, key, now, results[i]);
+    }
+}
+
+bool Map::CheckLineOfSight(float x1, float y1, float z1, float x2, float y2, float z2, uint32 phasemask, DynamicTreeCallback* dCallback) const
+{
+    if (!VMAP::VMapFactory::createOrGetVMapManager()->isInLineOfSight(GetId(), x1, y1, z1, x2, y2, z2))
+        return false;
+
+    DynamicTreeReadGuard guard(_dynamicTreeLock);
+    return _dynamicTree.isInLineOfSight(x1, y1, z1, x2, y2, z2, phasemask, dCallback);
+}
+
+Map::LineOfSightStats Map::GetLineOfSightStats()
+{
+    LineOfSightStats stats;
+    stats.lookups = LineOfSightLookups.load(std::memory_order_relaxed);
+    stats.hits = LineOfSightHits.load(std::memory_order_relaxed);
+    return stats;
 }
 
 bool Map::getObjectHitPos(uint32 phasemask, float x1, float y1, float z1, float x2, float y2, float z2, float& rx, float& ry, float& rz, float modifyDist, DynamicTreeCallback* dCallback /*= nullptr*/)
@@ -2078,7 +2597,11 @@ bool Map::getObjectHitPos(uint32 phasemask, float x1, float y1, float z1, float
     G3D::Vector3 dstPos(x2, y2, z2);
 
     G3D::Vector3 resultPos;
-    bool result = _dynamicTree.getObjectHitPos(phasemask, startPos, dstPos, resultPos, modifyDist, dCallback);
+    bool result;
+    {
+        DynamicTreeReadGuard guard(_dynamicTreeLock);
+        result = _dynamicTree.getObjectHitPos(phasemask, startPos, dstPos, resultPos, modifyDist, dCallback);
+    }
 
     rx = resultPos.x;
     ry = resultPos.y;
@@ -2089,7 +2612,11 @@ bool Map::getObjectHitPos(uint32 phasemask, float x1, float y1, float z1, float
 float Map::GetHeight(uint32 phasemask, float x, float y, float z, bool vmap/*=true*/, float maxSearchDist/*=DEFAULT_HEIGHT_SEARCH*/, DynamicTreeCallback* dCallback /*= nullptr*/) const
 {
     float vmapZ = GetHeight(x, y, z, vmap, maxSearchDist);
-    float goZ = _dynamicTree.getHeight(x, y, z, maxSearchDist, phasemask, dCallback);
+    float goZ;
+    {
+        DynamicTreeReadGuard guard(_dynamicTreeLock);
+        goZ = _dynamicTree.getHeight(x, y, z, maxSearchDist, phasemask, dCallback);
+    }
     if (vmapZ > goZ && dCallback)
         dCallback->go = nullptr;
 
@@ -2260,6 +2787,7 @@ void Map::AddObjectToRemoveList(WorldObject* obj)
 
     obj->CleanupsBeforeDelete(false);                            // remove or simplify at least cross referenced links
 
+    RegionGuardType guard(i_regionLock);
     i_objectsToRemove.insert(obj);
     //TC_LOG_DEBUG("maps", "Object (GUID: %u TypeId: %u) added to removing list.", obj->GetGUIDLow(), obj->GetTypeId());
 }
@@ -2272,6 +2800,8 @@ void Map::AddObjectToSwitchList(WorldObject* obj, bool on)
     if (obj->GetTypeId() != TYPEID_UNIT)
         return;
 
+    RegionGuardType guard(i_regionLock);
+
     std::map<WorldObject*, bool>::iterator itr = i_objectsToSwitch.find(obj);
     if (itr == i_objectsToSwitch.end())
         i_objectsToSwitch.insert(itr, std::make_pair(obj, on));
@@ -2440,11 +2970,11 @@ void Map::RemoveFromActive(Creature* c)
     }
 }
 
-template bool Map::AddToMap(Corpse*);
-template bool Map::AddToMap(Creature*);
-template bool Map::AddToMap(GameObject*);
-template bool Map::AddToMap(DynamicObject*);
-template bool Map::AddToMap(AreaTrigger*);
+template bool Map::AddToMap(Corpse*, AddedHandler);
+template bool Map::AddToMap(Creature*, AddedHandler);
+template bool Map::AddToMap(GameObject*, AddedHandler);
+template bool Map::AddToMap(DynamicObject*, AddedHandler);
+template bool Map::AddToMap(AreaTrigger*, AddedHandler);
 
 template void Map::RemoveFromMap(Corpse*, bool);
 template void Map::RemoveFromMap(Creature*, bool);
@@ -3023,7 +3553,10 @@ void Map::SaveCreatureRespawnTime(uint32 dbGuid, time_t respawnTime)
         return;
     }
 
-    _creatureRespawnTimes[dbGuid] = respawnTime;
+    {
+        RegionGuardType guard(i_regionLock);
+        _creatureRespawnTimes[dbGuid] = respawnTime;
+    }
 
     PreparedStatement* stmt = CharacterDatabase.GetPreparedStatement(CHAR_REP_CREATURE_RESPAWN);
     stmt->setUInt32(0, dbGuid);
@@ -3035,7 +3568,10 @@ void Map::SaveCreatureRespawnTime(uint32 dbGuid, time_t respawnTime)
 
 void Map::RemoveCreatureRespawnTime(uint32 dbGuid)
 {
-    _creatureRespawnTimes.erase(dbGuid);
+    {
+        RegionGuardType guard(i_regionLock);
+        _creatureRespawnTimes.erase(dbGuid);
+    }
 
     PreparedStatement* stmt = CharacterDatabase.GetPreparedStatement(CHAR_DEL_CREATURE_RESPAWN);
     stmt->setUInt32(0, dbGuid);
@@ -3053,7 +3589,10 @@ void Map::SaveGORespawnTime(uint32 dbGuid, time_t respawnTime)
         return;
     }
 
-    _goRespawnTimes[dbGuid] = respawnTime;
+    {
+        RegionGuardType guard(i_regionLock);
+        _goRespawnTimes[dbGuid] = respawnTime;
+    }
 
     PreparedStatement* stmt = CharacterDatabase.GetPreparedStatement(CHAR_REP_GO_RESPAWN);
     stmt->setUInt32(0, dbGuid);
@@ -3065,7 +3604,10 @@ void Map::SaveGORespawnTime(uint32 dbGuid, time_t respawnTime)
 
 void Map::RemoveGORespawnTime(uint32 dbGuid)
 {
-    _goRespawnTimes.erase(dbGuid);
+    {
+        RegionGuardType guard(i_regionLock);
+        _goRespawnTimes.erase(dbGuid);
+    }
 
     PreparedStatement* stmt = CharacterDatabase.GetPreparedStatement(CHAR_DEL_GO_RESPAWN);
     stmt->setUInt32(0, dbGuid);
@@ -3204,6 +3746,8 @@ uint32 Map::GetGridCount()
 
 WorldObject* Map::GetActiveObjectWithEntry(uint32 entry)
 {
+    RegionGuardType guard(i_regionLock);
+
     // non-player active objects, increasing iterator in the loop in case of object removal
     for (m_activeNonPlayersIter = m_activeNonPlayers.begin(); m_activeNonPlayersIter != m_activeNonPlayers.end();)
     {
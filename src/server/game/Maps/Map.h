@@ -32,12 +32,16 @@
 #include "DynamicTree.h"
 #include "GameObjectModel.h"
 #include "NGrid.h"
+#include "PathCorridorCache.h"
+
+#include <ting/shared_mutex.hpp>
 
 #include <functional>
 
+#include <atomic>
 #include <mutex>
-#include <bitset>
 #include <list>
+#include <memory>
 #include <unordered_set>
 
 class Unit;
@@ -55,6 +59,7 @@ struct ScriptAction;
 struct Position;
 class WorldLocation;
 class Battleground;
+class ACE_Mem_Map;
 class MapInstanced;
 class InstanceMap;
 class BattlegroundMap;
@@ -172,33 +177,40 @@ struct LiquidData
     float  depth_level;
 };
 
+// View over a read-only mapping of a .map tile, section arrays point
+// straight into the file so loading a grid only validates the headers.
+// Sections not aligned for their type in the file are copied.
+// Instances use the tiles of their parent map (see Map::LoadMap).
 class GridMap
 {
+    ACE_Mem_Map* _mapping;
+    std::vector<std::unique_ptr<uint8[]>> _sectionCopies;
+
     uint32  _flags;
     union{
-        float* m_V9;
-        uint16* m_uint16_V9;
-        uint8* m_uint8_V9;
+        float const* m_V9;
+        uint16 const* m_uint16_V9;
+        uint8 const* m_uint8_V9;
     };
     union{
-        float* m_V8;
-        uint16* m_uint16_V8;
-        uint8* m_uint8_V8;
+        float const* m_V8;
+        uint16 const* m_uint16_V8;
+        uint8 const* m_uint8_V8;
     };
-    int16* _maxHeight;
-    int16* _minHeight;
+    int16 const* _maxHeight;
+    int16 const* _minHeight;
     // Height level data
     float _gridHeight;
     float _gridIntHeightMultiplier;
 
     // Area data
-    uint16* _areaMap;
+    uint16 const* _areaMap;
 
     // Liquid data
     float _liquidLevel;
-    uint16* _liquidEntry;
-    uint8* _liquidFlags;
-    float* _liquidMap;
+    uint16 const* _liquidEntry;
+    uint8 const* _liquidFlags;
+    float const* _liquidMap;
     uint16 _gridArea;
     uint16 _liquidType;
     uint8 _liquidOffX;
@@ -207,9 +219,9 @@ class GridMap
     uint8 _liquidHeight;
 
 
-    bool loadAreaData(FILE* in, uint32 offset, uint32 size);
-    bool loadHeightData(FILE* in, uint32 offset, uint32 size);
-    bool loadLiquidData(FILE* in, uint32 offset, uint32 size);
+    bool loadAreaData(uint8 const* data, std::size_t length, uint32 offset);
+    bool loadHeightData(uint8 const* data, std::size_t length, uint32 offset);
+    bool loadLiquidData(uint8 const* data, std::size_t length, uint32 offset);
 
     // Get height functions and pointers
     typedef float (GridMap::*GetHeightPtr) (float x, float y) const;
@@ -263,6 +275,7 @@ enum LevelRequirementVsMode
 #define MAX_FALL_DISTANCE     250000.0f                     // "unlimited fall" to find VMap ground if it is available, just larger than MAX_HEIGHT - INVALID_HEIGHT
 #define DEFAULT_HEIGHT_SEARCH     50.0f                     // default search distance to find height at nearby locations
 #define MIN_UNLOAD_DELAY      60000                         // immediate unload
+#define MAP_REGION_HALO_GRIDS     2                         // grids around an active object that belong to its update region
 
 typedef std::map<uint32/*leaderDBGUID*/, CreatureGroup*>        CreatureGroupHolderType;
 
@@ -287,6 +300,36 @@ class Map
         std::vector<WorldObject*> i_objectsToUpdate;
     };
 
+    // part of the map that can be updated independently of the others,
+    // see Map::PrepareRegionUpdate()
+    struct MapRegion final
+    {
+        std::vector<Player*> players;
+        std::vector<WorldObject*> activeObjects;
+        ObjectUpdater objectUpdater;
+    };
+
+    struct DeferredPlayerRelocation final
+    {
+        Player* player;
+        float x, y, z, orientation;
+    };
+
+    typedef std::function<void()> AddedHandler;
+
+    struct DeferredObject final
+    {
+        WorldObject* obj;
+        AddedHandler onAdded;
+    };
+
+    typedef std::mutex RegionLockType;
+    typedef std::lock_guard<RegionLockType> RegionGuardType;
+
+    typedef ting::shared_mutex DynamicTreeLock;
+    typedef ting::shared_lock<DynamicTreeLock> DynamicTreeReadGuard;
+    typedef std::lock_guard<DynamicTreeLock> DynamicTreeWriteGuard;
+
     public:
         // we can't use unordered_map due to possible iterator invalidation at insert
         typedef std::map<std::size_t, NGrid> GridContainerType;
@@ -312,16 +355,43 @@ class Map
 
         virtual bool AddPlayerToMap(Player*, bool initPlayer = true);
         virtual void RemovePlayerFromMap(Player*, bool);
-        template<class T> bool AddToMap(T *);
+        // an object added by a region into grids of another region is only
+        // queued and enters the world in FinishRegionUpdate(), check
+        // IsInWorld() after the call; onAdded runs once it is in the world
+        template<class T> bool AddToMap(T *, AddedHandler onAdded = AddedHandler());
         template<class T> void RemoveFromMap(T *, bool);
 
         virtual void Update(const uint32);
 
+        bool IsRegionUpdateInProgress() const { return i_regionUpdateActive; }
+
+        // far teleports change the player list of the map, players requesting
+        // one during a region update are teleported in FinishRegionUpdate()
+        void AddDelayedTeleport(Player* player)
+        {
+            RegionGuardType guard(i_regionLock);
+            i_delayedTeleports.push_back(player);
+        }
+
         float GetMapVisibleDistance() const { return m_VisibleDistance; }
         float GetMaxPossibleVisibilityRange() { return m_maxPossibleVisibilityRange; }
-        void AddImportantCreature(Creature* cre) { m_importantForVisibilityCreatureList.push_back(cre); }
-        void RemoveImportantCreature(Creature* cre) { m_importantForVisibilityCreatureList.remove(cre); }
-        std::list<Creature*> GetImportantCreatureList() { return m_importantForVisibilityCreatureList; }
+        void AddImportantCreature(Creature* cre)
+        {
+            RegionGuardType guard(i_regionLock);
+            m_importantForVisibilityCreatureList.push_back(cre);
+        }
+
+        void RemoveImportantCreature(Creature* cre)
+        {
+            RegionGuardType guard(i_regionLock);
+            m_importantForVisibilityCreatureList.remove(cre);
+        }
+
+        std::list<Creature*> GetImportantCreatureList()
+        {
+            RegionGuardType guard(i_regionLock);
+            return m_importantForVisibilityCreatureList;
+        }
 
         float GetVisibilityRange(uint32 zoneId = 0, uint32 areaId = 0) const;
         //function for setting up visibility distance for maps on per-type/per-Id basis
@@ -330,8 +400,18 @@ class Map
         void PlayerRelocation(Player*, float x, float y, float z, float orientation);
         void CreatureRelocation(Creature* creature, float x, float y, float z, float ang, bool respawnRelocationOnFail = true);
 
+        // returns false if the cell was skipped: grid not loaded or nothing to visit in the cell
         template <typename Visitor>
-        void Visit(const Cell& cell, Visitor &&visitor);
+        bool Visit(const Cell& cell, Visitor &&visitor);
+
+        struct CellVisitStats
+        {
+            uint64 visitedCells;
+            uint64 skippedCells;
+        };
+
+        static CellVisitStats GetCellVisitStats();
+        static void AddCellVisitStats(uint32 visitedCells, uint32 skippedCells);
 
         void loadGridsInRange(Position const &center, float radius);
 
@@ -440,16 +520,36 @@ class Map
         void UpdateObjectVisibility(WorldObject* obj, Cell cell, CellCoord cellpair);
         void UpdateObjectsVisibilityFor(Player* player, Cell cell, CellCoord cellpair);
 
-        void resetMarkedCells() { marked_cells.reset(); }
-        bool isCellMarked(uint32 pCellId) { return marked_cells.test(pCellId); }
-        void markCell(uint32 pCellId) { marked_cells.set(pCellId); }
+        // cells can be marked concurrently by several regions of the same map
+        void resetMarkedCells()
+        {
+            for (auto &word : marked_cells)
+                word.store(0, std::memory_order_relaxed);
+        }
+
+        // returns true if the cell was already marked, only one of the
+        // concurrent callers gets false and visits the cell
+        bool markCell(uint32 pCellId)
+        {
+            uint64 const bit = uint64(1) << (pCellId % 64);
+            return (marked_cells[pCellId / 64].fetch_or(bit, std::memory_order_relaxed) & bit) != 0;
+        }
 
         bool HavePlayers() const { return !m_mapRefManager.isEmpty(); }
         uint32 GetPlayersCountExceptGMs() const;
         bool ActiveObjectsNearGrid(NGrid const& ngrid) const;
 
-        void AddWorldObject(WorldObject* obj) { i_worldObjects.insert(obj); }
-        void RemoveWorldObject(WorldObject* obj) { i_worldObjects.erase(obj); }
+        void AddWorldObject(WorldObject* obj)
+        {
+            RegionGuardType guard(i_regionLock);
+            i_worldObjects.insert(obj);
+        }
+
+        void RemoveWorldObject(WorldObject* obj)
+        {
+            RegionGuardType guard(i_regionLock);
+            i_worldObjects.erase(obj);
+        }
 
         uint32 GetGridCount();
 
@@ -469,9 +569,9 @@ class Map
         {
             auto const ngrid = getNGrid(cell.GridX(), cell.GridY());
             if (obj->IsWorldObject())
-                ngrid->GetGrid(cell.CellX(), cell.CellY()).template AddWorldObject<T>(obj);
+                ngrid->template AddWorldObject<T>(cell.CellX(), cell.CellY(), obj);
             else
-                ngrid->GetGrid(cell.CellX(), cell.CellY()).template AddGridObject<T>(obj);
+                ngrid->template AddGridObject<T>(cell.CellX(), cell.CellY(), obj);
         }
 
         void AddToGrid(Player *obj, Cell const &cell);
@@ -504,10 +604,14 @@ class Map
         template<class NOTIFIER> void VisitWorld(const float &x, const float &y, float radius, NOTIFIER &notifier);
         template<class NOTIFIER> void VisitGrid(const float &x, const float &y, float radius, NOTIFIER &notifier);
         CreatureGroupHolderType CreatureGroupHolder;
+        std::mutex CreatureGroupHolderLock;
 
         void UpdateIteratorBack(Player* player);
 
-        TempSummon* SummonCreature(uint32 entry, Position const& pos, SummonPropertiesEntry const* properties = NULL, uint32 duration = 0, Unit* summoner = NULL, uint64 targetGuid = 0, uint32 spellId = 0, int32 vehId = 0, uint64 viewerGuid = 0, std::list<uint64>* viewersList = NULL);
+        // returns NULL as well when the summon is spawned into the grids of
+        // another region, it is added once the regions are updated
+        // summonType is a TempSummonType, 0 keeps the one derived from the duration
+        TempSummon* SummonCreature(uint32 entry, Position const& pos, SummonPropertiesEntry const* properties = NULL, uint32 duration = 0, Unit* summoner = NULL, uint64 targetGuid = 0, uint32 spellId = 0, int32 vehId = 0, uint64 viewerGuid = 0, std::list<uint64>* viewersList = NULL, uint32 summonType = 0);
         Creature* GetCreature(uint64 guid);
         GameObject* GetGameObject(uint64 guid);
         DynamicObject* GetDynamicObject(uint64 guid);
@@ -521,10 +625,47 @@ class Map
         float GetMinHeight(float x, float y) const;
         float GetHeight(uint32 phasemask, float x, float y, float z, bool vmap = true, float maxSearchDist = DEFAULT_HEIGHT_SEARCH, DynamicTreeCallback* dCallback = nullptr) const;
         bool isInLineOfSight(float x1, float y1, float z1, float x2, float y2, float z2, uint32 phasemask, DynamicTreeCallback* dCallback = nullptr) const;
-        void Balance() { _dynamicTree.balance(); }
-        void RemoveGameObjectModel(const GameObjectModel& model) { _dynamicTree.remove(model); }
-        void InsertGameObjectModel(const GameObjectModel& model) { _dynamicTree.insert(model); }
-        bool ContainsGameObjectModel(const GameObjectModel& model) const { return _dynamicTree.contains(model);}
+        // tests the segments from (x1, y1, z1) to each of ends, results are in the order of ends
+        void isInLineOfSight(float x1, float y1, float z1, G3D::Vector3 const* ends, uint32 count, uint32 phasemask, bool* results) const;
+        // cached results are dropped, must be called whenever dynamic collision changes
+        void InvalidateLineOfSightCache() { _lineOfSightGeneration.fetch_add(1, std::memory_order_relaxed); }
+
+        struct LineOfSightStats
+        {
+            uint64 lookups;
+            uint64 hits;
+        };
+
+        static LineOfSightStats GetLineOfSightStats();
+
+        void Balance()
+        {
+            DynamicTreeWriteGuard guard(_dynamicTreeLock);
+            _dynamicTree.balance();
+        }
+
+        void RemoveGameObjectModel(const GameObjectModel& model)
+        {
+            DynamicTreeWriteGuard guard(_dynamicTreeLock);
+            _dynamicTree.remove(model);
+            InvalidateLineOfSightCache();
+        }
+
+        void InsertGameObjectModel(const GameObjectModel& model)
+        {
+            DynamicTreeWriteGuard guard(_dynamicTreeLock);
+            _dynamicTree.insert(model);
+            InvalidateLineOfSightCache();
+        }
+
+        bool ContainsGameObjectModel(const GameObjectModel& model) const
+        {
+            DynamicTreeReadGuard guard(_dynamicTreeLock);
+            return _dynamicTree.contains(model);
+        }
+        // corridors found by the path generators of this map, see PathGenerator::FindPolyPath
+        PathCorridorCache& GetPathCorridorCache() { return _pathCorridorCache; }
+
         bool getObjectHitPos(uint32 phasemask, float x1, float y1, float z1, float x2, float y2, float z2, float& rx, float &ry, float& rz, float modifyDist, DynamicTreeCallback* dCallback = nullptr);
         void UpdateEncounterState(EncounterCreditType type, uint32 creditEntry, Unit* source);
 
@@ -535,6 +676,7 @@ class Map
         time_t GetLinkedRespawnTime(uint64 guid) const;
         time_t GetCreatureRespawnTime(uint32 dbGuid) const
         {
+            RegionGuardType guard(i_regionLock);
             auto itr = _creatureRespawnTimes.find(dbGuid);
             if (itr != _creatureRespawnTimes.end())
                 return itr->second;
@@ -544,6 +686,7 @@ class Map
 
         time_t GetGORespawnTime(uint32 dbGuid) const
         {
+            RegionGuardType guard(i_regionLock);
             auto itr = _goRespawnTimes.find(dbGuid);
             if (itr != _goRespawnTimes.end())
                 return itr->second;
@@ -599,6 +742,19 @@ class Map
 
         void UpdateActiveCells(const float &x, const float &y, const uint32 t_diff);
 
+        // Large continents can be updated as several independent regions: clusters
+        // of active grids far enough from each other that objects of one cluster
+        // cannot reach objects of another one within a tick. When
+        // PrepareRegionUpdate() splits the map, Update() runs every region through
+        // UpdateRegion() on the thread pool and FinishRegionUpdate() runs the
+        // serial part of the tick once all of them are done.
+        bool PrepareRegionUpdate(const uint32 t_diff);
+        void UpdateRegion(std::size_t index, const uint32 t_diff);
+        void FinishRegionUpdate(const uint32 t_diff);
+        void FinishUpdate(const uint32 t_diff);
+        bool IsCrossRegionMove(Cell const& oldCell, Cell const& newCell) const;
+        bool IsOwnedByUpdatingRegion(Cell const& cell) const;
+
     protected:
         void SetUnloadReferenceLock(const GridCoord &p, bool on) { getNGrid(p.x_coord, p.y_coord)->setUnloadReferenceLock(on); }
 
@@ -610,6 +766,11 @@ class Map
         float m_VisibleDistance;
         float m_maxPossibleVisibilityRange;
         DynamicMapTree _dynamicTree;
+        mutable DynamicTreeLock _dynamicTreeLock;
+
+        bool CheckLineOfSight(float x1, float y1, float z1, float x2, float y2, float z2, uint32 phasemask, DynamicTreeCallback* dCallback) const;
+
+        PathCorridorCache _pathCorridorCache;
 
         MapRefManager m_mapRefManager;
         MapRefManager::iterator m_mapRefIter;
@@ -644,10 +805,31 @@ class Map
         typedef std::lock_guard<GridLockType> GridGuardType;
         GridLockType i_gridLock;
 
+        // object data of a grid is loaded by one thread at a time, loading
+        // may add objects that load the same grid again
+        typedef std::recursive_mutex GridLoadLockType;
+        typedef std::lock_guard<GridLoadLockType> GridLoadGuardType;
+        GridLoadLockType i_gridLoadLock;
+
         NGrid *i_grids[MAX_NUMBER_OF_GRIDS][MAX_NUMBER_OF_GRIDS];
         GridMap *i_gridMaps[MAX_NUMBER_OF_GRIDS][MAX_NUMBER_OF_GRIDS];
 
-        std::bitset<TOTAL_NUMBER_OF_CELLS_PER_MAP*TOTAL_NUMBER_OF_CELLS_PER_MAP> marked_cells;
+        std::atomic<uint64> marked_cells[TOTAL_NUMBER_OF_CELLS_PER_MAP * TOTAL_NUMBER_OF_CELLS_PER_MAP / 64];
+
+        // guards the containers above and below that objects of concurrently
+        // updated regions may modify
+        mutable RegionLockType i_regionLock;
+        bool i_regionUpdateActive;
+        std::vector<MapRegion> i_regions;
+        std::vector<Player*> i_regionBorderPlayers;
+        std::vector<DeferredPlayerRelocation> i_deferredRelocations;
+        std::vector<DeferredObject> i_deferredObjects;
+        std::vector<Player*> i_delayedTeleports;
+        uint16 i_gridRegions[MAX_NUMBER_OF_GRIDS][MAX_NUMBER_OF_GRIDS];
+
+        // identify cached line of sight results of this map, see isInLineOfSight
+        uint32 const _lineOfSightSerial;
+        std::atomic<uint32> _lineOfSightGeneration;
 
         bool i_scriptLock;
         std::set<WorldObject*> i_objectsToRemove;
@@ -663,12 +845,14 @@ class Map
         template <typename T>
         void AddToActiveHelper(T* obj)
         {
+            RegionGuardType guard(i_regionLock);
             m_activeNonPlayers.insert(obj);
         }
 
         template <typename T>
         void RemoveFromActiveHelper(T* obj)
         {
+            RegionGuardType guard(i_regionLock);
             m_activeNonPlayers.erase(obj);
         }
 
@@ -739,14 +923,16 @@ class BattlegroundMap : public Map
 };
 
 template <typename Visitor>
-inline void Map::Visit(Cell const& cell, Visitor &&visitor)
+inline bool Map::Visit(Cell const& cell, Visitor &&visitor)
 {
     if (!cell.NoCreate())
         EnsureGridLoaded(cell);
 
     auto const grid = getNGrid(cell.GridX(), cell.GridY());
     if (grid && grid->isGridObjectDataLoaded())
-        grid->VisitGrid(cell.CellX(), cell.CellY(), std::forward<Visitor>(visitor));
+        return grid->VisitGrid(cell.CellX(), cell.CellY(), std::forward<Visitor>(visitor));
+
+    return false;
 }
 
 template <typename Notifier>
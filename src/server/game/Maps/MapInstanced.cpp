@@ -52,6 +52,7 @@ void MapInstanced::Update(const uint32 t)
     Map::Update(t);
 
     // update the instanced maps
+    Trinity::TaskGroup updates;
     InstancedMaps::iterator i = m_InstancedMaps.begin();
 
     while (i != m_InstancedMaps.end())
@@ -67,20 +68,25 @@ void MapInstanced::Update(const uint32 t)
         else
         {
             // update only here, because it may schedule some bad things before delete
-            sThreadPoolMgr->schedule([instanced, t] { instanced->Update(t); });
+            updates.run([instanced, t] { instanced->Update(t); });
             ++i;
         }
     }
+
+    updates.wait();
 }
 
 void MapInstanced::DelayedUpdate(const uint32 diff)
 {
+    Trinity::TaskGroup updates;
     for (InstancedMaps::iterator i = m_InstancedMaps.begin(); i != m_InstancedMaps.end(); ++i) {
         Map * const instanced = i->second;
-        sThreadPoolMgr->schedule([instanced, diff] { instanced->DelayedUpdate(diff); });
+        updates.run([instanced, diff] { instanced->DelayedUpdate(diff); });
     }
 
     Map::DelayedUpdate(diff); // this may be removed
+
+    updates.wait();
 }
 
 /*
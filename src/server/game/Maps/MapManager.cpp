@@ -34,6 +34,7 @@
 #include "WorldPacket.h"
 #include "Group.h"
 #include "ThreadPoolMgr.hpp"
+#include "MMapFactory.h"
 
 #include <thread>
 
@@ -251,17 +252,27 @@ void MapManager::Update(uint32 diff)
     uint32 curr = uint32(i_timer.GetCurrent());
     i_timer.SetCurrent(0);
 
-    for (MapMapType::iterator i = i_maps.begin(); i != i_maps.end(); ++i) {
-        Map * const map = i->second;
-        sThreadPoolMgr->schedule([map, curr] { map->Update(curr); });
+    // navmesh tiles read in the background since the last tick, no path
+    // queries run at this point
+    MMAP::MMapFactory::createOrGetMMapManager()->commitPendingTiles();
+
+    {
+        Trinity::TaskGroup updates;
+        for (MapMapType::iterator i = i_maps.begin(); i != i_maps.end(); ++i) {
+            Map * const map = i->second;
+            updates.run([map, curr] { map->Update(curr); });
+        }
+        updates.wait();
     }
-    sThreadPoolMgr->wait();
 
-    for (MapMapType::iterator i = i_maps.begin(); i != i_maps.end(); ++i) {
-        Map * const map = i->second;
-        sThreadPoolMgr->schedule([map, curr] { map->DelayedUpdate(curr); });
+    {
+        Trinity::TaskGroup updates;
+        for (MapMapType::iterator i = i_maps.begin(); i != i_maps.end(); ++i) {
+            Map * const map = i->second;
+            updates.run([map, curr] { map->DelayedUpdate(curr); });
+        }
+        updates.wait();
     }
-    sThreadPoolMgr->wait();
 
     sObjectAccessor->Update(curr);
 
@@ -0,0 +1,124 @@
+/*
+ * Copyright (C) 2008-2017 TrinityCore <http://www.trinitycore.org/>
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; either version 2 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "PathCorridorCache.h"
+#include "Timer.h"
+
+#include <algorithm>
+#include <atomic>
+
+namespace
+{
+    std::atomic<uint64> CorridorLookups(0);
+    std::atomic<uint64> CorridorHits(0);
+    std::atomic<uint64> CorridorTailHits(0);
+}
+
+PathCorridorCache::Key PathCorridorCache::MakeKey(dtPolyRef endPoly, dtQueryFilter const& filter)
+{
+    Key key;
+    key.endPoly = endPoly;
+    key.filter = (uint32(filter.getIncludeFlags()) << 16) | filter.getExcludeFlags();
+    return key;
+}
+
+uint32 PathCorridorCache::Find(dtNavMesh const* navMesh, dtPolyRef startPoly, dtPolyRef endPoly, dtQueryFilter const& filter, dtPolyRef* path, uint32 maxPath)
+{
+    CorridorLookups.fetch_add(1, std::memory_order_relaxed);
+
+    uint32 const now = getMSTime();
+
+    std::lock_guard<std::mutex> guard(_lock);
+
+    auto itr = _corridors.find(MakeKey(endPoly, filter));
+    if (itr == _corridors.end())
+        return 0;
+
+    // newest first, they are the most likely to still match the target
+    for (auto corridor = itr->second.rbegin(); corridor != itr->second.rend(); ++corridor)
+    {
+        if (getMSTimeDiff(corridor->time, now) > CorridorLifetime)
+            break;
+
+        auto start = std::find(corridor->polys.begin(), corridor->polys.end(), startPoly);
+        if (start == corridor->polys.end())
+            continue;
+
+        uint32 const length = uint32(corridor->polys.end() - start);
+        if (length > maxPath)
+            continue;
+
+        // tiles may have been unloaded since, salts of their polys changed
+        if (!std::all_of(start, corridor->polys.end(), [navMesh](dtPolyRef ref) { return navMesh->isValidPolyRef(ref); }))
+            continue;
+
+        std::copy(start, corridor->polys.end(), path);
+        if (start == corridor->polys.begin())
+            CorridorHits.fetch_add(1, std::memory_order_relaxed);
+        else
+            CorridorTailHits.fetch_add(1, std::memory_order_relaxed);
+        return length;
+    }
+
+    return 0;
+}
+
+void PathCorridorCache::Store(dtPolyRef const* path, uint32 pathSize, dtQueryFilter const& filter)
+{
+    if (!pathSize)
+        return;
+
+    uint32 const now = getMSTime();
+
+    std::lock_guard<std::mutex> guard(_lock);
+
+    if (_corridors.size() >= MaxEnds)
+        PruneExpired(now);
+
+    std::deque<Corridor>& corridors = _corridors[MakeKey(path[pathSize - 1], filter)];
+    if (corridors.size() >= MaxCorridorsPerEnd)
+        corridors.pop_front();
+
+    corridors.push_back(Corridor());
+    corridors.back().time = now;
+    corridors.back().polys.assign(path, path + pathSize);
+}
+
+void PathCorridorCache::PruneExpired(uint32 now)
+{
+    for (auto itr = _corridors.begin(); itr != _corridors.end();)
+    {
+        // the newest corridor of an end is the last one
+        if (getMSTimeDiff(itr->second.back().time, now) > CorridorLifetime)
+            itr = _corridors.erase(itr);
+        else
+            ++itr;
+    }
+
+    // all still fresh, start over rather than grow without bounds
+    if (_corridors.size() >= MaxEnds)
+        _corridors.clear();
+}
+
+PathCorridorCache::Stats PathCorridorCache::GetStats()
+{
+    Stats stats;
+    stats.lookups = CorridorLookups.load(std::memory_order_relaxed);
+    stats.hits = CorridorHits.load(std::memory_order_relaxed);
+    stats.tailHits = CorridorTailHits.load(std::memory_order_relaxed);
+    return stats;
+}
@@ -0,0 +1,83 @@
+/*
+ * Copyright (C) 2008-2017 TrinityCore <http://www.trinitycore.org/>
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; either version 2 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _PATH_CORRIDOR_CACHE_H
+#define _PATH_CORRIDOR_CACHE_H
+
+#include "Define.h"
+#include "DetourNavMesh.h"
+#include "DetourNavMeshQuery.h"
+#include <deque>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+// Poly corridors recently built on the navmesh of one map, shared by the
+// path generators of every unit on it. Units chasing the same target end on
+// the same poly, so a corridor found for one of them is reused from
+// whichever of its polys the next one starts on.
+class PathCorridorCache
+{
+    public:
+        struct Stats
+        {
+            uint64 lookups;
+            uint64 hits;        // corridor started on the requested poly
+            uint64 tailHits;    // requested poly was further along a corridor
+        };
+
+        // copies the corridor from startPoly to endPoly into path, returns
+        // its length, 0 if there is no usable corridor
+        uint32 Find(dtNavMesh const* navMesh, dtPolyRef startPoly, dtPolyRef endPoly, dtQueryFilter const& filter, dtPolyRef* path, uint32 maxPath);
+        // path must end on the poly that was searched for
+        void Store(dtPolyRef const* path, uint32 pathSize, dtQueryFilter const& filter);
+
+        static Stats GetStats();
+
+    private:
+        // targets move, corridors are only kept for packs pulled together
+        static uint32 const CorridorLifetime = 1000;
+        static uint32 const MaxCorridorsPerEnd = 4;
+        static size_t const MaxEnds = 1024;
+
+        struct Key
+        {
+            dtPolyRef endPoly;
+            uint32 filter;
+
+            bool operator==(Key const& other) const { return endPoly == other.endPoly && filter == other.filter; }
+        };
+
+        struct KeyHash
+        {
+            size_t operator()(Key const& key) const { return std::hash<uint64>()(uint64(key.endPoly) ^ (uint64(key.filter) << 48)); }
+        };
+
+        struct Corridor
+        {
+            uint32 time;
+            std::vector<dtPolyRef> polys;
+        };
+
+        static Key MakeKey(dtPolyRef endPoly, dtQueryFilter const& filter);
+        void PruneExpired(uint32 now);
+
+        std::unordered_map<Key, std::deque<Corridor>, KeyHash> _corridors;
+        std::mutex _lock;
+};
+
+#endif
@@ -60,7 +60,7 @@ void PathGenerator::InitPath()
 
         auto mmap = MMAP::MMapFactory::createOrGetMMapManager();
         if (_transport)
-            _navMeshQuery = mmap->GetModelNavMeshQuery(_transport->GetDisplayId(), _sourceUnit->GetInstanceId());
+            _navMeshQuery = mmap->GetModelNavMeshQuery(_transport->GetDisplayId());
         else
         {
             DynamicTreeCallback dCallback;
@@ -69,14 +69,14 @@ void PathGenerator::InitPath()
                 _go = dCallback.go;
 
             if (_go)
-                _navMeshQuery = mmap->GetModelNavMeshQuery(_go->GetDisplayId(), _sourceUnit->GetInstanceId());
+                _navMeshQuery = mmap->GetModelNavMeshQuery(_go->GetDisplayId());
         }
 
         if (!_navMeshQuery) // If transport or go don`t have mesh disable it
         {
             _go = nullptr;
             _transport = nullptr;
-            _navMeshQuery = mmap->GetNavMeshQuery(mapId, _sourceUnit->GetInstanceId());
+            _navMeshQuery = mmap->GetNavMeshQuery(mapId);
         }
 
         if (_navMeshQuery)
@@ -122,6 +122,24 @@ bool PathGenerator::CalculatePath(float destX, float destY, float destZ, bool fo
     _forceDestination = forceDest;
     _straightLine = straightLine;
 
+    // tiles of grids loaded since the last tick are still queued, load them
+    // now rather than walk straight through them
+    ting::shared_lock<ting::shared_mutex> meshGuard;
+    if (_navMesh && !_transport && !_go)
+    {
+        if (ting::shared_mutex* meshLock = MMAP::MMapFactory::createOrGetMMapManager()->GetNavMeshLock(_sourceUnit->GetMapId()))
+        {
+            meshGuard = ting::shared_lock<ting::shared_mutex>(*meshLock);
+            if (!HaveTile(start) || !HaveTile(dest))
+            {
+                meshGuard.unlock();
+                LoadPendingTile(start);
+                LoadPendingTile(dest);
+                meshGuard.lock();
+            }
+        }
+    }
+
     if (_sourceUnit->IsPlayer() || _sourceUnit->IsPet())
         TC_LOG_DEBUG("maps", "++ PathGenerator::CalculatePath() for %u _navMesh %u _navMeshQuery %u start %u dest %u",
             _sourceUnit->GetGUIDLow(), bool(_navMesh), bool(_navMeshQuery), HaveTile(start), HaveTile(dest));
@@ -484,7 +502,7 @@ void PathGenerator::BuildPolyPath(G3D::Vector3 const& startPos, G3D::Vector3 con
             }
         }
         else
-            dtResult = _navMeshQuery->findPath( suffixStartPoly, endPoly, suffixEndPoint, endPoint, &_filter, _pathPolyRefs + prefixPolyLength - 1, reinterpret_cast<int*>(&suffixPolyLength), MAX_PATH_LENGTH - prefixPolyLength);
+            dtResult = FindPolyPath(suffixStartPoly, endPoly, suffixEndPoint, endPoint, _pathPolyRefs + prefixPolyLength - 1, &suffixPolyLength, MAX_PATH_LENGTH - prefixPolyLength);
 
         if (!suffixPolyLength || dtStatusFailed(dtResult))
         {
@@ -530,7 +548,7 @@ void PathGenerator::BuildPolyPath(G3D::Vector3 const& startPos, G3D::Vector3 con
             }
         }
         else
-            dtResult = _navMeshQuery->findPath( startPoly, endPoly, startPoint, endPoint, &_filter, _pathPolyRefs, reinterpret_cast<int*>(&_polyLength), MAX_PATH_LENGTH);
+            dtResult = FindPolyPath(startPoly, endPoly, startPoint, endPoint, _pathPolyRefs, &_polyLength, MAX_PATH_LENGTH);
 
         if (!_polyLength || dtStatusFailed(dtResult))
         {
@@ -552,6 +570,30 @@ void PathGenerator::BuildPolyPath(G3D::Vector3 const& startPos, G3D::Vector3 con
     BuildPointPath(startPoint, endPoint);
 }
 
+dtStatus PathGenerator::FindPolyPath(dtPolyRef startPoly, dtPolyRef endPoly, float const* startPoint, float const* endPoint, dtPolyRef* path, uint32* pathSize, uint32 maxPath)
+{
+    // corridors of transport and gameobject meshes are not shared
+    PathCorridorCache* cache = NULL;
+    if (!_transport && !_go)
+        if (Map* map = _sourceUnit->FindMap())
+            cache = &map->GetPathCorridorCache();
+
+    if (cache)
+    {
+        *pathSize = cache->Find(_navMesh, startPoly, endPoly, _filter, path, maxPath);
+        if (*pathSize)
+            return DT_SUCCESS;
+    }
+
+    dtStatus dtResult = _navMeshQuery->findPath(startPoly, endPoly, startPoint, endPoint, &_filter, path, reinterpret_cast<int*>(pathSize), maxPath);
+
+    // only complete corridors, a partial one would cut the path of whoever reuses it
+    if (cache && dtStatusSucceed(dtResult) && !dtStatusDetail(dtResult, DT_PARTIAL_RESULT) && *pathSize && path[*pathSize - 1] == endPoly)
+        cache->Store(path, *pathSize, _filter);
+
+    return dtResult;
+}
+
 void PathGenerator::BuildPointPath(const float *startPoint, const float *endPoint)
 {
     float pathPoints[MAX_POINT_PATH_LENGTH*VERTEX_SIZE];
@@ -881,6 +923,12 @@ bool PathGenerator::HaveTile(const G3D::Vector3& p) const
     return (_navMesh->getTileAt(tx, ty, 0) != NULL);
 }
 
+void PathGenerator::LoadPendingTile(G3D::Vector3 const& p) const
+{
+    GridCoord grid = Trinity::ComputeGridCoord(p.x, p.y);
+    MMAP::MMapFactory::createOrGetMMapManager()->loadPendingTile(_sourceUnit->GetMapId(), (MAX_NUMBER_OF_GRIDS - 1) - grid.x_coord, (MAX_NUMBER_OF_GRIDS - 1) - grid.y_coord);
+}
+
 uint32 PathGenerator::FixupCorridor(dtPolyRef* path, uint32 npath, uint32 maxPath, dtPolyRef const* visited, uint32 nvisited)
 {
     int32 furthestPath = -1;
@@ -174,6 +174,16 @@ ZoneScript* OutdoorPvPMgr::GetZoneScript(uint32 zoneId)
         return NULL;
 }
 
+bool OutdoorPvPMgr::HasZoneOnMap(uint32 mapId) const
+{
+    for (OutdoorPvPMap::const_iterator itr = m_OutdoorPvPMap.begin(); itr != m_OutdoorPvPMap.end(); ++itr)
+        if (AreaTableEntry const* zone = sAreaTableStore.LookupEntry(itr->first))
+            if (zone->mapid == mapId)
+                return true;
+
+    return false;
+}
+
 bool OutdoorPvPMgr::HandleOpenGo(Player* player, uint64 guid)
 {
     for (OutdoorPvPSet::iterator itr = m_OutdoorPvPSet.begin(); itr != m_OutdoorPvPSet.end(); ++itr)
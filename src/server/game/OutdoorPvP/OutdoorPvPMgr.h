@@ -71,6 +71,9 @@ class OutdoorPvPMgr
 
         ZoneScript* GetZoneScript(uint32 zoneId);
 
+        // true if an outdoor pvp script handles a zone of the map
+        bool HasZoneOnMap(uint32 mapId) const;
+
         void AddZone(uint32 zoneid, OutdoorPvP* handle);
 
         void Update(uint32 diff);
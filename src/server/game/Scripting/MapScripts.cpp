@@ -54,14 +54,18 @@ void Map::ScriptsStart(ScriptMapMap const& scripts, uint32 id, Object* source, O
         sa.ownerGUID  = ownerGUID;
 
         sa.script = &iter->second;
-        m_scriptSchedule.insert(ScriptScheduleMap::value_type(time_t(sWorld->GetGameTime() + iter->first), sa));
+        {
+            RegionGuardType guard(i_regionLock);
+            m_scriptSchedule.insert(ScriptScheduleMap::value_type(time_t(sWorld->GetGameTime() + iter->first), sa));
+        }
         if (iter->first == 0)
             immedScript = true;
 
         sScriptMgr->IncreaseScheduledScriptsCount();
     }
     ///- If one of the effects should be immediate, launch the script execution
-    if (/*start &&*/ immedScript && !i_scriptLock)
+    ///- (regions of a partitioned map leave it to the end of the update)
+    if (/*start &&*/ immedScript && !i_scriptLock && !i_regionUpdateActive)
     {
         i_scriptLock = true;
         ScriptsProcess();
@@ -84,12 +88,15 @@ void Map::ScriptCommandStart(ScriptInfo const& script, uint32 delay, Object* sou
     sa.ownerGUID  = ownerGUID;
 
     sa.script = &script;
-    m_scriptSchedule.insert(ScriptScheduleMap::value_type(time_t(sWorld->GetGameTime() + delay), sa));
+    {
+        RegionGuardType guard(i_regionLock);
+        m_scriptSchedule.insert(ScriptScheduleMap::value_type(time_t(sWorld->GetGameTime() + delay), sa));
+    }
 
     sScriptMgr->IncreaseScheduledScriptsCount();
 
     ///- If effects should be immediate, launch the script execution
-    if (delay == 0 && !i_scriptLock)
+    if (delay == 0 && !i_scriptLock && !i_regionUpdateActive)
     {
         i_scriptLock = true;
         ScriptsProcess();
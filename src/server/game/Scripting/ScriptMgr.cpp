@@ -32,10 +32,69 @@
 #include "CreatureAIImpl.h"
 #include "SpellAuraEffects.h"
 
+#include <bitset>
+#include <unordered_map>
+
 namespace
 {
     typedef std::set<ScriptObject*> ExampleScriptContainer;
     ExampleScriptContainer ExampleScripts;
+
+    // Packet hooks by opcode, one registry per direction. Filled while the scripts are loaded and read only
+    // afterwards, so the network threads can test it without locking.
+    class PacketHookRegistry
+    {
+        public:
+
+            void Register(ServerScript* script, uint32 opcode)
+            {
+                ASSERT(opcode <= NUM_OPCODE_HANDLERS);
+
+                if (opcode == NUM_OPCODE_HANDLERS)
+                {
+                    _anyOpcode.push_back(script);
+                    return;
+                }
+
+                _opcodes.set(opcode);
+                _scripts[opcode].push_back(script);
+            }
+
+            bool HasHooks(uint32 opcode) const
+            {
+                return !_anyOpcode.empty() || (opcode < NUM_OPCODE_HANDLERS && _opcodes.test(opcode));
+            }
+
+            template<class Hook>
+            void Call(uint32 opcode, Hook const& hook) const
+            {
+                for (std::vector<ServerScript*>::const_iterator itr = _anyOpcode.begin(); itr != _anyOpcode.end(); ++itr)
+                    hook(*itr);
+
+                if (opcode >= NUM_OPCODE_HANDLERS || !_opcodes.test(opcode))
+                    return;
+
+                std::vector<ServerScript*> const& scripts = _scripts.find(opcode)->second;
+                for (std::vector<ServerScript*>::const_iterator itr = scripts.begin(); itr != scripts.end(); ++itr)
+                    hook(*itr);
+            }
+
+            void Clear()
+            {
+                _opcodes.reset();
+                _scripts.clear();
+                _anyOpcode.clear();
+            }
+
+        private:
+
+            std::bitset<NUM_OPCODE_HANDLERS> _opcodes;
+            std::unordered_map<uint32, std::vector<ServerScript*> > _scripts;
+            std::vector<ServerScript*> _anyOpcode;
+    };
+
+    PacketHookRegistry PacketSendHooks;
+    PacketHookRegistry PacketReceiveHooks;
 }
 
 // This is the global static registry of scripts.
@@ -316,6 +375,9 @@ void ScriptMgr::Unload()
 
     #undef SCR_CLEAR
 
+    PacketSendHooks.Clear();
+    PacketReceiveHooks.Clear();
+
     for (ExampleScriptContainer::iterator itr = ExampleScripts.begin(); itr != ExampleScripts.end(); ++itr)
         delete *itr;
     ExampleScripts.clear();
@@ -501,21 +563,29 @@ void ScriptMgr::OnSocketClose(WorldSocket* socket, bool wasNew)
     FOREACH_SCRIPT(ServerScript)->OnSocketClose(socket, wasNew);
 }
 
-void ScriptMgr::OnPacketReceive(WorldSocket* socket, WorldPacket packet)
+void ScriptMgr::OnPacketReceive(WorldSocket* socket, WorldPacket const& packet)
 {
     ASSERT(socket);
 
-    FOREACH_SCRIPT(ServerScript)->OnPacketReceive(socket, packet);
+    uint32 const opcode = packet.GetOpcode();
+    if (!PacketReceiveHooks.HasHooks(opcode))
+        return;
+
+    PacketReceiveHooks.Call(opcode, [socket, &packet](ServerScript* script) { script->OnPacketReceive(socket, packet); });
 }
 
-void ScriptMgr::OnPacketSend(WorldSocket* socket, WorldPacket packet)
+void ScriptMgr::OnPacketSend(WorldSocket* socket, WorldPacket const& packet)
 {
     ASSERT(socket);
 
-    FOREACH_SCRIPT(ServerScript)->OnPacketSend(socket, packet);
+    uint32 const opcode = packet.GetOpcode();
+    if (!PacketSendHooks.HasHooks(opcode))
+        return;
+
+    PacketSendHooks.Call(opcode, [socket, &packet](ServerScript* script) { script->OnPacketSend(socket, packet); });
 }
 
-void ScriptMgr::OnUnknownPacketReceive(WorldSocket* socket, WorldPacket packet)
+void ScriptMgr::OnUnknownPacketReceive(WorldSocket* socket, WorldPacket& packet)
 {
     ASSERT(socket);
 
@@ -1503,6 +1573,16 @@ ServerScript::ServerScript(const char* name)
     ScriptRegistry<ServerScript>::AddScript(this);
 }
 
+void ServerScript::RegisterPacketSendHook(uint32 opcode)
+{
+    PacketSendHooks.Register(this, opcode);
+}
+
+void ServerScript::RegisterPacketReceiveHook(uint32 opcode)
+{
+    PacketReceiveHooks.Register(this, opcode);
+}
+
 WorldScript::WorldScript(const char* name)
     : ScriptObject(name)
 {
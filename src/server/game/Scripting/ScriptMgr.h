@@ -213,6 +213,13 @@ class ServerScript : public ScriptObject
 
         ServerScript(const char* name);
 
+        // OnPacketSend and OnPacketReceive are only called for the opcodes a script registered, usually from its
+        // constructor. ALL_OPCODES hooks every packet, which includes every movement packet of every client.
+        enum { ALL_OPCODES = NUM_OPCODE_HANDLERS };
+
+        void RegisterPacketSendHook(uint32 opcode);
+        void RegisterPacketReceiveHook(uint32 opcode);
+
     public:
 
         // Called when reactive socket I/O is started (WorldSocketMgr).
@@ -228,13 +235,13 @@ class ServerScript : public ScriptObject
         // being open; it is not.
         virtual void OnSocketClose(WorldSocket* /*socket*/, bool /*wasNew*/) { }
 
-        // Called when a packet is sent to a client. The packet object is a copy of the original packet, so reading
-        // and modifying it is safe.
-        virtual void OnPacketSend(WorldSocket* /*socket*/, WorldPacket& /*packet*/) { }
+        // Called when a registered packet is sent to a client. The packet is the original one and must not be
+        // modified; use ByteBuffer::read(pos) to inspect it, or copy it if it has to be parsed with operator>>.
+        virtual void OnPacketSend(WorldSocket* /*socket*/, WorldPacket const& /*packet*/) { }
 
-        // Called when a (valid) packet is received by a client. The packet object is a copy of the original packet, so
-        // reading and modifying it is safe.
-        virtual void OnPacketReceive(WorldSocket* /*socket*/, WorldPacket& /*packet*/) { }
+        // Called when a registered (valid) packet is received by a client, before it is handled. Same rules as
+        // OnPacketSend apply.
+        virtual void OnPacketReceive(WorldSocket* /*socket*/, WorldPacket const& /*packet*/) { }
 
         // Called when an invalid (unknown opcode) packet is received by a client. The packet is a reference to the orignal
         // packet; not a copy. This allows you to actually handle unknown packets (for whatever purpose).
@@ -897,9 +904,9 @@ class ScriptMgr
         void OnNetworkStop();
         void OnSocketOpen(WorldSocket* socket);
         void OnSocketClose(WorldSocket* socket, bool wasNew);
-        void OnPacketReceive(WorldSocket* socket, WorldPacket packet);
-        void OnPacketSend(WorldSocket* socket, WorldPacket packet);
-        void OnUnknownPacketReceive(WorldSocket* socket, WorldPacket packet);
+        void OnPacketReceive(WorldSocket* socket, WorldPacket const& packet);
+        void OnPacketSend(WorldSocket* socket, WorldPacket const& packet);
+        void OnUnknownPacketReceive(WorldSocket* socket, WorldPacket& packet);
 
     public: /* WorldScript */
 
@@ -0,0 +1,223 @@
+/*
+ * Copyright (C) 2008-2012 TrinityCore <http://www.trinitycore.org/>
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; either version 2 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "SendQueue.h"
+#include "Errors.h"
+
+#include <algorithm>
+#include <cstring>
+
+SendSlabPool::SendSlabPool() : _free(NULL), _allocated(0), _pooled(0)
+{
+}
+
+SendSlabPool::~SendSlabPool()
+{
+    while (SendSlab* slab = _free)
+    {
+        _free = slab->Next;
+        delete slab;
+    }
+}
+
+SendSlab* SendSlabPool::Acquire()
+{
+    SendSlab* slab = NULL;
+
+    {
+        GuardType guard(_lock);
+        if (_free)
+        {
+            slab = _free;
+            _free = slab->Next;
+        }
+    }
+
+    if (slab)
+        _pooled.fetch_sub(1, std::memory_order_relaxed);
+    else
+    {
+        slab = new SendSlab();
+        _allocated.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    slab->Next = NULL;
+    slab->ReadPos = 0;
+    slab->WritePos = 0;
+    return slab;
+}
+
+void SendSlabPool::Release(SendSlab* slab)
+{
+    {
+        GuardType guard(_lock);
+        slab->Next = _free;
+        _free = slab;
+    }
+
+    _pooled.fetch_add(1, std::memory_order_relaxed);
+}
+
+SendQueue::SendQueue(std::size_t reserved) : _head(NULL), _tail(NULL), _spare(NULL), _spareCount(0),
+    _maxSpare(std::max<std::size_t>(1, reserved / SendSlab::Size)), _length(0), _peakLength(0)
+{
+}
+
+SendQueue::~SendQueue()
+{
+    while (SendSlab* slab = _head)
+    {
+        _head = slab->Next;
+        sSendSlabPool->Release(slab);
+    }
+
+    while (SendSlab* slab = _spare)
+    {
+        _spare = slab->Next;
+        sSendSlabPool->Release(slab);
+    }
+}
+
+void SendQueue::Append()
+{
+    SendSlab* slab;
+    if (_spare)
+    {
+        slab = _spare;
+        _spare = slab->Next;
+        --_spareCount;
+
+        slab->Next = NULL;
+        slab->ReadPos = 0;
+        slab->WritePos = 0;
+    }
+    else
+        slab = sSendSlabPool->Acquire();
+
+    if (_tail)
+        _tail->Next = slab;
+    else
+        _head = slab;
+
+    _tail = slab;
+}
+
+void SendQueue::Recycle(SendSlab* slab)
+{
+    if (_spareCount < _maxSpare)
+    {
+        slab->Next = _spare;
+        _spare = slab;
+        ++_spareCount;
+    }
+    else
+        sSendSlabPool->Release(slab);
+}
+
+uint8* SendQueue::Reserve(std::size_t size)
+{
+    ASSERT(size <= SendSlab::Size);
+
+    if (!_tail || _tail->GetSpace() < size)
+        Append();
+
+    uint8* data = &_tail->Data[_tail->WritePos];
+    _tail->WritePos += size;
+
+    _length += size;
+    _peakLength = std::max(_peakLength, _length);
+    return data;
+}
+
+void SendQueue::Write(void const* data, std::size_t size)
+{
+    uint8 const* source = static_cast<uint8 const*>(data);
+
+    _length += size;
+    _peakLength = std::max(_peakLength, _length);
+
+    while (size)
+    {
+        if (!_tail || !_tail->GetSpace())
+            Append();
+
+        std::size_t const chunk = std::min(size, _tail->GetSpace());
+        memcpy(&_tail->Data[_tail->WritePos], source, chunk);
+        _tail->WritePos += chunk;
+
+        source += chunk;
+        size -= chunk;
+    }
+}
+
+uint8* SendQueue::GetWriteSpace(std::size_t& size)
+{
+    if (!_tail || !_tail->GetSpace())
+        Append();
+
+    size = _tail->GetSpace();
+    return &_tail->Data[_tail->WritePos];
+}
+
+void SendQueue::Commit(std::size_t size)
+{
+    ASSERT(_tail && size <= _tail->GetSpace());
+    _tail->WritePos += size;
+
+    _length += size;
+    _peakLength = std::max(_peakLength, _length);
+}
+
+int SendQueue::Fill(iovec* iov, int count) const
+{
+    int used = 0;
+    for (SendSlab* slab = _head; slab && used < count; slab = slab->Next)
+    {
+        if (!slab->GetLength())
+            continue;
+
+        iov[used].iov_base = reinterpret_cast<char*>(&slab->Data[slab->ReadPos]);
+        iov[used].iov_len = slab->GetLength();
+        ++used;
+    }
+
+    return used;
+}
+
+void SendQueue::Consume(std::size_t bytes)
+{
+    ASSERT(bytes <= _length);
+    _length -= bytes;
+
+    while (_head)
+    {
+        std::size_t const chunk = std::min(bytes, _head->GetLength());
+        _head->ReadPos += chunk;
+        bytes -= chunk;
+
+        // keep the tail, it still has room for the next packets
+        if (_head->GetLength() || _head == _tail)
+            break;
+
+        SendSlab* slab = _head;
+        _head = slab->Next;
+        Recycle(slab);
+    }
+
+    if (_head && _head == _tail && !_head->GetLength())
+        _head->ReadPos = _head->WritePos = 0;
+}
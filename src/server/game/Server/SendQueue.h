@@ -0,0 +1,126 @@
+/*
+ * Copyright (C) 2008-2012 TrinityCore <http://www.trinitycore.org/>
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; either version 2 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TRINITYCORE_SEND_QUEUE_H
+#define TRINITYCORE_SEND_QUEUE_H
+
+#include "Define.h"
+#include "SpinLock.hpp"
+
+#include <ace/os_include/sys/os_uio.h>
+
+#include <atomic>
+#include <cstddef>
+#include <mutex>
+
+/// Fixed size chunk of socket output
+struct SendSlab
+{
+    static std::size_t const Size = 16 * 1024;
+
+    SendSlab* Next;
+    std::size_t ReadPos;
+    std::size_t WritePos;
+    uint8 Data[Size];
+
+    std::size_t GetLength() const { return WritePos - ReadPos; }
+    std::size_t GetSpace() const { return Size - WritePos; }
+};
+
+/// Process wide free list of send slabs, sockets only go through it when
+/// their output exceeds the slabs they keep for themselves
+class SendSlabPool
+{
+    private:
+        SendSlabPool();
+        ~SendSlabPool();
+
+    public:
+        static SendSlabPool* instance()
+        {
+            static SendSlabPool instance;
+            return &instance;
+        }
+
+        SendSlab* Acquire();
+        void Release(SendSlab* slab);
+
+        /// Slabs allocated since startup, in use or pooled
+        uint32 GetAllocatedCount() const { return _allocated.load(std::memory_order_relaxed); }
+        uint32 GetPooledCount() const { return _pooled.load(std::memory_order_relaxed); }
+
+    private:
+        typedef Trinity::SpinLock LockType;
+        typedef std::lock_guard<LockType> GuardType;
+
+        LockType _lock;
+        SendSlab* _free;
+        std::atomic<uint32> _allocated;
+        std::atomic<uint32> _pooled;
+};
+
+#define sSendSlabPool SendSlabPool::instance()
+
+/// Output of a socket: a chain of slabs written in place by the senders and
+/// flushed with gathered writes. Not thread safe, the socket serializes the
+/// access with its output lock.
+class SendQueue
+{
+    public:
+        /// @param reserved bytes of drained slabs kept by the queue instead of
+        /// going back to the pool
+        explicit SendQueue(std::size_t reserved);
+        ~SendQueue();
+
+        /// Contiguous space for size bytes (at most SendSlab::Size), counted
+        /// as written; used for headers filled once the payload is known
+        uint8* Reserve(std::size_t size);
+
+        void Write(void const* data, std::size_t size);
+
+        /// Free space at the end of the output to write in place, appends a
+        /// slab when the last one is full; Commit counts the bytes used there
+        uint8* GetWriteSpace(std::size_t& size);
+        void Commit(std::size_t size);
+
+        bool Empty() const { return _length == 0; }
+        std::size_t GetLength() const { return _length; }
+        std::size_t GetPeakLength() const { return _peakLength; }
+
+        /// Describes up to count slabs of pending output, returns the number used
+        int Fill(iovec* iov, int count) const;
+
+        /// Drops bytes of output sent by the last gathered write
+        void Consume(std::size_t bytes);
+
+    private:
+        SendQueue(SendQueue const&);
+        SendQueue& operator=(SendQueue const&);
+
+        void Append();
+        void Recycle(SendSlab* slab);
+
+        SendSlab* _head;
+        SendSlab* _tail;
+        SendSlab* _spare;
+        std::size_t _spareCount;
+        std::size_t _maxSpare;
+        std::size_t _length;
+        std::size_t _peakLength;
+};
+
+#endif
@@ -0,0 +1,123 @@
+/*
+ * Copyright (C) 2008-2012 TrinityCore <http://www.trinitycore.org/>
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; either version 2 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "SerializedPacket.h"
+#include "Log.h"
+#include "World.h"
+#include "zlib.h"
+
+#include <cstring>
+
+namespace {
+
+// Deflate stream of the broadcasting thread, reset for every packet so the
+// output never refers to data the receiving client has not seen
+class BroadcastCompressionStream
+{
+    public:
+        BroadcastCompressionStream() : _initialized(false)
+        {
+            memset(&_stream, 0, sizeof(_stream));
+        }
+
+        ~BroadcastCompressionStream()
+        {
+            if (_initialized)
+                deflateEnd(&_stream);
+        }
+
+        z_stream* Get()
+        {
+            if (!_initialized)
+            {
+                int32 z_res = deflateInit2(&_stream, sWorld->getIntConfig(CONFIG_COMPRESSION), Z_DEFLATED, -15, 8, Z_DEFAULT_STRATEGY);
+                if (z_res != Z_OK)
+                {
+                    TC_LOG_ERROR("network", "Can't initialize broadcast packet compression (zlib: deflateInit) Error code: %i (%s)", z_res, zError(z_res));
+                    return NULL;
+                }
+
+                _initialized = true;
+            }
+            else
+                deflateReset(&_stream);
+
+            return &_stream;
+        }
+
+    private:
+        z_stream _stream;
+        bool _initialized;
+};
+
+} // namespace
+
+SerializedPacket::SerializedPacket(WorldPacket const& packet) : _packet(packet), _compressionDone(false)
+{
+    const_cast<WorldPacket&>(_packet).FlushBits();
+}
+
+std::vector<uint8> const& SerializedPacket::GetCompressedPayload() const
+{
+    if (_compressionDone)
+        return _compressed;
+
+    _compressionDone = true;
+
+    static thread_local BroadcastCompressionStream compressionStream;
+    z_stream* stream = compressionStream.Get();
+    if (!stream)
+        return _compressed;
+
+    uint32 opcode = _packet.GetOpcode();
+    uint32 packetSize = _packet.size();
+    uint32 bufferSize = deflateBound(stream, packetSize + sizeof(opcode));
+
+    _compressed.resize(sizeof(CompressedWorldPacket) + bufferSize);
+    uint8* compressedData = &_compressed[sizeof(CompressedWorldPacket)];
+
+    stream->next_out = compressedData;
+    stream->avail_out = bufferSize;
+    stream->next_in = (Bytef*)&opcode;
+    stream->avail_in = sizeof(uint32);
+
+    int32 z_res = deflate(stream, Z_BLOCK);
+    if (z_res == Z_OK)
+    {
+        stream->next_in = (Bytef*)_packet.contents();
+        stream->avail_in = packetSize;
+        z_res = deflate(stream, Z_SYNC_FLUSH);
+    }
+
+    if (z_res != Z_OK)
+    {
+        TC_LOG_ERROR("network", "Can't compress broadcast packet (zlib: deflate) Error code: %i (%s, msg: %s)", z_res, zError(z_res), stream->msg);
+        _compressed.clear();
+        return _compressed;
+    }
+
+    uint32 compressedSize = bufferSize - stream->avail_out;
+
+    CompressedWorldPacket cmp;
+    cmp.UncompressedSize = packetSize + 4;
+    cmp.UncompressedAdler = adler32(adler32(0x9827D8F1, (Bytef*)&opcode, 4), _packet.contents(), packetSize);
+    cmp.CompressedAdler = adler32(0x9827D8F1, compressedData, compressedSize);
+    memcpy(&_compressed[0], &cmp, sizeof(CompressedWorldPacket));
+
+    _compressed.resize(sizeof(CompressedWorldPacket) + compressedSize);
+    return _compressed;
+}
@@ -0,0 +1,74 @@
+/*
+ * Copyright (C) 2008-2012 TrinityCore <http://www.trinitycore.org/>
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; either version 2 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TRINITYCORE_SERIALIZED_PACKET_H
+#define TRINITYCORE_SERIALIZED_PACKET_H
+
+#include "WorldPacket.h"
+
+#include <vector>
+
+#if defined(__GNUC__)
+#pragma pack(1)
+#else
+#pragma pack(push, 1)
+#endif
+
+struct CompressedWorldPacket
+{
+    uint32 UncompressedSize;
+    uint32 UncompressedAdler;
+    uint32 CompressedAdler;
+};
+
+#if defined(__GNUC__)
+#pragma pack()
+#else
+#pragma pack(pop)
+#endif
+
+/// Server packets bigger than this are sent compressed
+uint32 const PACKET_COMPRESSION_THRESHOLD = 0x400;
+
+/// A server packet broadcast to many sessions. Packets big enough to be sent
+/// compressed are compressed once, on first send, with a stream of their own,
+/// each socket then only writes its encrypted header in front of the shared
+/// payload. Only valid while the wrapped packet lives, it is meant to be built
+/// on the stack of the broadcasting function.
+class SerializedPacket
+{
+    public:
+        explicit SerializedPacket(WorldPacket const& packet);
+
+        WorldPacket const& GetPacket() const { return _packet; }
+
+        bool IsCompressed() const { return _packet.size() > PACKET_COMPRESSION_THRESHOLD; }
+
+        /// CompressedWorldPacket header followed by the deflated opcode and
+        /// contents, empty if compression failed
+        std::vector<uint8> const& GetCompressedPayload() const;
+
+    private:
+        SerializedPacket(SerializedPacket const&);
+        SerializedPacket& operator=(SerializedPacket const&);
+
+        WorldPacket const& _packet;
+        mutable std::vector<uint8> _compressed;
+        mutable bool _compressionDone;
+};
+
+#endif
@@ -27,6 +27,7 @@
 #include "Log.h"
 #include "Opcodes.h"
 #include "WorldPacket.h"
+#include "SerializedPacket.h"
 #include "WorldSession.h"
 #include "Player.h"
 #include "Vehicle.h"
@@ -99,7 +100,8 @@ m_playerRecentlyLogout(false), m_playerSave(false),
 m_sessionDbcLocale(sWorld->GetAvailableDbcLocale(locale)),
 m_sessionDbLocaleIndex(locale), _clientOS("Unk"),
 m_latency(0), m_TutorialsChanged(false), recruiterId(recruiter),
-isRecruiter(isARecruiter), _account_name(account_name), timeCharEnumOpcode(0), playerLoginCounter(0), wardenModuleFailed(false)
+isRecruiter(isARecruiter), _account_name(account_name), timeCharEnumOpcode(0), playerLoginCounter(0), wardenModuleFailed(false),
+_queryCallbackUpdate(QUERY_CALLBACK_WORLD_UPDATE)
 {
     _warden = NULL;
     _filterAddonMessages = false;
@@ -154,9 +156,12 @@ WorldSession::~WorldSession()
 
     ///- empty incoming packet queue
     WorldPacket* packet = NULL;
-    while (_recvQueue.next(packet))
+    while (_recvQueue.Dequeue(packet))
         delete packet;
 
+    for (std::vector<WorldPacket*>::const_iterator itr = _deferredPackets.begin(); itr != _deferredPackets.end(); ++itr)
+        delete *itr;
+
     LoginDatabase.PExecute("UPDATE account SET online = 0 WHERE id = %u;", GetAccountId());     // One-time query
 
     int32 z_res = deflateEnd(_compressionStream);
@@ -197,21 +202,18 @@ uint32 WorldSession::GetGuidLow() const
     return GetPlayer() ? GetPlayer()->GetGUIDLow() : 0;
 }
 
-/// Send a packet to the client
-void WorldSession::SendPacket(WorldPacket const* packet, bool forced /*= false*/)
+/// Check the opcode of a packet about to be sent
+bool WorldSession::CanSendPacket(WorldPacket const* packet, bool forced) const
 {
-    if (!m_Socket)
-        return;
-
     if (packet->GetOpcode() == NULL_OPCODE)
     {
         TC_LOG_ERROR("opcode", "Prevented sending of NULL_OPCODE to %s", GetPlayerName(false).c_str());
-        return;
+        return false;
     }
     else if (packet->GetOpcode() == UNKNOWN_OPCODE)
     {
         TC_LOG_ERROR("opcode", "Prevented sending of UNKNOWN_OPCODE to %s", GetPlayerName(false).c_str());
-        return;
+        return false;
     }
 
     if (!forced)
@@ -222,10 +224,22 @@ void WorldSession::SendPacket(WorldPacket const* packet, bool forced /*= false*/
             #ifdef WIN32
             TC_LOG_ERROR("opcode", "Prevented sending disabled opcode %s to %s", GetOpcodeNameForLogging(packet->GetOpcode(), SMSG).c_str(), GetPlayerName(false).c_str());
             #endif
-            return;
+            return false;
         }
     }
 
+    return true;
+}
+
+/// Send a packet to the client
+void WorldSession::SendPacket(WorldPacket const* packet, bool forced /*= false*/)
+{
+    if (!m_Socket)
+        return;
+
+    if (!CanSendPacket(packet, forced))
+        return;
+
     const_cast<WorldPacket*>(packet)->FlushBits();
 
 
@@ -267,42 +281,113 @@ void WorldSession::SendPacket(WorldPacket const* packet, bool forced /*= false*/
         m_Socket->CloseSocket();
 }
 
-uint32 WorldSession::CompressPacket(uint8* buffer, WorldPacket const& packet)
+/// Deflates into the free space of the queue's slabs, appending slabs as they fill up
+static int32 DeflateToQueue(z_stream_s* stream, SendQueue& queue, void const* data, uint32 size, int32 flush, uint32& written, uint32& adler)
 {
-    uint32 opcode = packet.GetOpcode();
-    uint32 bufferSize = deflateBound(_compressionStream, packet.size() + sizeof(opcode));
+    stream->next_in = (Bytef*)data;
+    stream->avail_in = size;
+
+    do
+    {
+        std::size_t space;
+        uint8* out = queue.GetWriteSpace(space);
+        stream->next_out = out;
+        stream->avail_out = uInt(space);
+
+        int32 z_res = deflate(stream, flush);
+        // Z_BUF_ERROR: the previous slab ended exactly with the flushed output,
+        // nothing was left to write into this one
+        if (z_res != Z_OK && z_res != Z_BUF_ERROR)
+            return z_res;
+
+        std::size_t const produced = space - stream->avail_out;
+        queue.Commit(produced);
+        adler = adler32(adler, out, produced);
+        written += produced;
+
+        if (z_res == Z_BUF_ERROR)
+            break;
+    }
+    while (!stream->avail_out);
 
-    _compressionStream->next_out = buffer;
-    _compressionStream->avail_out = bufferSize;
-    _compressionStream->next_in = (Bytef*)&opcode;
-    _compressionStream->avail_in = sizeof(uint32);
+    return Z_OK;
+}
 
-    int32 z_res = deflate(_compressionStream, Z_BLOCK);
+/// Compresses the packet straight into the socket output, returns the compressed size
+/// and adds the compressed bytes to adler
+uint32 WorldSession::CompressPacket(SendQueue& queue, WorldPacket const& packet, uint32& adler)
+{
+    uint32 opcode = packet.GetOpcode();
+    uint32 written = 0;
+
+    int32 z_res = DeflateToQueue(_compressionStream, queue, &opcode, sizeof(opcode), Z_BLOCK, written, adler);
     if (z_res != Z_OK)
     {
         TC_LOG_ERROR("opcode", "Can't compress packet opcode (zlib: deflate) Error code: %i (%s, msg: %s)", z_res, zError(z_res), _compressionStream->msg);
-        return 0;
+        return written;
     }
 
-    _compressionStream->next_in = (Bytef*)packet.contents();
-    _compressionStream->avail_in = packet.size();
-
-    z_res = deflate(_compressionStream, Z_SYNC_FLUSH);
+    z_res = DeflateToQueue(_compressionStream, queue, packet.contents(), packet.size(), Z_SYNC_FLUSH, written, adler);
     if (z_res != Z_OK)
-    {
         TC_LOG_ERROR("opcode", "Can't compress packet data (zlib: deflate) Error code: %i (%s, msg: %s)", z_res, zError(z_res), _compressionStream->msg);
-        return 0;
+
+    return written;
+}
+
+/// Send a packet shared with other sessions, see SerializedPacket
+void WorldSession::SendPacket(SerializedPacket const& packet)
+{
+    if (!m_Socket || !CanSendPacket(&packet.GetPacket(), false))
+        return;
+
+    if (m_Socket->SendPacket(packet) == -1)
+        m_Socket->CloseSocket();
+}
+
+/// Feed a packet compressed by another stream to the compression history,
+/// the client inflates everything it receives with a single stream
+void WorldSession::AddCompressionHistory(WorldPacket const& packet)
+{
+    // deflate only keeps the last window of history, the opcode falls out
+    // of it behind a big enough packet
+    std::size_t const windowSize = std::size_t(1) << MAX_WBITS;
+
+    int32 z_res;
+    if (packet.size() >= windowSize)
+        z_res = deflateSetDictionary(_compressionStream, packet.contents() + packet.size() - windowSize, windowSize);
+    else
+    {
+        uint32 opcode = packet.GetOpcode();
+
+        // a single call, zlib releases differ in how consecutive dictionaries add up
+        std::vector<uint8> history(sizeof(opcode) + packet.size());
+        memcpy(&history[0], &opcode, sizeof(opcode));
+        if (!packet.empty())
+            memcpy(&history[sizeof(opcode)], packet.contents(), packet.size());
+
+        z_res = deflateSetDictionary(_compressionStream, &history[0], history.size());
     }
 
+    if (z_res != Z_OK)
+        TC_LOG_ERROR("network", "Can't update packet compression history (zlib: deflateSetDictionary) Error code: %i (%s)", z_res, zError(z_res));
+}
+
+/// Bytes sent to the client still waiting in the socket
+size_t WorldSession::GetQueuedOutput() const
+{
+    return m_Socket ? m_Socket->GetQueuedOutput() : 0;
+}
 
-    return bufferSize - _compressionStream->avail_out;
+size_t WorldSession::GetPeakQueuedOutput() const
+{
+    return m_Socket ? m_Socket->GetPeakQueuedOutput() : 0;
 }
 
 /// Add an incoming packet to the queue
 void WorldSession::QueuePacket(WorldPacket* new_packet, bool& deletePacket)
 {
     if(sWorld->GetAntiSpamm(new_packet->GetOpcode(), 0) == 0 || sWorld->GetAntiSpamm(new_packet->GetOpcode(), 1) == 0)
-        _recvQueue.add(new_packet);
+        _recvQueue.Enqueue(new_packet);
     else if(sWorld->GetAntiSpamm(new_packet->GetOpcode(), 0) > antispamm[new_packet->GetOpcode()][0])
     {
         if(antispamm[new_packet->GetOpcode()][1] == 0 || ((time(NULL) - antispamm[new_packet->GetOpcode()][1]) > sWorld->GetAntiSpamm(new_packet->GetOpcode(), 1)))
@@ -312,7 +397,7 @@ void WorldSession::QueuePacket(WorldPacket* new_packet, bool& deletePacket)
         }
 
         antispamm[new_packet->GetOpcode()][0]++;
-        _recvQueue.add(new_packet);
+        _recvQueue.Enqueue(new_packet);
     }
     else
     {
@@ -320,7 +405,7 @@ void WorldSession::QueuePacket(WorldPacket* new_packet, bool& deletePacket)
         {
             antispamm[new_packet->GetOpcode()][0] = 1;
             antispamm[new_packet->GetOpcode()][1] = time(NULL);
-            _recvQueue.add(new_packet);
+            _recvQueue.Enqueue(new_packet);
         }
         else
         {
@@ -349,6 +434,115 @@ void WorldSession::LogUnprocessedTail(WorldPacket* packet)
     packet->print_storage();
 }
 
+/// Handle a received packet, returns false if it was delayed and must not be deleted
+bool WorldSession::ProcessPacket(WorldPacket* packet)
+{
+    const OpcodeHandler* opHandle = opcodeTable[CMSG][packet->GetOpcode()];
+
+    try
+    {
+        switch (opHandle->status)
+        {
+            case STATUS_LOGGEDIN:
+                if (!_player)
+                {
+                    // skip STATUS_LOGGEDIN opcode unexpected errors if player logout sometime ago - this can be network lag delayed packets
+                    //! If player didn't log out a while ago, it means packets are being sent while the server does not recognize
+                    //! the client to be in world yet. We keep the packets aside and process them later.
+                    if (!m_playerRecentlyLogout)
+                    {
+                        _deferredPackets.push_back(packet);
+                        //! Log
+                        #ifdef WIN32
+                            TC_LOG_DEBUG("network", "Delaying packet with opcode %s with with status STATUS_LOGGEDIN. "
+                                "Player is currently not in world yet.", GetOpcodeNameForLogging(packet->GetOpcode(), CMSG).c_str());
+                        #endif
+                        return false;
+                    }
+                }
+                else if (_player->IsInWorld())
+                {
+                    sScriptMgr->OnPacketReceive(m_Socket, *packet);
+                    (this->*opHandle->handler)(*packet);
+                    #ifdef WIN32
+                    if (sLog->ShouldLog("network", LOG_LEVEL_TRACE) && packet->rpos() < packet->wpos())
+                        LogUnprocessedTail(packet);
+                    #endif
+                }
+                // lag can cause STATUS_LOGGEDIN opcodes to arrive after the player started a transfer
+                break;
+            case STATUS_LOGGEDIN_OR_RECENTLY_LOGGOUT:
+                if (!_player && !m_playerRecentlyLogout && !m_playerLogout) // There's a short delay between _player = null and m_playerRecentlyLogout = true during logout
+                    LogUnexpectedOpcode(packet, "STATUS_LOGGEDIN_OR_RECENTLY_LOGGOUT",
+                        "the player has not logged in yet and not recently logout");
+                else
+                {
+                    // not expected _player or must checked in packet hanlder
+                    sScriptMgr->OnPacketReceive(m_Socket, *packet);
+                    (this->*opHandle->handler)(*packet);
+                    if (sLog->ShouldLog("network", LOG_LEVEL_TRACE) && packet->rpos() < packet->wpos())
+                        LogUnprocessedTail(packet);
+                }
+                break;
+            case STATUS_TRANSFER:
+                if (!_player)
+                {
+                    LogUnexpectedOpcode(packet, "STATUS_TRANSFER", "the player has not logged in yet");
+                }
+                else if (_player->IsInWorld())
+                {
+                    LogUnexpectedOpcode(packet, "STATUS_TRANSFER", "the player is still in world");
+                }
+                else
+                {
+                    sScriptMgr->OnPacketReceive(m_Socket, *packet);
+                    (this->*opHandle->handler)(*packet);
+                    if (sLog->ShouldLog("network", LOG_LEVEL_TRACE) && packet->rpos() < packet->wpos())
+                        LogUnprocessedTail(packet);
+                }
+                break;
+            case STATUS_AUTHED:
+                // prevent cheating with skip queue wait
+                if (m_inQueue)
+                {
+                    LogUnexpectedOpcode(packet, "STATUS_AUTHED", "the player not pass queue yet");
+                    break;
+                }
+
+                // some auth opcodes can be recieved before STATUS_LOGGEDIN_OR_RECENTLY_LOGGOUT opcodes
+                // however when we recieve CMSG_CHAR_ENUM we are surely no longer during the logout process.
+                if (packet->GetOpcode() == CMSG_CHAR_ENUM)
+                    m_playerRecentlyLogout = false;
+
+                sScriptMgr->OnPacketReceive(m_Socket, *packet);
+                (this->*opHandle->handler)(*packet);
+                if (sLog->ShouldLog("network", LOG_LEVEL_TRACE) && packet->rpos() < packet->wpos())
+                    LogUnprocessedTail(packet);
+                break;
+            case STATUS_NEVER:
+                #ifdef WIN32
+                    TC_LOG_ERROR("opcode", "Received not allowed opcode %s from %s", GetOpcodeNameForLogging(packet->GetOpcode()).c_str()
+                        , GetPlayerName(false).c_str());
+                #endif
+                break;
+            case STATUS_UNHANDLED:
+                #ifdef WIN32
+                    TC_LOG_ERROR("opcode", "Received not handled opcode %s from %s", GetOpcodeNameForLogging(packet->GetOpcode()).c_str()
+                        , GetPlayerName(false).c_str());
+                #endif
+                break;
+        }
+    }
+    catch(ByteBufferException &)
+    {
+        TC_LOG_ERROR("network", "WorldSession::Update ByteBufferException occured while parsing a packet (opcode: %u) from client %s, accountid=%i. Skipped packet.",
+                packet->GetOpcode(), GetRemoteAddress().c_str(), GetAccountId());
+        packet->hexlike();
+    }
+
+    return true;
+}
+
 /// Update the WorldSession (triggered by World update)
 bool WorldSession::Update(uint32 diff, PacketFilter& updater)
 {
@@ -363,128 +557,35 @@ bool WorldSession::Update(uint32 diff, PacketFilter& updater)
     ///- Retrieve packets from the receive queue and call the appropriate handlers
     /// not process packets if socket already closed
     WorldPacket* packet = NULL;
-    //! Delete packet after processing by default
-    bool deletePacket = true;
-    //! To prevent infinite loop
-    WorldPacket* firstDelayedPacket = NULL;
-    //! If _recvQueue.peek() == firstDelayedPacket it means that in this Update call, we've processed all
-    //! *properly timed* packets, and we're now at the part of the queue where we find
-    //! delayed packets that were re-enqueued due to improper timing. To prevent an infinite
-    //! loop caused by re-enqueueing the same packets over and over again, we stop updating this session
-    //! and continue updating others. The re-enqueued packets will be handled in the next Update call for this session.
-
-    while (m_Socket && !m_Socket->IsClosed() &&
-            !_recvQueue.empty() && _recvQueue.peek(true) != firstDelayedPacket &&
-            _recvQueue.next(packet, updater))
-    {
-        const OpcodeHandler* opHandle = opcodeTable[CMSG][packet->GetOpcode()];
+    //! Set when a packet this updater may not handle is reached, nothing after it may be handled either
+    bool blocked = false;
 
-        try
-        {
-            switch (opHandle->status)
-            {
-                case STATUS_LOGGEDIN:
-                    if (!_player)
-                    {
-                        // skip STATUS_LOGGEDIN opcode unexpected errors if player logout sometime ago - this can be network lag delayed packets
-                        //! If player didn't log out a while ago, it means packets are being sent while the server does not recognize
-                        //! the client to be in world yet. We will re-add the packets to the bottom of the queue and process them later.
-                        if (!m_playerRecentlyLogout)
-                        {
-                            //! Prevent infinite loop
-                            if (!firstDelayedPacket)
-                                firstDelayedPacket = packet;
-                            //! Because checking a bool is faster than reallocating memory
-                            deletePacket = false;
-                            QueuePacket(packet, deletePacket);
-                            //! Log
-                            #ifdef WIN32
-                                TC_LOG_DEBUG("network", "Re-enqueueing packet with opcode %s with with status STATUS_LOGGEDIN. "
-                                    "Player is currently not in world yet.", GetOpcodeNameForLogging(packet->GetOpcode(), CMSG).c_str());
-                            #endif
-                        }
-                    }
-                    else if (_player->IsInWorld())
-                    {
-                        sScriptMgr->OnPacketReceive(m_Socket, WorldPacket(*packet));
-                        (this->*opHandle->handler)(*packet);
-                        #ifdef WIN32
-                        if (sLog->ShouldLog("network", LOG_LEVEL_TRACE) && packet->rpos() < packet->wpos())
-                            LogUnprocessedTail(packet);
-                        #endif
-                    }
-                    // lag can cause STATUS_LOGGEDIN opcodes to arrive after the player started a transfer
-                    break;
-                case STATUS_LOGGEDIN_OR_RECENTLY_LOGGOUT:
-                    if (!_player && !m_playerRecentlyLogout && !m_playerLogout) // There's a short delay between _player = null and m_playerRecentlyLogout = true during logout
-                        LogUnexpectedOpcode(packet, "STATUS_LOGGEDIN_OR_RECENTLY_LOGGOUT",
-                            "the player has not logged in yet and not recently logout");
-                    else
-                    {
-                        // not expected _player or must checked in packet hanlder
-                        sScriptMgr->OnPacketReceive(m_Socket, WorldPacket(*packet));
-                        (this->*opHandle->handler)(*packet);
-                        if (sLog->ShouldLog("network", LOG_LEVEL_TRACE) && packet->rpos() < packet->wpos())
-                            LogUnprocessedTail(packet);
-                    }
-                    break;
-                case STATUS_TRANSFER:
-                    if (!_player)
-                    {
-                        LogUnexpectedOpcode(packet, "STATUS_TRANSFER", "the player has not logged in yet");
-                    }
-                    else if (_player->IsInWorld())
-                    {
-                        LogUnexpectedOpcode(packet, "STATUS_TRANSFER", "the player is still in world");
-                    }
-                    else
-                    {
-                        sScriptMgr->OnPacketReceive(m_Socket, WorldPacket(*packet));
-                        (this->*opHandle->handler)(*packet);
-                        if (sLog->ShouldLog("network", LOG_LEVEL_TRACE) && packet->rpos() < packet->wpos())
-                            LogUnprocessedTail(packet);
-                    }
-                    break;
-                case STATUS_AUTHED:
-                    // prevent cheating with skip queue wait
-                    if (m_inQueue)
-                    {
-                        LogUnexpectedOpcode(packet, "STATUS_AUTHED", "the player not pass queue yet");
-                        break;
-                    }
+    //! Query callbacks added by the handlers run on this same kind of update
+    _queryCallbackUpdate = updater.ProcessLogout() ? QUERY_CALLBACK_WORLD_UPDATE : QUERY_CALLBACK_MAP_UPDATE;
 
-                    // some auth opcodes can be recieved before STATUS_LOGGEDIN_OR_RECENTLY_LOGGOUT opcodes
-                    // however when we recieve CMSG_CHAR_ENUM we are surely no longer during the logout process.
-                    if (packet->GetOpcode() == CMSG_CHAR_ENUM)
-                        m_playerRecentlyLogout = false;
+    //! Packets delayed by a previous call come first. Packets delayed again during this call are only
+    //! retried on the next one, so a player that is not in world yet can't keep us spinning here.
+    if (!_deferredPackets.empty())
+    {
+        std::vector<WorldPacket*> deferred;
+        deferred.swap(_deferredPackets);
 
-                    sScriptMgr->OnPacketReceive(m_Socket, WorldPacket(*packet));
-                    (this->*opHandle->handler)(*packet);
-                    if (sLog->ShouldLog("network", LOG_LEVEL_TRACE) && packet->rpos() < packet->wpos())
-                        LogUnprocessedTail(packet);
-                    break;
-                case STATUS_NEVER:
-                    #ifdef WIN32
-                        TC_LOG_ERROR("opcode", "Received not allowed opcode %s from %s", GetOpcodeNameForLogging(packet->GetOpcode()).c_str()
-                            , GetPlayerName(false).c_str());
-                    #endif
-                    break;
-                case STATUS_UNHANDLED:
-                    #ifdef WIN32
-                        TC_LOG_ERROR("opcode", "Received not handled opcode %s from %s", GetOpcodeNameForLogging(packet->GetOpcode()).c_str()
-                            , GetPlayerName(false).c_str());
-                    #endif
-                    break;
-            }
-        }
-        catch(ByteBufferException &)
+        for (std::vector<WorldPacket*>::const_iterator itr = deferred.begin(); itr != deferred.end(); ++itr)
         {
-            TC_LOG_ERROR("network", "WorldSession::Update ByteBufferException occured while parsing a packet (opcode: %u) from client %s, accountid=%i. Skipped packet.",
-                    packet->GetOpcode(), GetRemoteAddress().c_str(), GetAccountId());
-            packet->hexlike();
+            packet = *itr;
+            if (!blocked && (!m_Socket || m_Socket->IsClosed() || !updater.Process(packet)))
+                blocked = true;
+
+            if (blocked)
+                _deferredPackets.push_back(packet);
+            else if (ProcessPacket(packet))
+                delete packet;
         }
+    }
 
-        if (deletePacket)
+    while (!blocked && m_Socket && !m_Socket->IsClosed() && _recvQueue.Dequeue(packet, updater))
+    {
+        if (ProcessPacket(packet))
             delete packet;
     }
 
@@ -496,6 +597,8 @@ bool WorldSession::Update(uint32 diff, PacketFilter& updater)
 
     ProcessQueryCallbacks();
 
+    _queryCallbackUpdate = QUERY_CALLBACK_WORLD_UPDATE;
+
     //check if we are safe to proceed with logout
     //logout procedure should happen only in World::UpdateSessions() method!!!
     if (updater.ProcessLogout())
@@ -698,6 +801,9 @@ void WorldSession::LogoutPlayer(bool Save)
 
         SetPlayer(NULL); //! Pointer already deleted during RemovePlayerFromMap
 
+        //! Map updates no longer run for this session, their pending callbacks belonged to the player
+        _asyncQueryCallbacks[QUERY_CALLBACK_MAP_UPDATE].clear();
+
         //! Send the 'logout complete' packet to the client
         //! Client will respond by sending 3x CMSG_CANCEL_TRADE, which we currently dont handle
         WorldPacket data(SMSG_LOGOUT_COMPLETE, 0);
@@ -1442,8 +1548,48 @@ void WorldSession::InitializeQueryCallbackParameters()
     _charCreateCallback.SetParam(NULL);
 }
 
+void WorldSession::AddQueryCallback(QueryResultFuture future, std::function<void(QueryResult)> callback)
+{
+    AsyncQueryCallback entry;
+    entry.IsReady = [future]() { return future.ready() != 0; };
+    entry.Call = [future, callback]()
+    {
+        QueryResult result;
+        future.get(result);
+        callback(result);
+    };
+    _asyncQueryCallbacks[_queryCallbackUpdate].push_back(std::move(entry));
+}
+
+void WorldSession::AddQueryCallback(PreparedQueryResultFuture future, std::function<void(PreparedQueryResult)> callback)
+{
+    AsyncQueryCallback entry;
+    entry.IsReady = [future]() { return future.ready() != 0; };
+    entry.Call = [future, callback]()
+    {
+        PreparedQueryResult result;
+        future.get(result);
+        callback(result);
+    };
+    _asyncQueryCallbacks[_queryCallbackUpdate].push_back(std::move(entry));
+}
+
 void WorldSession::ProcessQueryCallbacks()
 {
+    std::deque<AsyncQueryCallback>& callbacks = _asyncQueryCallbacks[_queryCallbackUpdate];
+
+    // keep the order of the requests, a later query may finish first on another connection
+    while (!callbacks.empty() && callbacks.front().IsReady())
+    {
+        AsyncQueryCallback entry = std::move(callbacks.front());
+        callbacks.pop_front();
+        entry.Call();
+    }
+
+    // the callbacks below are all set by thread-unsafe handlers
+    if (_queryCallbackUpdate != QUERY_CALLBACK_WORLD_UPDATE)
+        return;
+
     PreparedQueryResult result;
 
     //! HandleCharEnumOpcode
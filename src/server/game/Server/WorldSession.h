@@ -31,7 +31,10 @@
 #include "WorldPacket.h"
 #include "Cryptography/BigNumber.h"
 #include "Opcodes.h"
+#include "MPSCQueue.h"
 #include <mutex>
+#include <deque>
+#include <functional>
 
 class CalendarEvent;
 class CalendarInvite;
@@ -43,6 +46,8 @@ class LoginQueryHolder;
 class Object;
 class Player;
 class Quest;
+class SendQueue;
+class SerializedPacket;
 class SpellCastTargets;
 class Unit;
 class Warden;
@@ -265,8 +270,10 @@ class WorldSession
         void ReadMovementInfo(WorldPacket& data, MovementInfo* mi);
         static void WriteMovementInfo(WorldPacket& data, MovementInfo* mi, Unit* unit = NULL);
 
-        uint32 CompressPacket(uint8* buffer, WorldPacket const& packet);
+        uint32 CompressPacket(SendQueue& queue, WorldPacket const& packet, uint32& adler);
+        void AddCompressionHistory(WorldPacket const& packet);
         void SendPacket(WorldPacket const* packet, bool forced = false);
+        void SendPacket(SerializedPacket const& packet);
         void SendNotification(const char *format, ...) ATTR_PRINTF(2, 3);
         void SendNotification(uint32 string_id, ...);
         void SendPetNameInvalid(uint32 error, const std::string& name, DeclinedName *declinedName);
@@ -341,6 +348,7 @@ class WorldSession
         void SendCancelTrade();
 
         void SendPetitionQueryOpcode(uint64 petitionguid);
+        void SendPetitionQueryCallback(PreparedQueryResult result, uint64 petitionguid);
 
         // Pet
         void SendPetNameQuery(uint64 guid, uint32 petnumber);
@@ -405,6 +413,8 @@ class WorldSession
         const char *GetTrinityString(int32 entry) const;
 
         uint32 GetLatency() const { return m_latency; }
+        size_t GetQueuedOutput() const;
+        size_t GetPeakQueuedOutput() const;
         void SetLatency(uint32 latency) { m_latency = latency; }
 
         std::string GetOS() const { return _clientOS; }
@@ -735,6 +745,7 @@ class WorldSession
 
         void HandleUseItemOpcode(WorldPacket& recvPacket);
         void HandleOpenItemOpcode(WorldPacket& recvPacket);
+        void HandleOpenWrappedItemCallback(PreparedQueryResult result, uint64 itemGuid);
         void HandleCastSpellOpcode(WorldPacket& recvPacket);
         void HandleCancelCastOpcode(WorldPacket& recvPacket);
         void HandleCancelAuraOpcode(WorldPacket& recvPacket);
@@ -1075,10 +1086,33 @@ class WorldSession
 
         void SetWardenModuleFailed(bool s) { wardenModuleFailed = s; }
         bool IsWardenModuleFailed() { return wardenModuleFailed; }
+
+        // Runs callback with the result once the query is done, on the same kind of session update
+        // that added it: the map update for thread-safe packets, the world update otherwise.
+        // Callbacks of an update run in the order they were added; the player may have logged out meanwhile.
+        void AddQueryCallback(QueryResultFuture future, std::function<void(QueryResult)> callback);
+        void AddQueryCallback(PreparedQueryResultFuture future, std::function<void(PreparedQueryResult)> callback);
+
     private:
         void InitializeQueryCallbackParameters();
         void ProcessQueryCallbacks();
 
+        struct AsyncQueryCallback
+        {
+            std::function<bool()> IsReady;
+            std::function<void()> Call;
+        };
+
+        enum QueryCallbackUpdate
+        {
+            QUERY_CALLBACK_WORLD_UPDATE,                    // World::UpdateSessions() and outside of session updates
+            QUERY_CALLBACK_MAP_UPDATE,                      // Map::Update(), thread-safe packets
+            MAX_QUERY_CALLBACK_UPDATES
+        };
+
+        std::deque<AsyncQueryCallback> _asyncQueryCallbacks[MAX_QUERY_CALLBACK_UPDATES];
+        QueryCallbackUpdate _queryCallbackUpdate;
+
         PreparedQueryResultFuture _charEnumCallback;
         PreparedQueryResultFuture _addIgnoreCallback;
         PreparedQueryResultFuture _stablePetCallback;
@@ -1095,8 +1129,13 @@ class WorldSession
 
         // logging helper
         void LogUnexpectedOpcode(WorldPacket* packet, const char* status, const char *reason);
+
+        bool CanSendPacket(WorldPacket const* packet, bool forced) const;
         void LogUnprocessedTail(WorldPacket* packet);
 
+        // receive queue helpers
+        bool ProcessPacket(WorldPacket* packet);
+
         // EnumData helpers
         bool CharCanLogin(uint32 lowGUID)
         {
@@ -1142,7 +1181,13 @@ class WorldSession
         bool _filterAddonMessages;
         uint32 recruiterId;
         bool isRecruiter;
-        ACE_Based::LockedQueue<WorldPacket*, ACE_Thread_Mutex> _recvQueue;
+
+        // Received packets in arrival order, filled by the network threads and drained by whichever of
+        // World::UpdateSessions() or Map::Update() is updating the session. Each stops at the first packet
+        // its filter rejects so that packets are always handled in the order the client sent them.
+        MPSCQueue<WorldPacket*> _recvQueue;
+        // STATUS_LOGGEDIN packets received before the player is in world, retried on the next Update()
+        std::vector<WorldPacket*> _deferredPackets;
         time_t timeCharEnumOpcode;
         uint8 playerLoginCounter;
 
@@ -45,6 +45,7 @@
 #include "PacketLog.h"
 #include "ScriptMgr.h"
 #include "AccountMgr.h"
+#include "SerializedPacket.h"
 #include "zlib.h"
 
 #if defined(__GNUC__)
@@ -53,13 +54,6 @@
 #pragma pack(push, 1)
 #endif
 
-struct CompressedWorldPacket
-{
-    uint32 UncompressedSize;
-    uint32 UncompressedAdler;
-    uint32 CompressedAdler;
-};
-
 union ServerPktHeader
 {
     struct
@@ -104,21 +98,17 @@ uint32 const SizeOfServerHeader[2] = { /*sizeof(uint16) +*/ sizeof(uint32), size
 WorldSocket::WorldSocket (void): WorldHandler(),
     m_LastPingTime(ACE_Time_Value::zero), m_OverSpeedPings(0), m_Session(0),
     m_RecvWPct(0), m_RecvPct(), m_Header(sizeof(AuthClientPktHeader)), m_WorldHeader(sizeof(WorldClientPktHeader)),
-    m_OutBuffer(0), m_OutBufferSize(65536), m_OutActive(false),
+    m_SendQueue(NULL), m_OutBufferSize(65536), m_OutActive(false),
     m_Seed(static_cast<uint32> (rand32()))
 {
     reference_counting_policy().value (ACE_Event_Handler::Reference_Counting_Policy::ENABLED);
-
-    msg_queue()->high_water_mark(8 * 1024 * 1024);
-    msg_queue()->low_water_mark(8 * 1024 * 1024);
 }
 
 WorldSocket::~WorldSocket (void)
 {
     delete m_RecvWPct;
 
-    if (m_OutBuffer)
-        m_OutBuffer->release();
+    delete m_SendQueue;
 
     closing_ = true;
 
@@ -154,39 +144,43 @@ const std::string& WorldSocket::GetRemoteAddress (void) const
     return m_Address;
 }
 
-void WorldSocket::WritePacketToBuffer(WorldPacket const& packet, MessageBuffer& buffer)
+void WorldSocket::WritePacketToBuffer(WorldPacket const& packet, SendQueue& queue)
 {
-    ServerPktHeader header;
     uint32 sizeOfHeader = SizeOfServerHeader[m_Crypt.IsInitialized()];
     uint32 opcode = packet.GetOpcode();
     uint32 packetSize = packet.size();
 
-    // Reserve space for buffer
-    uint8* headerPos = buffer.GetWritePointer();
-    buffer.WriteCompleted(sizeOfHeader);
+    // Reserve space for header, written once the size is known
+    uint8* headerPos = queue.Reserve(sizeOfHeader);
 
-    if (packetSize > 0x400 && m_Session)
+    if (packetSize > PACKET_COMPRESSION_THRESHOLD && m_Session)
     {
+        uint8* cmpPos = queue.Reserve(sizeof(CompressedWorldPacket));
+
         CompressedWorldPacket cmp;
         cmp.UncompressedSize = packetSize + 4;
         cmp.UncompressedAdler = adler32(adler32(0x9827D8F1, (Bytef*)&opcode, 4), packet.contents(), packetSize);
 
-        // Reserve space for compression info - uncompressed size and checksums
-        uint8* compressionInfo = buffer.GetWritePointer();
-        buffer.WriteCompleted(sizeof(CompressedWorldPacket));
-
-        uint32 compressedSize = m_Session->CompressPacket(buffer.GetWritePointer(), packet);
-
-        cmp.CompressedAdler = adler32(0x9827D8F1, buffer.GetWritePointer(), compressedSize);
+        // deflated straight into the output, the header is filled afterwards
+        uint32 compressedAdler = 0x9827D8F1;
+        uint32 compressedSize = m_Session->CompressPacket(queue, packet, compressedAdler);
+        cmp.CompressedAdler = compressedAdler;
 
-        memcpy(compressionInfo, &cmp, sizeof(CompressedWorldPacket));
-        buffer.WriteCompleted(compressedSize);
+        memcpy(cmpPos, &cmp, sizeof(CompressedWorldPacket));
         packetSize = compressedSize + sizeof(CompressedWorldPacket);
 
         opcode = SMSG_COMPRESSED_OPCODE;
     }
     else if (!packet.empty())
-        buffer.Write(packet.contents(), packet.size());
+        queue.Write(packet.contents(), packet.size());
+
+    WriteHeader(headerPos, opcode, packetSize);
+}
+
+void WorldSocket::WriteHeader(uint8* headerPos, uint32 opcode, uint32 packetSize)
+{
+    ServerPktHeader header;
+    uint32 sizeOfHeader = SizeOfServerHeader[m_Crypt.IsInitialized()];
 
     if (m_Crypt.IsInitialized())
     {
@@ -217,16 +211,9 @@ void WorldSocket::WritePacketToBuffer(WorldPacket const& packet, MessageBuffer&
     memcpy(headerPos, &header, sizeOfHeader);
 }
 
-int WorldSocket::SendPacket(WorldPacket const* pct)
+void WorldSocket::LogSendPacket(WorldPacket const& packet, uint32 packetSize)
 {
-    ACE_GUARD_RETURN (LockType, Guard, m_OutBufferLock, -1);
-
-    if (closing_)
-        return -1;
-
-    size_t size = pct->wpos();
-
-    if (pct->GetOpcode() != SMSG_MONSTER_MOVE)
+    if (packet.GetOpcode() != SMSG_MONSTER_MOVE)
     {
         if (m_Session)
             if(Player* _player = m_Session->GetPlayer())
@@ -234,53 +221,96 @@ int WorldSocket::SendPacket(WorldPacket const* pct)
                 {
                     // Dump outgoing packet
                     if (sPacketLog->CanLogPacket())
-                        sPacketLog->LogPacket(*pct, SERVER_TO_CLIENT);
-                    TC_LOG_DEBUG("dupe", "S->C: %s", GetOpcodeNameForLogging(pct->GetOpcode()).c_str());
+                        sPacketLog->LogPacket(packet, SERVER_TO_CLIENT);
+                    TC_LOG_DEBUG("dupe", "S->C: %s", GetOpcodeNameForLogging(packet.GetOpcode()).c_str());
                 }
         #ifdef WIN32
-        TC_LOG_INFO("opcode", "S->C: %s len %u", GetOpcodeNameForLogging(pct->GetOpcode()).c_str(), pct->wpos());
+        TC_LOG_INFO("opcode", "S->C: %s len %u", GetOpcodeNameForLogging(packet.GetOpcode()).c_str(), packet.wpos());
         #endif
     }
 
+    SendSize[packet.GetOpcode()] += packetSize;
+    ++SendCount[packet.GetOpcode()];
+
+    sScriptMgr->OnPacketSend(this, packet);
+}
+
+int WorldSocket::SendPacket(WorldPacket const* pct)
+{
+    ACE_GUARD_RETURN (LockType, Guard, m_OutBufferLock, -1);
+
+    if (closing_)
+        return -1;
+
+    if (!CanQueueOutput())
+        return -1;
+
     uint32 packetSize = pct->size();
-    uint32 sizeOfHeader = SizeOfServerHeader[m_Crypt.IsInitialized()];
-    if (packetSize > 0x400 && m_Session)
+    if (packetSize > PACKET_COMPRESSION_THRESHOLD && m_Session)
         packetSize = compressBound(packetSize) + sizeof(CompressedWorldPacket);
 
-    SendSize[pct->GetOpcode()] += packetSize;
-    ++SendCount[pct->GetOpcode()];
+    LogSendPacket(*pct, packetSize);
+
+    WritePacketToBuffer(*pct, *m_SendQueue);
+    return 0;
+}
+
+int WorldSocket::SendPacket(SerializedPacket const& packet)
+{
+    if (!packet.IsCompressed())
+        return SendPacket(&packet.GetPacket());
 
-    sScriptMgr->OnPacketSend(this, *pct);
+    std::vector<uint8> const& payload = packet.GetCompressedPayload();
+    if (payload.empty())
+        return SendPacket(&packet.GetPacket());
 
-    MessageBuffer buffer(sizeOfHeader + packetSize);
-    WritePacketToBuffer(*pct, buffer);
+    ACE_GUARD_RETURN (LockType, Guard, m_OutBufferLock, -1);
+
+    if (closing_)
+        return -1;
 
-    if (m_OutBuffer->space() >= buffer.GetActiveSize() && msg_queue()->is_empty())
+    // packets are only compressed for sockets owning a session
+    if (!m_Session)
     {
-        // Put the packet on the buffer.
-        if (m_OutBuffer->copy((char*)buffer.GetBasePointer(), buffer.GetActiveSize()) == -1)
-            ACE_ASSERT (false);
+        Guard.release();
+        return SendPacket(&packet.GetPacket());
     }
-    else
-    {
-        // Enqueue the packet.
-        ACE_Message_Block* mb;
 
-        ACE_NEW_RETURN(mb, ACE_Message_Block(buffer.GetActiveSize()), -1);
+    if (!CanQueueOutput())
+        return -1;
 
-        mb->copy((const char*)buffer.GetBasePointer(), buffer.GetActiveSize());
+    LogSendPacket(packet.GetPacket(), payload.size());
 
-        if (msg_queue()->enqueue_tail(mb, (ACE_Time_Value*)&ACE_Time_Value::zero) == -1)
-        {
-            TC_LOG_ERROR("network", "WorldSocket::SendPacket enqueue_tail failed");
-            mb->release();
-            return -1;
-        }
-    }
+    m_Session->AddCompressionHistory(packet.GetPacket());
+
+    uint8* headerPos = m_SendQueue->Reserve(SizeOfServerHeader[m_Crypt.IsInitialized()]);
+    m_SendQueue->Write(&payload[0], payload.size());
+    WriteHeader(headerPos, SMSG_COMPRESSED_OPCODE, payload.size());
 
     return 0;
 }
 
+bool WorldSocket::CanQueueOutput() const
+{
+    if (m_SendQueue->GetLength() < MaxQueuedOutput)
+        return true;
+
+    TC_LOG_ERROR("network", "WorldSocket::SendPacket: %s has " SIZEFMTD " bytes of output pending, closing", m_Address.c_str(), m_SendQueue->GetLength());
+    return false;
+}
+
+size_t WorldSocket::GetQueuedOutput()
+{
+    ACE_GUARD_RETURN (LockType, Guard, m_OutBufferLock, 0);
+    return m_SendQueue ? m_SendQueue->GetLength() : 0;
+}
+
+size_t WorldSocket::GetPeakQueuedOutput()
+{
+    ACE_GUARD_RETURN (LockType, Guard, m_OutBufferLock, 0);
+    return m_SendQueue ? m_SendQueue->GetPeakLength() : 0;
+}
+
 long WorldSocket::AddReference (void)
 {
     return static_cast<long> (add_reference());
@@ -296,7 +326,7 @@ int WorldSocket::open (void *a)
     ACE_UNUSED_ARG (a);
 
     // Prevent double call to this func.
-    if (m_OutBuffer)
+    if (m_SendQueue)
         return -1;
 
     // This will also prevent the socket from being Updated
@@ -308,7 +338,7 @@ int WorldSocket::open (void *a)
         return -1;
 
     // Allocate the buffer.
-    ACE_NEW_RETURN (m_OutBuffer, ACE_Message_Block (m_OutBufferSize), -1);
+    m_SendQueue = new SendQueue(m_OutBufferSize);
 
     // Store peer address.
     ACE_INET_Addr remote_addr;
@@ -396,15 +426,25 @@ int WorldSocket::handle_output (ACE_HANDLE)
     if (closing_)
         return -1;
 
-    size_t send_len = m_OutBuffer->length();
+    if (m_SendQueue->Empty())
+        return cancel_wakeup_output(Guard);
 
-    if (send_len == 0)
-        return handle_output_queue(Guard);
+    iovec iov[MaxSendVectors];
+    int const count = m_SendQueue->Fill(iov, MaxSendVectors);
+
+    size_t send_len = 0;
+    for (int i = 0; i < count; ++i)
+        send_len += iov[i].iov_len;
 
 #ifdef MSG_NOSIGNAL
-    ssize_t n = peer().send (m_OutBuffer->rd_ptr(), send_len, MSG_NOSIGNAL);
+    msghdr msg;
+    memset(&msg, 0, sizeof(msg));
+    msg.msg_iov = iov;
+    msg.msg_iovlen = count;
+
+    ssize_t n = ACE_OS::sendmsg (get_handle(), &msg, MSG_NOSIGNAL);
 #else
-    ssize_t n = peer().send (m_OutBuffer->rd_ptr(), send_len);
+    ssize_t n = peer().sendv (iov, count);
 #endif // MSG_NOSIGNAL
 
     if (n == 0)
@@ -416,84 +456,16 @@ int WorldSocket::handle_output (ACE_HANDLE)
 
         return -1;
     }
-    else if (n < (ssize_t)send_len) //now n > 0
-    {
-        m_OutBuffer->rd_ptr (static_cast<size_t> (n));
 
-        // move the data to the base of the buffer
-        m_OutBuffer->crunch();
+    m_SendQueue->Consume(static_cast<size_t> (n));
 
+    if (n < (ssize_t)send_len) //now n > 0
         return schedule_wakeup_output (Guard);
-    }
-    else //now n == send_len
-    {
-        m_OutBuffer->reset();
-
-        return handle_output_queue (Guard);
-    }
+    else if (m_SendQueue->Empty())
+        return cancel_wakeup_output (Guard);
 
-    ACE_NOTREACHED (return 0);
-}
-
-int WorldSocket::handle_output_queue (GuardType& g)
-{
-    if (msg_queue()->is_empty())
-        return cancel_wakeup_output(g);
-
-    ACE_Message_Block* mblk;
-
-    if (msg_queue()->dequeue_head(mblk, (ACE_Time_Value*)&ACE_Time_Value::zero) == -1)
-    {
-        TC_LOG_ERROR("network", "WorldSocket::handle_output_queue dequeue_head");
-        return -1;
-    }
-
-    const size_t send_len = mblk->length();
-
-#ifdef MSG_NOSIGNAL
-    ssize_t n = peer().send (mblk->rd_ptr(), send_len, MSG_NOSIGNAL);
-#else
-    ssize_t n = peer().send (mblk->rd_ptr(), send_len);
-#endif // MSG_NOSIGNAL
-
-    if (n == 0)
-    {
-        mblk->release();
-
-        return -1;
-    }
-    else if (n == -1)
-    {
-        if (errno == EWOULDBLOCK || errno == EAGAIN)
-        {
-            msg_queue()->enqueue_head(mblk, (ACE_Time_Value*) &ACE_Time_Value::zero);
-            return schedule_wakeup_output (g);
-        }
-
-        mblk->release();
-        return -1;
-    }
-    else if (n < (ssize_t)send_len) //now n > 0
-    {
-        mblk->rd_ptr(static_cast<size_t> (n));
-
-        if (msg_queue()->enqueue_head(mblk, (ACE_Time_Value*) &ACE_Time_Value::zero) == -1)
-        {
-            TC_LOG_ERROR("network", "WorldSocket::handle_output_queue enqueue_head");
-            mblk->release();
-            return -1;
-        }
-
-        return schedule_wakeup_output (g);
-    }
-    else //now n == send_len
-    {
-        mblk->release();
-
-        return msg_queue()->is_empty() ? cancel_wakeup_output(g) : ACE_Event_Handler::WRITE_MASK;
-    }
-
-    ACE_NOTREACHED(return -1);
+    // more slabs pending than a single write takes
+    return ACE_Event_Handler::WRITE_MASK;
 }
 
 int WorldSocket::handle_close (ACE_HANDLE h, ACE_Reactor_Mask)
@@ -524,8 +496,12 @@ int WorldSocket::Update (void)
     if (closing_)
         return -1;
 
-    if (m_OutActive || (m_OutBuffer->length() == 0 && msg_queue()->is_empty()))
-        return 0;
+    {
+        ACE_GUARD_RETURN (LockType, Guard, m_OutBufferLock, -1);
+
+        if (m_OutActive || m_SendQueue->Empty())
+            return 0;
+    }
 
     int ret;
     do
@@ -863,23 +839,23 @@ int WorldSocket::ProcessIncoming(WorldPacket* new_pct)
                 return -1;
             }
 
-            sScriptMgr->OnPacketReceive(this, WorldPacket(*new_pct));
+            sScriptMgr->OnPacketReceive(this, *new_pct);
             return HandleAuthSession(*new_pct);
         case CMSG_KEEP_ALIVE:
             #ifdef WIN32
             TC_LOG_DEBUG("network", "%s", GetOpcodeNameForLogging(opcode).c_str());
             #endif
-            sScriptMgr->OnPacketReceive(this, WorldPacket(*new_pct));
+            sScriptMgr->OnPacketReceive(this, *new_pct);
             return 0;
         case CMSG_LOG_DISCONNECT:
             new_pct->rfinish(); // contains uint32 disconnectReason;
             #ifdef WIN32
             TC_LOG_DEBUG("network", "%s", GetOpcodeNameForLogging(opcode).c_str());
             #endif
-            sScriptMgr->OnPacketReceive(this, WorldPacket(*new_pct));
+            sScriptMgr->OnPacketReceive(this, *new_pct);
             return 0;
         case CMSG_REORDER_CHARACTERS:
-            sScriptMgr->OnPacketReceive(this, WorldPacket(*new_pct));
+            sScriptMgr->OnPacketReceive(this, *new_pct);
 
 
             if (m_Session)
@@ -894,7 +870,7 @@ int WorldSocket::ProcessIncoming(WorldPacket* new_pct)
                 #ifdef WIN32
                 TC_LOG_DEBUG("network", "%s", GetOpcodeNameForLogging(opcode).c_str());
                 #endif
-                sScriptMgr->OnPacketReceive(this, WorldPacket(*new_pct));
+                sScriptMgr->OnPacketReceive(this, *new_pct);
                 std::string str;
                 *new_pct >> str;
                 if (str != "D OF WARCRAFT CONNECTION - CLIENT TO SERVER")
@@ -906,7 +882,7 @@ int WorldSocket::ProcessIncoming(WorldPacket* new_pct)
                 #ifdef WIN32
                 TC_LOG_DEBUG("network", "%s", GetOpcodeNameForLogging(opcode).c_str());
                 #endif
-                sScriptMgr->OnPacketReceive(this, WorldPacket(*new_pct));
+                sScriptMgr->OnPacketReceive(this, *new_pct);
                 return m_Session ? m_Session->HandleEnableNagleAlgorithm() : -1;
             }
         default:
@@ -40,9 +40,10 @@
 
 #include "Common.h"
 #include "AuthCrypt.h"
-#include "MessageBuffer.h"
+#include "SendQueue.h"
 
 class ACE_Message_Block;
+class SerializedPacket;
 class WorldPacket;
 class WorldSession;
 
@@ -111,8 +112,17 @@ class WorldSocket : public WorldHandler
         /// @return -1 of failure
         int SendPacket(WorldPacket const* pct);
 
+        /// Send a packet shared with other sockets, its payload is only
+        /// compressed once for all of them.
+        /// @return -1 of failure
+        int SendPacket(SerializedPacket const& packet);
+
         //
-        void WritePacketToBuffer(WorldPacket const& packet, MessageBuffer& buffer);
+        void WritePacketToBuffer(WorldPacket const& packet, SendQueue& queue);
+
+        /// Bytes of output waiting for the peer, and the most ever waiting.
+        size_t GetQueuedOutput();
+        size_t GetPeakQueuedOutput();
 
         /// Add reference to this object.
         long AddReference (void);
@@ -152,8 +162,11 @@ class WorldSocket : public WorldHandler
         int cancel_wakeup_output (GuardType& g);
         int schedule_wakeup_output (GuardType& g);
 
-        /// Drain the queue if its not empty.
-        int handle_output_queue (GuardType& g);
+
+        /// Helpers of SendPacket, called with m_OutBufferLock held.
+        void WriteHeader(uint8* headerPos, uint32 opcode, uint32 packetSize);
+        void LogSendPacket(WorldPacket const& packet, uint32 packetSize);
+        bool CanQueueOutput() const;
 
         /// process one incoming packet.
         /// @param new_pct received packet, note that you need to delete it.
@@ -202,12 +215,18 @@ class WorldSocket : public WorldHandler
         /// Mutex for protecting output related data.
         LockType m_OutBufferLock;
 
-        /// Buffer used for writing output.
-        ACE_Message_Block* m_OutBuffer;
+        /// Output waiting for the peer.
+        SendQueue* m_SendQueue;
 
-        /// Size of the m_OutBuffer.
+        /// Bytes of drained send slabs kept by m_SendQueue.
         size_t m_OutBufferSize;
 
+        /// Pending output closing the connection, the client stopped reading.
+        static size_t const MaxQueuedOutput = 8 * 1024 * 1024;
+
+        /// Slabs handed to a single gathered write.
+        static int const MaxSendVectors = 64;
+
         /// True if the socket is registered with the reactor for output
         bool m_OutActive;
 
@@ -1932,6 +1932,8 @@ void AuraEffect::CalculateFromDummyAmount(Unit* caster, Unit* target, float &amo
 
 void AuraEffect::CalculatePeriodic(Unit* caster, bool resetPeriodicTimer /*= true*/, bool load /*= false*/)
 {
+    GetBase()->PrepareTimerChange();
+
     m_amplitude = m_spellInfo->GetEffect(m_effIndex, m_diffMode)->Amplitude;
                         
     // prepare periodics
@@ -2125,7 +2127,10 @@ void AuraEffect::ChangeAmount(float newAmount, bool mark, bool onStackOrReapply)
     if (handleMask & AURA_EFFECT_HANDLE_CHANGE_AMOUNT)
     {
         if (!mark)
+        {
             m_amount = newAmount;
+            InvalidateTargetAuraTotals();
+        }
         else
             SetAmount(newAmount);
         CalculateSpellMod();
@@ -2139,6 +2144,13 @@ void AuraEffect::ChangeAmount(float newAmount, bool mark, bool onStackOrReapply)
             HandleEffect(*apptItr, handleMask, true);
 }
 
+void AuraEffect::InvalidateTargetAuraTotals() const
+{
+    Aura::ApplicationMap const& applications = GetBase()->GetApplicationMap();
+    for (Aura::ApplicationMap::const_iterator itr = applications.begin(); itr != applications.end(); ++itr)
+        itr->second->GetTarget()->InvalidateAuraTotals(GetAuraType());
+}
+
 void AuraEffect::HandleEffect(AuraApplication * aurApp, uint8 mode, bool apply)
 {
     if(!GetBase())
@@ -2298,7 +2310,7 @@ void AuraEffect::Update(uint32 diff, Unit* caster)
 
     GetBase()->CallScriptEffectUpdateHandlers(diff, this);
 
-    if (m_isPeriodic && (GetBase()->GetDuration() >=0 || GetBase()->IsPassive() || GetBase()->IsPermanent()))
+    if (IsPeriodicTimerRunning())
     {
         if (m_periodicTimer > int32(diff))
             m_periodicTimer -= diff;
@@ -65,6 +65,7 @@ class AuraEffect
             {
                 m_amount = amount;
                 GetBase()->SetNeedClientUpdateForTargets();
+                InvalidateTargetAuraTotals();
             }
 
             m_canBeRecalculated = false;
@@ -74,8 +75,11 @@ class AuraEffect
         float GetCritChance() const { return m_crit_chance; }
         void SetCritChance(float amount) { m_crit_chance = amount;}
 
-        int32 GetPeriodicTimer() const { return m_periodicTimer; }
-        void SetPeriodicTimer(int32 periodicTimer) { m_periodicTimer = periodicTimer; }
+        int32 GetPeriodicTimer() const { return IsPeriodicTimerRunning() ? m_periodicTimer - int32(GetBase()->GetPendingUpdateTime()) : m_periodicTimer; }
+        void SetPeriodicTimer(int32 periodicTimer) { GetBase()->PrepareTimerChange(); m_periodicTimer = periodicTimer; }
+        bool IsPeriodicTimerRunning() const { return m_isPeriodic && (GetBase()->GetDuration() >= 0 || GetBase()->IsPassive() || GetBase()->IsPermanent()); }
+        // lazy countdown of a sleeping aura, see Aura::SyncTimers
+        void SyncPeriodicTimer(uint32 diff) { if (IsPeriodicTimerRunning()) m_periodicTimer -= diff; }
 
         float CalculateAmount(Unit* caster, float &m_aura_amount);
         void CalculateFromDummyAmount(Unit* caster, Unit* target, float &amount);
@@ -96,10 +100,10 @@ class AuraEffect
         uint32 GetTickNumber() const { return m_tickNumber; }
         void SetTickNumber(uint32 tick) { m_tickNumber = tick; }
         uint32 GetTotalTicks() const { return m_amplitude ? (GetBase()->GetMaxDuration() / m_amplitude) : 1;}
-        void ResetPeriodic(bool resetPeriodicTimer = false) { if (resetPeriodicTimer) m_periodicTimer = m_amplitude; m_tickNumber = 0;}
+        void ResetPeriodic(bool resetPeriodicTimer = false) { if (resetPeriodicTimer) { GetBase()->PrepareTimerChange(); m_periodicTimer = m_amplitude; } m_tickNumber = 0;}
 
         bool IsPeriodic() const { return m_isPeriodic; }
-        void SetPeriodic(bool isPeriodic) { m_isPeriodic = isPeriodic; }
+        void SetPeriodic(bool isPeriodic) { GetBase()->PrepareTimerChange(); m_isPeriodic = isPeriodic; }
         bool IsAffectingSpell(SpellInfo const* spell) const;
         bool HasSpellClassMask() const { return m_spellInfo->GetEffect(m_effIndex, m_diffMode)->SpellClassMask; }
 
@@ -113,6 +117,9 @@ class AuraEffect
         // add/remove SPELL_AURA_MOD_SHAPESHIFT (36) linked auras
         void HandleShapeshiftBoosts(Unit* target, bool apply) const;
     private:
+        // amount changed, cached aura totals of the targets are stale
+        void InvalidateTargetAuraTotals() const;
+
         Aura* const m_base;
 
         SpellInfo const* const m_spellInfo;
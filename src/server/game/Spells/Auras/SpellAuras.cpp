@@ -701,7 +701,8 @@ m_castItemGuid(castItem ? castItem->GetGUID() : 0), m_applyTime(time(NULL)),
 m_owner(owner), m_timeCla(0), m_updateTargetMapInterval(0),
 m_casterLevel(caster ? caster->getLevel() : m_spellInfo->SpellLevel), m_procCharges(0), m_stackAmount(stackAmount ? stackAmount: 1),
 m_isRemoved(false), m_isSingleTarget(false), m_isUsingCharges(false), m_fromAreatrigger(false), m_inArenaNerf(false), m_aura_amount(0),
-m_diffMode(caster ? caster->GetSpawnMode() : 0), m_spellDynObjGuid(0), m_spellAreaTrGuid(0), m_customData(0), m_damage_amount(0), m_removeDelay(0)
+m_diffMode(caster ? caster->GetSpawnMode() : 0), m_spellDynObjGuid(0), m_spellAreaTrGuid(0), m_customData(0), m_damage_amount(0), m_removeDelay(0),
+m_ownerClock(NULL), m_updateClock(0), m_updateQueueTime(0)
 {
     SpellPowerEntry power;
     if (!GetSpellInfo()->GetSpellPowerByCasterPower(GetCaster(), power))
@@ -863,6 +864,8 @@ void Aura::UpdateTargetMap(Unit* caster, bool apply, bool immuneCheck)
     if (IsRemoved())
         return;
 
+    SyncTimers();
+
     m_updateTargetMapInterval = UPDATE_TARGET_MAP_INTERVAL;
 
     // fill up to date target list
@@ -1058,6 +1061,62 @@ void Aura::UpdateOwner(uint32 diff, WorldObject* owner)
     _DeleteRemovedApplications();
 }
 
+uint32 Aura::GetUpdateDelay() const
+{
+    // work done on every update
+    if (m_removeDelay > 0 || m_timeCla || GetSpellInfo()->IsChanneled())
+        return 1;
+
+    for (std::list<AuraScript*>::const_iterator itr = m_loadedScripts.begin(); itr != m_loadedScripts.end(); ++itr)
+        if ((*itr)->OnEffectUpdate.size())
+            return 1;
+
+    // otherwise the next update is due with the first timer running out,
+    // updating earlier is always safe
+    int32 delay = m_updateTargetMapInterval;
+    if (m_duration > 0)
+        delay = std::min(delay, m_duration);
+
+    for (uint8 i = 0; i < MAX_SPELL_EFFECTS; ++i)
+        if (m_effects[i] && m_effects[i]->IsPeriodicTimerRunning())
+            delay = std::min(delay, m_effects[i]->GetPeriodicTimer());
+
+    return delay > 1 ? uint32(delay) : 1;
+}
+
+void Aura::SyncTimers()
+{
+    uint32 const diff = GetPendingUpdateTime();
+    if (!diff)
+        return;
+
+    // same countdown as Update and UpdateOwner, the delay guarantees that
+    // no timer runs out before the owner clock reaches the next update
+    for (uint8 i = 0; i < MAX_SPELL_EFFECTS; ++i)
+        if (m_effects[i])
+            m_effects[i]->SyncPeriodicTimer(diff);
+
+    if (m_duration > 0)
+    {
+        m_duration -= diff;
+        m_allDuration += diff;
+    }
+
+    m_updateTargetMapInterval -= diff;
+    m_updateClock = *m_ownerClock;
+}
+
+void Aura::PrepareTimerChange()
+{
+    if (!m_ownerClock || IsRemoved())
+        return;
+
+    SyncTimers();
+
+    // the delay may have become shorter, update with the next owner update
+    GetUnitOwner()->ScheduleAuraUpdate(this, m_updateClock + 1);
+}
+
 void Aura::Update(uint32 diff, Unit* caster)
 {
     if (m_removeDelay > 0)
@@ -1188,6 +1247,7 @@ void Aura::SetDuration(int32 duration, bool withMods)
             if (Player* modOwner = caster->GetSpellModOwner())
                 modOwner->ApplySpellMod(GetId(), SPELLMOD_DURATION, duration);
     }
+    PrepareTimerChange();
     m_duration = duration;
     SetNeedClientUpdateForTargets();
 }
@@ -1587,6 +1647,7 @@ int32 Aura::CalcDispelChance(Unit* auraTarget, bool offensive) const
 
 void Aura::SetLoadedState(int32 maxduration, int32 duration, int32 charges, uint8 stackamount, uint32 recalculateMask, int32 * amount)
 {
+    PrepareTimerChange();
     m_maxDuration = maxduration;
     m_duration = duration;
     m_procCharges = charges;
@@ -3186,6 +3247,7 @@ void UnitAura::Remove(AuraRemoveMode removeMode)
 
     if (GetSpellInfo()->AttributesCu & SPELL_ATTR0_CU_REMOVE_AFTER_DELAY)
     {
+        PrepareTimerChange();
         m_removeDelay = 1;
         return;
     }
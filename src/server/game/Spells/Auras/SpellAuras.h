@@ -144,10 +144,24 @@ class Aura
         void SetMaxDuration(int32 duration) { m_maxDuration = duration; }
         int32 CalcMaxDuration() { return CalcMaxDuration(GetCaster()); }
         int32 CalcMaxDuration(Unit* caster);
-        int32 GetDuration() const { return m_duration; }
-        int32 GetAllDuration() const { return m_allDuration; }
+        int32 GetDuration() const { return m_duration > 0 ? std::max<int32>(m_duration - int32(GetPendingUpdateTime()), 0) : m_duration; }
+        int32 GetAllDuration() const { return m_duration > 0 ? m_allDuration + int32(GetPendingUpdateTime()) : m_allDuration; }
         void SetDuration(int32 duration, bool withMods = false);
         void RefreshDuration(bool recalculate = true);
+
+        // Auras owned by a unit are updated by it only when something of them
+        // is due (see GetUpdateDelay), in between the owner clock runs ahead of
+        // the aura clock and the timers are counted down lazily.
+        uint32 GetUpdateDelay() const;
+        uint32 GetPendingUpdateTime() const { return m_ownerClock && *m_ownerClock > m_updateClock ? uint32(*m_ownerClock - m_updateClock) : 0; }
+        uint64 GetUpdateClock() const { return m_updateClock; }
+        void SetUpdateClock(uint64 const* ownerClock, uint64 time) { m_ownerClock = ownerClock; m_updateClock = time; }
+        uint64 GetUpdateQueueTime() const { return m_updateQueueTime; }
+        void SetUpdateQueueTime(uint64 time) { m_updateQueueTime = time; }
+        // counts the timers down to the owner clock, nothing can be due there
+        void SyncTimers();
+        // must be called before any timer is modified from outside of the update
+        void PrepareTimerChange();
         void RefreshTimers();
         bool IsExpired() const { return !GetDuration();}
         bool IsPermanent() const { return GetMaxDuration() == -1; }
@@ -290,6 +304,9 @@ class Aura
         int32 m_timeCla;                                    // Timer for power per sec calcultion
         int32 m_updateTargetMapInterval;                    // Timer for UpdateTargetMapOfEffect
         uint32 m_removeDelay;
+        uint64 const* m_ownerClock;                         // Unit::GetAuraClock() of the owner, NULL if not scheduled
+        uint64 m_updateClock;                               // Owner clock at the last update
+        uint64 m_updateQueueTime;                           // Owner clock of the next update, 0 if not queued
 
         uint16 m_casterLevel;                                // Aura level (store caster level for correct show level dep amount)
         uint8 m_procCharges;                                // Aura charges (0 for infinite)
@@ -2282,13 +2282,15 @@ void Spell::SearchChainTargets(std::list<WorldObject*>& targets, uint32 chainTar
 
         if (isChainHeal)
         {
+            nextTarget->RemoveNotInLOSInMap(tempTargets);
+
             uint32 maxHPDeficit = 0;
             for (std::list<WorldObject*>::iterator itr = tempTargets.begin(); itr != tempTargets.end(); ++itr)
             {
                 if (Unit* unitTarget = (*itr)->ToUnit())
                 {
                     uint32 deficit = unitTarget->GetMaxHealth() - unitTarget->GetHealth();
-                    if ((deficit > maxHPDeficit || !foundItr) && nextTarget->IsWithinDist(unitTarget, jumpRadius) && nextTarget->IsWithinLOSInMap(unitTarget))
+                    if ((deficit > maxHPDeficit || !foundItr) && nextTarget->IsWithinDist(unitTarget, jumpRadius))
                     {
                         foundItr = unitTarget;
                         maxHPDeficit = deficit;
@@ -2298,15 +2300,20 @@ void Spell::SearchChainTargets(std::list<WorldObject*>& targets, uint32 chainTar
         }
         else
         {
+            // only the first candidate may skip the check when bouncing far
+            std::list<WorldObject*> inLosTargets(tempTargets);
+            target->RemoveNotInLOSInMap(inLosTargets);
+            std::unordered_set<WorldObject*> const inLos(inLosTargets.begin(), inLosTargets.end());
+
             for (std::list<WorldObject*>::iterator itr = tempTargets.begin(); itr != tempTargets.end(); ++itr)
             {
                 if (!foundItr)
                 {
                     // isBouncingFar allow hit not in los target & IsWithinDist already checked at SearchAreaTargets
-                    if (isBouncingFar || target->IsWithinLOSInMap(*itr))
+                    if (isBouncingFar || inLos.count(*itr))
                         foundItr = *itr;
                 }
-                else if (target->GetDistanceOrder(*itr, foundItr) && target->IsWithinLOSInMap(*itr))
+                else if (target->GetDistanceOrder(*itr, foundItr) && inLos.count(*itr))
                     foundItr = *itr;
             }
         }
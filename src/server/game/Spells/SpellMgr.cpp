@@ -407,7 +407,7 @@ bool IsDiminishingReturnsGroupDurationLimited(DiminishingGroup group)
     }
 }
 
-SpellMgr::SpellMgr()
+SpellMgr::SpellMgr() : mSpellProcDataGeneration(0)
 {
 }
 
@@ -1006,6 +1006,20 @@ SpellProcEntry const* SpellMgr::GetSpellProcEntry(uint32 spellId) const
     return NULL;
 }
 
+uint32 SpellMgr::GetSpellProcFlagsMask(SpellInfo const* spellInfo) const
+{
+    uint32 procFlags = spellInfo->ProcFlags;
+
+    if (std::vector<SpellProcEventEntry> const* spellProcEvents = GetSpellProcEvent(spellInfo->Id))
+        for (std::vector<SpellProcEventEntry>::const_iterator itr = spellProcEvents->begin(); itr != spellProcEvents->end(); ++itr)
+            procFlags |= itr->procFlags;
+
+    if (SpellProcEntry const* procEntry = GetSpellProcEntry(spellInfo->Id))
+        procFlags |= procEntry->typeMask;
+
+    return procFlags;
+}
+
 bool SpellMgr::CanSpellTriggerProcOnEvent(SpellProcEntry const& procEntry, ProcEventInfo& eventInfo)
 {
     // proc type doesn't match
@@ -1960,6 +1974,7 @@ void SpellMgr::LoadSpellProcEvents()
     uint32 oldMSTime = getMSTime();
 
     mSpellProcEventMap.clear();                             // need for reload case
+    ++mSpellProcDataGeneration;
 
     //                                               0      1           2                3                 4                 5                 6                 7          8       9        10            11        12
     QueryResult result = WorldDatabase.Query("SELECT entry, SchoolMask, SpellFamilyName, SpellFamilyMask0, SpellFamilyMask1, SpellFamilyMask2, SpellFamilyMask3, procFlags, procEx, ppmRate, CustomChance, Cooldown, effectmask FROM spell_proc_event");
@@ -2026,6 +2041,7 @@ void SpellMgr::LoadSpellProcs()
     uint32 oldMSTime = getMSTime();
 
     mSpellProcMap.clear();                             // need for reload case
+    ++mSpellProcDataGeneration;
 
     //                                               0        1           2                3                 4                 5                 6                 7         8              9               10       11              12             13      14        15       16
     QueryResult result = WorldDatabase.Query("SELECT spellId, schoolMask, spellFamilyName, spellFamilyMask0, spellFamilyMask1, spellFamilyMask2, spellFamilyMask3, typeMask, spellTypeMask, spellPhaseMask, hitMask, attributesMask, ratePerMinute, chance, cooldown, charges, modcharges FROM spell_proc");
@@ -999,6 +999,12 @@ class SpellMgr
         SpellProcEntry const* GetSpellProcEntry(uint32 spellId) const;
         bool CanSpellTriggerProcOnEvent(SpellProcEntry const& procEntry, ProcEventInfo& eventInfo);
 
+        // Union of every proc flag an aura of the spell may proc on according to
+        // the spell itself, spell_proc_event and spell_proc, 0 if it never procs
+        uint32 GetSpellProcFlagsMask(SpellInfo const* spellInfo) const;
+        // Changes whenever the proc tables above are (re)loaded
+        uint32 GetSpellProcDataGeneration() const { return mSpellProcDataGeneration; }
+
         // Spell bonus data table
         SpellBonusEntry const* GetSpellBonusData(uint32 spellId) const;
 
@@ -1098,6 +1104,7 @@ class SpellMgr
         SpellGroupStackMap         mSpellGroupStack;
         SpellProcEventMap          mSpellProcEventMap;
         SpellProcMap               mSpellProcMap;
+        uint32                     mSpellProcDataGeneration;
         SpellBonusMap              mSpellBonusMap;
         SpellThreatMap             mSpellThreatMap;
         SpellPetAuraMap            mSpellPetAuraMap;
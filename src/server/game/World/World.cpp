@@ -86,7 +86,9 @@
 #include "PlayerDump.h"
 #include "ChallengeMgr.h"
 #include "ScenarioMgr.h"
+#include "SerializedPacket.h"
 #include "ThreadPoolMgr.hpp"
+#include "TaskGraph.hpp"
 
 ACE_Atomic_Op<ACE_Thread_Mutex, bool> World::m_stopEvent = false;
 uint8 World::m_ExitCode = SHUTDOWN_EXIT_CODE;
@@ -1331,6 +1333,9 @@ void World::LoadConfigSettings(bool reload)
     m_int_configs[CONFIG_INTERVAL_LOG_UPDATE] = ConfigMgr::GetIntDefault("RecordUpdateTimeDiffInterval", 60000);
     m_int_configs[CONFIG_MIN_LOG_UPDATE] = ConfigMgr::GetIntDefault("MinRecordUpdateTimeDiff", 100);
     m_int_configs[CONFIG_NUMTHREADS] = ConfigMgr::GetIntDefault("MapUpdate.Threads", 1);
+    m_bool_configs[CONFIG_MAP_REGION_UPDATE] = ConfigMgr::GetBoolDefault("MapUpdate.Regions.Enable", false);
+    m_bool_configs[CONFIG_MAP_UPDATE_ASSERT_SYNC_QUERIES] = ConfigMgr::GetBoolDefault("MapUpdate.AssertSyncQueries", false);
+    m_int_configs[CONFIG_MAP_REGION_MIN_PLAYERS] = ConfigMgr::GetIntDefault("MapUpdate.Regions.MinPlayers", 200);
     m_int_configs[CONFIG_MAX_RESULTS_LOOKUP_COMMANDS] = ConfigMgr::GetIntDefault("Command.LookupMaxResults", 0);
 
     // chat logging
@@ -1656,98 +1661,135 @@ void World::SetInitialWorldSettings()
     TC_LOG_INFO("server", "Loading Game Object Templates...");         // must be after LoadPageTexts
     sObjectMgr->LoadGameObjectTemplate();
 
-    TC_LOG_INFO("server", "Loading Spell Rank Data...");
-    sSpellMgr->LoadSpellRanks();
+    // Loaders below only depend on each other as declared, independent
+    // chains run concurrently on the thread pool against the world database
+    Trinity::TaskGraph loaders;
 
-    TC_LOG_INFO("server", "Loading Spell Required Data...");
-    sSpellMgr->LoadSpellRequired();
-
-    TC_LOG_INFO("server", "Loading Spell Group types...");
-    sSpellMgr->LoadSpellGroups();
+    Trinity::TaskGraph::TaskId const spellData = loaders.add("Spell data", []
+    {
+        TC_LOG_INFO("server", "Loading Spell Rank Data...");
+        sSpellMgr->LoadSpellRanks();
 
-    TC_LOG_INFO("server", "Loading Spell Learn Skills...");
-    sSpellMgr->LoadSpellLearnSkills();                           // must be after LoadSpellRanks
+        TC_LOG_INFO("server", "Loading Spell Required Data...");
+        sSpellMgr->LoadSpellRequired();
 
-    TC_LOG_INFO("server", "Loading Spell Learn Spells...");
-    sSpellMgr->LoadSpellLearnSpells();
+        TC_LOG_INFO("server", "Loading Spell Group types...");
+        sSpellMgr->LoadSpellGroups();
 
-    TC_LOG_INFO("server", "Loading Spell Proc Event conditions...");
-    sSpellMgr->LoadSpellProcEvents();
+        TC_LOG_INFO("server", "Loading Spell Learn Skills...");
+        sSpellMgr->LoadSpellLearnSkills();                           // must be after LoadSpellRanks
 
-    TC_LOG_INFO("server", "Loading Spell Proc conditions and data...");
-    sSpellMgr->LoadSpellProcs();
+        TC_LOG_INFO("server", "Loading Spell Learn Spells...");
+        sSpellMgr->LoadSpellLearnSpells();
 
-    TC_LOG_INFO("server", "Loading Spell Bonus Data...");
-    sSpellMgr->LoadSpellBonusess();
+        TC_LOG_INFO("server", "Loading Spell Proc Event conditions...");
+        sSpellMgr->LoadSpellProcEvents();
 
-    TC_LOG_INFO("server", "Loading Aggro Spells Definitions...");
-    sSpellMgr->LoadSpellThreats();
+        TC_LOG_INFO("server", "Loading Spell Proc conditions and data...");
+        sSpellMgr->LoadSpellProcs();
 
-    TC_LOG_INFO("server", "Loading Spell Group Stack Rules...");
-    sSpellMgr->LoadSpellGroupStackRules();
+        TC_LOG_INFO("server", "Loading Spell Bonus Data...");
+        sSpellMgr->LoadSpellBonusess();
 
-    TC_LOG_INFO("server", "Loading forbidden spells...");
-    sSpellMgr->LoadForbiddenSpells();
+        TC_LOG_INFO("server", "Loading Aggro Spells Definitions...");
+        sSpellMgr->LoadSpellThreats();
 
-    TC_LOG_INFO("server", "Loading Spell Phase Dbc Info...");
-    sObjectMgr->LoadSpellPhaseInfo();
+        TC_LOG_INFO("server", "Loading Spell Group Stack Rules...");
+        sSpellMgr->LoadSpellGroupStackRules();
 
-    TC_LOG_INFO("server", "Loading NPC Texts...");
-    sObjectMgr->LoadGossipText();
+        TC_LOG_INFO("server", "Loading forbidden spells...");
+        sSpellMgr->LoadForbiddenSpells();
 
-    TC_LOG_INFO("server", "Loading Enchant Spells Proc datas...");
-    sSpellMgr->LoadSpellEnchantProcData();
+        TC_LOG_INFO("server", "Loading Enchant Spells Proc datas...");
+        sSpellMgr->LoadSpellEnchantProcData();
+    });
 
-    TC_LOG_INFO("server", "Loading Item Random Enchantments Table...");
-    LoadRandomEnchantmentsTable();
+    loaders.add("Spell phases", []
+    {
+        TC_LOG_INFO("server", "Loading Spell Phase Dbc Info...");
+        sObjectMgr->LoadSpellPhaseInfo();
+    }, { spellData });
 
-    TC_LOG_INFO("server", "Loading Disables");
-    DisableMgr::LoadDisables();                                 // must be before loading quests and items
+    loaders.add("NPC texts", []
+    {
+        TC_LOG_INFO("server", "Loading NPC Texts...");
+        sObjectMgr->LoadGossipText();
+    });
 
-    TC_LOG_INFO("server", "Loading Items...");                         // must be after LoadRandomEnchantmentsTable and LoadPageTexts
-    sObjectMgr->LoadItemTemplates();
+    bool const fasterLoading = getBoolConfig(CONFIG_FASTER_LOADING);
 
-    if (!getBoolConfig(CONFIG_FASTER_LOADING))
+    // disables are checked against spell info
+    loaders.add("Items", [fasterLoading]
     {
-        TC_LOG_INFO("server", "Loading Item set names...");                // must be after LoadItemPrototypes
-        sObjectMgr->LoadItemTemplateAddon();
-    }
+        TC_LOG_INFO("server", "Loading Item Random Enchantments Table...");
+        LoadRandomEnchantmentsTable();
 
-    TC_LOG_INFO("server", "Loading Item Scripts...");                 // must be after LoadItemPrototypes
-    sObjectMgr->LoadItemScriptNames();
+        TC_LOG_INFO("server", "Loading Disables");
+        DisableMgr::LoadDisables();                                 // must be before loading quests and items
 
-    TC_LOG_INFO("server", "Loading Creature Model Based Info Data...");
-    sObjectMgr->LoadCreatureModelInfo();
+        TC_LOG_INFO("server", "Loading Items...");                         // must be after LoadRandomEnchantmentsTable and LoadPageTexts
+        sObjectMgr->LoadItemTemplates();
+
+        if (!fasterLoading)
+        {
+            TC_LOG_INFO("server", "Loading Item set names...");                // must be after LoadItemPrototypes
+            sObjectMgr->LoadItemTemplateAddon();
+        }
 
-    TC_LOG_INFO("server", "Loading Equipment templates...");
-    sObjectMgr->LoadEquipmentTemplates();
+        TC_LOG_INFO("server", "Loading Item Scripts...");                 // must be after LoadItemPrototypes
+        sObjectMgr->LoadItemScriptNames();
+    }, { spellData });
 
-    TC_LOG_INFO("server", "Loading Creature templates...");
-    sObjectMgr->LoadCreatureTemplates();
+    Trinity::TaskGraph::TaskId const creatureModels = loaders.add("Creature models", []
+    {
+        TC_LOG_INFO("server", "Loading Creature Model Based Info Data...");
+        sObjectMgr->LoadCreatureModelInfo();
+    });
 
-    if (!getBoolConfig(CONFIG_FASTER_LOADING))
+    Trinity::TaskGraph::TaskId const creatureTemplates = loaders.add("Creature templates", [fasterLoading]
     {
-        TC_LOG_INFO("server", "Loading Creature template addons...");
-        sObjectMgr->LoadCreatureTemplateAddons();
-    }
+        TC_LOG_INFO("server", "Loading Equipment templates...");
+        sObjectMgr->LoadEquipmentTemplates();
+
+        TC_LOG_INFO("server", "Loading Creature templates...");
+        sObjectMgr->LoadCreatureTemplates();
+
+        if (!fasterLoading)
+        {
+            TC_LOG_INFO("server", "Loading Creature template addons...");
+            sObjectMgr->LoadCreatureTemplateAddons();
+        }
+
+        TC_LOG_INFO("server", "Loading Creature difficulty stat...");
+        sObjectMgr->LoadCreatureDifficultyStat();
+    }, { spellData, creatureModels });
 
-    TC_LOG_INFO("server", "Loading Creature difficulty stat...");
-    sObjectMgr->LoadCreatureDifficultyStat();
+    loaders.add("Reputation", []
+    {
+        TC_LOG_INFO("server", "Loading Reputation Reward Rates...");
+        sObjectMgr->LoadReputationRewardRate();
 
-    TC_LOG_INFO("server", "Loading Reputation Reward Rates...");
-    sObjectMgr->LoadReputationRewardRate();
+        TC_LOG_INFO("server", "Loading Creature Reputation OnKill Data...");
+        sObjectMgr->LoadReputationOnKill();
 
-    TC_LOG_INFO("server", "Loading Creature Reputation OnKill Data...");
-    sObjectMgr->LoadReputationOnKill();
+        TC_LOG_INFO("server", "Loading Reputation Spillover Data...");
+        sObjectMgr->LoadReputationSpilloverTemplate();
+    }, { creatureTemplates });
 
-    TC_LOG_INFO("server", "Loading Reputation Spillover Data...");
-    sObjectMgr->LoadReputationSpilloverTemplate();
+    loaders.add("Points of interest", []
+    {
+        TC_LOG_INFO("server", "Loading Points Of Interest Data...");
+        sObjectMgr->LoadPointsOfInterest();
+    });
 
-    TC_LOG_INFO("server", "Loading Points Of Interest Data...");
-    sObjectMgr->LoadPointsOfInterest();
+    loaders.add("Creature base stats", []
+    {
+        TC_LOG_INFO("server", "Loading Creature Base Stats...");
+        sObjectMgr->LoadCreatureClassLevelStats();
+    }, { creatureTemplates });
 
-    TC_LOG_INFO("server", "Loading Creature Base Stats...");
-    sObjectMgr->LoadCreatureClassLevelStats();
+    loaders.run();
+    loaders.logReport("server");
 
     TC_LOG_INFO("server", "Loading Creature Data...");
     sObjectMgr->LoadCreatures();
@@ -1891,45 +1933,69 @@ void World::SetInitialWorldSettings()
 
         TC_LOG_INFO("server", "Loading Player level dependent mail rewards...");
         sObjectMgr->LoadMailLevelRewards();
+    }
 
-        // Loot tables
-        LoadLootTables();
-
-        TC_LOG_INFO("server", "Loading Skill Discovery Table...");
-        LoadSkillDiscoveryTable();
+    // every template these read is loaded by now, each node only fills
+    // containers of its own manager
+    Trinity::TaskGraph tables;
 
-        TC_LOG_INFO("server", "Loading Skill Extra Item Table...");
-        LoadSkillExtraItemTable();
+    if (!fasterLoading)
+    {
+        tables.add("Loot tables", []
+        {
+            LoadLootTables();
+        });
 
-        TC_LOG_INFO("server", "Loading Skill Fishing base level requirements...");
-        sObjectMgr->LoadFishingBaseSkillLevel();
-    }
+        tables.add("Skill tables", []
+        {
+            TC_LOG_INFO("server", "Loading Skill Discovery Table...");
+            LoadSkillDiscoveryTable();
+
+            TC_LOG_INFO("server", "Loading Skill Extra Item Table...");
+            LoadSkillExtraItemTable();
+
+            TC_LOG_INFO("server", "Loading Skill Fishing base level requirements...");
+            sObjectMgr->LoadFishingBaseSkillLevel();
+        });
+    }
+
+    tables.add("Achievements", []
+    {
+        TC_LOG_INFO("server", "Loading Achievements...");
+        sAchievementMgr->LoadAchievementReferenceList();
+        TC_LOG_INFO("server", "Loading Criteria Lists...");
+        sAchievementMgr->LoadCriteriaList();
+        TC_LOG_INFO("server", "Loading Achievement Criteria Data...");
+        sAchievementMgr->LoadAchievementCriteriaData();
+        TC_LOG_INFO("server", "Loading Achievement Rewards...");
+        sAchievementMgr->LoadRewards();
+        TC_LOG_INFO("server", "Loading Achievement Reward Locales...");
+        sAchievementMgr->LoadRewardLocales();
+        TC_LOG_INFO("server", "Loading Completed Achievements...");
+        sAchievementMgr->LoadCompletedAchievements();
+    });
 
-    TC_LOG_INFO("server", "Loading Achievements...");
-    sAchievementMgr->LoadAchievementReferenceList();
-    TC_LOG_INFO("server", "Loading Criteria Lists...");
-    sAchievementMgr->LoadCriteriaList();
-    TC_LOG_INFO("server", "Loading Achievement Criteria Data...");
-    sAchievementMgr->LoadAchievementCriteriaData();
-    TC_LOG_INFO("server", "Loading Achievement Rewards...");
-    sAchievementMgr->LoadRewards();
-    TC_LOG_INFO("server", "Loading Achievement Reward Locales...");
-    sAchievementMgr->LoadRewardLocales();
-    TC_LOG_INFO("server", "Loading Completed Achievements...");
-    sAchievementMgr->LoadCompletedAchievements();
+    tables.add("Auctions", []
+    {
+        // Delete expired auctions before loading
+        TC_LOG_INFO("server", "Deleting expired auctions...");
+        sAuctionMgr->DeleteExpiredAuctionsAtStartup();
 
-    // Delete expired auctions before loading
-    TC_LOG_INFO("server", "Deleting expired auctions...");
-    sAuctionMgr->DeleteExpiredAuctionsAtStartup();
+        ///- Load dynamic data tables from the database
+        TC_LOG_INFO("server", "Loading Item Auctions...");
+        sAuctionMgr->LoadAuctionItems();
+        TC_LOG_INFO("server", "Loading Auctions...");
+        sAuctionMgr->LoadAuctions();
+    });
 
-    ///- Load dynamic data tables from the database
-    TC_LOG_INFO("server", "Loading Item Auctions...");
-    sAuctionMgr->LoadAuctionItems();
-    TC_LOG_INFO("server", "Loading Auctions...");
-    sAuctionMgr->LoadAuctions();
+    tables.add("Currency loot", []
+    {
+        TC_LOG_INFO("server", "Loading Currencys Loot...");
+        sObjectMgr->LoadCurrencysLoot();
+    });
 
-    TC_LOG_INFO("server", "Loading Currencys Loot...");
-    sObjectMgr->LoadCurrencysLoot();
+    tables.run();
+    tables.logReport("server");
 
     TC_LOG_INFO("server", "Loading Guild XP for level...");
     sGuildMgr->LoadGuildXpForLevel();
@@ -2204,6 +2270,7 @@ void World::SetInitialWorldSettings()
     }
 
     uint32 startupDuration = GetMSTimeDiffToNow(startupBegin);
+    TC_LOG_INFO("server", ">> Startup took %u ms, %u ms of it in concurrent loaders", startupDuration, loaders.wallTime() + tables.wallTime());
 
     TC_LOG_INFO("server", "World initialized in %u minutes %u seconds", (startupDuration / 60000), ((startupDuration % 60000) / 1000));
 
@@ -2564,6 +2631,7 @@ void World::ForceGameEventUpdate()
 /// Send a packet to all players (except self if mentioned)
 void World::SendGlobalMessage(WorldPacket* packet, WorldSession* self, uint32 team)
 {
+    SerializedPacket serialized(*packet);
     SessionMap::const_iterator itr;
     for (itr = m_sessions.begin(); itr != m_sessions.end(); ++itr)
     {
@@ -2573,7 +2641,7 @@ void World::SendGlobalMessage(WorldPacket* packet, WorldSession* self, uint32 te
             itr->second != self &&
             (team == 0 || itr->second->GetPlayer()->GetTeam() == team))
         {
-            itr->second->SendPacket(packet);
+            itr->second->SendPacket(serialized);
         }
     }
 }
@@ -3365,11 +3433,13 @@ void World::ResetDailyQuests()
 
 void World::ResetCurrencyWeekCap()
 {
-    sThreadPoolMgr->schedule([] {
-        CharacterDatabase.Execute("UPDATE `character_currency` SET `week_count` = 0, `curentcap` = 0");
-    });
-
-    sThreadPoolMgr->wait();
+    {
+        Trinity::TaskGroup reset;
+        reset.run([] {
+            CharacterDatabase.Execute("UPDATE `character_currency` SET `week_count` = 0, `curentcap` = 0");
+        });
+        reset.wait();
+    }
 
     for (SessionMap::const_iterator itr = m_sessions.begin(); itr != m_sessions.end(); ++itr)
         if (itr->second->GetPlayer())
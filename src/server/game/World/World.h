@@ -210,6 +210,8 @@ enum WorldBoolConfigs
     CONFIG_CUSTOM_X20,
     CONFIG_CUSTOM_FOOTBALL,
     CONFIG_ANTI_FLOOD_LFG,
+    CONFIG_MAP_REGION_UPDATE,
+    CONFIG_MAP_UPDATE_ASSERT_SYNC_QUERIES,
     BOOL_CONFIG_VALUE_COUNT
 };
 
@@ -414,6 +416,7 @@ enum WorldIntConfigs
     CONFIG_CRITICAL_ZONES_DIFF,
     CONFIG_MAX_POSSIBLE_VISIBILITY_RANGE,
     CONFIG_HANDLE_VISIBILITY_TIMER,
+    CONFIG_MAP_REGION_MIN_PLAYERS,
     INT_CONFIG_VALUE_COUNT
 };
 
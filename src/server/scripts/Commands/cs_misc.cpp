@@ -1796,6 +1796,9 @@ public:
 
         handler->PSendSysMessage(LANG_PINFO_ACCOUNT, (target ? "" : handler->GetTrinityString(LANG_OFFLINE)), nameLink.c_str(), GUID_LOPART(targetGuid), userName.c_str(), accId, eMail.c_str(), security, lastIp.c_str(), lastLogin.c_str(), latency);
 
+        if (target)
+            handler->PSendSysMessage("Send queue: " SIZEFMTD " bytes pending, peak " SIZEFMTD " bytes", target->GetSession()->GetQueuedOutput(), target->GetSession()->GetPeakQueuedOutput());
+
         std::string bannedby = "unknown";
         std::string banreason = "";
 
@@ -27,6 +27,7 @@ EndScriptData */
 #include "SystemConfig.h"
 #include "Config.h"
 #include "ObjectAccessor.h"
+#include "SendQueue.h"
 
 class server_commandscript : public CommandScript
 {
@@ -102,6 +103,17 @@ public:
         return true;
     }
 
+    template <class T>
+    static void SendConnectionAcquireStats(ChatHandler* handler, char const* name, DatabaseWorkerPool<T>& pool)
+    {
+        uint64 counts[ACQUIRE_WAIT_MAX + 1];
+        uint64 totalWaitUs;
+        pool.GetAcquireStats(counts, totalWaitUs);
+        handler->PSendSysMessage("%s sync connections: " UI64FMTD " free, waited " UI64FMTD " <100us, " UI64FMTD " <1ms, " UI64FMTD " <10ms, "
+            UI64FMTD " <100ms, " UI64FMTD " longer (" UI64FMTD " ms total)", name, counts[ACQUIRE_IMMEDIATE], counts[ACQUIRE_WAIT_100US],
+            counts[ACQUIRE_WAIT_1MS], counts[ACQUIRE_WAIT_10MS], counts[ACQUIRE_WAIT_100MS], counts[ACQUIRE_WAIT_MAX], totalWaitUs / 1000);
+    }
+
     static bool HandleServerInfoCommand(ChatHandler* handler, char const* /*args*/)
     {
         uint32 playersNum           = sWorld->GetPlayerCount();
@@ -117,6 +129,26 @@ public:
         handler->PSendSysMessage(LANG_CONNECTED_USERS, activeClientsNum, maxActiveClientsNum, queuedClientsNum, maxQueuedClientsNum);
         handler->PSendSysMessage(LANG_UPTIME, uptime.c_str());
         handler->PSendSysMessage("Server delay: %u ms", updateTime);
+
+        ValuesUpdateStats const valuesUpdates = sObjectAccessor->GetValuesUpdateStats();
+        handler->PSendSysMessage("Values updates: " UI64FMTD " objects, " UI64FMTD " blocks, " UI64FMTD " packets (" UI64FMTD " bytes)",
+            valuesUpdates.objects, valuesUpdates.blocks, valuesUpdates.packets, valuesUpdates.bytes);
+        Map::CellVisitStats const cellVisits = Map::GetCellVisitStats();
+        handler->PSendSysMessage("Cell visits: " UI64FMTD " visited, " UI64FMTD " skipped as empty",
+            cellVisits.visitedCells, cellVisits.skippedCells);
+        Map::LineOfSightStats const lineOfSight = Map::GetLineOfSightStats();
+        handler->PSendSysMessage("Line of sight: " UI64FMTD " lookups, " UI64FMTD " cached",
+            lineOfSight.lookups, lineOfSight.hits);
+        handler->PSendSysMessage("Send slabs: %u allocated, %u pooled", sSendSlabPool->GetAllocatedCount(), sSendSlabPool->GetPooledCount());
+        Player::SaveStats const saves = Player::GetSaveStats();
+        handler->PSendSysMessage("Player saves: " UI64FMTD ", " UI64FMTD " statements written, " UI64FMTD " unchanged skipped (" UI64FMTD " KB)",
+            saves.saves, saves.statementsWritten, saves.statementsSkipped, saves.bytesSkipped / 1024);
+        PathCorridorCache::Stats const corridors = PathCorridorCache::GetStats();
+        handler->PSendSysMessage("Path corridors: " UI64FMTD " lookups, " UI64FMTD " hits, " UI64FMTD " shared tail hits",
+            corridors.lookups, corridors.hits, corridors.tailHits);
+        SendConnectionAcquireStats(handler, "Character DB", CharacterDatabase);
+        SendConnectionAcquireStats(handler, "World DB", WorldDatabase);
+        SendConnectionAcquireStats(handler, "Login DB", LoginDatabase);
         // Can't use sWorld->ShutdownMsg here in case of console command
         if (sWorld->IsShuttingDown())
             handler->PSendSysMessage(LANG_SHUTDOWN_TIMELEFT, secsToTimeString(sWorld->GetShutDownTimeLeft()).c_str());
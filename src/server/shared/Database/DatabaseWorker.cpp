@@ -21,6 +21,9 @@
 #include "MySQLConnection.h"
 #include "MySQLThreading.h"
 
+//! Upper bound of statements committed together, keeps row locks short
+#define MAX_BATCH_SIZE 64
+
 DatabaseWorker::DatabaseWorker(ACE_Activation_Queue* new_queue, MySQLConnection* con) :
 m_queue(new_queue),
 m_conn(con)
@@ -34,18 +37,80 @@ int DatabaseWorker::svc()
     if (!m_queue)
         return -1;
 
-    SQLOperation *request = NULL;
-    while (1)
+    SQLOperation *request = (SQLOperation*)(m_queue->dequeue());
+    while (request)
     {
-        request = (SQLOperation*)(m_queue->dequeue());
-        if (!request)
-            break;
-
         request->SetConnection(m_conn);
-        request->call();
 
+        if (request->GetBatchSize())
+        {
+            SQLOperation* next = CollectBatch(request);
+            ExecuteBatch();
+
+            request = next ? next : (SQLOperation*)(m_queue->dequeue());
+            continue;
+        }
+
+        request->call();
         delete request;
+
+        request = (SQLOperation*)(m_queue->dequeue());
     }
 
     return 0;
 }
+
+//! Takes the already queued one-way executes and transactions following request without waiting.
+//! Returns the first queued operation that doesn't belong to the batch, if any.
+SQLOperation* DatabaseWorker::CollectBatch(SQLOperation* request)
+{
+    uint32 statements = request->GetBatchSize();
+    m_batch.push_back(request);
+
+    while (statements < MAX_BATCH_SIZE)
+    {
+        SQLOperation* next = (SQLOperation*)(m_queue->dequeue(const_cast<ACE_Time_Value*>(&ACE_Time_Value::zero)));
+        if (!next)
+            break;
+
+        next->SetConnection(m_conn);
+        uint32 size = next->GetBatchSize();
+        if (!size || statements + size > MAX_BATCH_SIZE)
+            return next;
+
+        statements += size;
+        m_batch.push_back(next);
+    }
+
+    return NULL;
+}
+
+//! Commits the whole batch at once instead of one commit per operation. If any of them fails
+//! the batch is rolled back and replayed one by one, so a bad row doesn't take the others with it.
+void DatabaseWorker::ExecuteBatch()
+{
+    bool executed = false;
+    if (m_batch.size() > 1)
+    {
+        m_conn->BeginTransaction();
+
+        executed = true;
+        for (std::vector<SQLOperation*>::const_iterator itr = m_batch.begin(); itr != m_batch.end() && executed; ++itr)
+            executed = (*itr)->ExecuteBatched();
+
+        if (executed)
+            m_conn->CommitTransaction();
+        else
+            m_conn->RollbackTransaction();
+    }
+
+    for (std::vector<SQLOperation*>::const_iterator itr = m_batch.begin(); itr != m_batch.end(); ++itr)
+    {
+        if (!executed)
+            (*itr)->call();
+
+        delete *itr;
+    }
+
+    m_batch.clear();
+}
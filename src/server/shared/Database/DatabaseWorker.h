@@ -21,7 +21,10 @@
 #include <ace/Task.h>
 #include <ace/Activation_Queue.h>
 
+#include <vector>
+
 class MySQLConnection;
+class SQLOperation;
 
 class DatabaseWorker : protected ACE_Task_Base
 {
@@ -34,8 +37,13 @@ class DatabaseWorker : protected ACE_Task_Base
 
     private:
         DatabaseWorker() : ACE_Task_Base() {}
+
+        SQLOperation* CollectBatch(SQLOperation* request);
+        void ExecuteBatch();
+
         ACE_Activation_Queue* m_queue;
         MySQLConnection* m_conn;
+        std::vector<SQLOperation*> m_batch;                 //! Consecutive one-way executes and transactions.
 };
 
 #endif
@@ -27,10 +27,16 @@
 #include "DatabaseWorker.h"
 #include "PreparedStatement.h"
 #include "Log.h"
+#include "Errors.h"
 #include "QueryResult.h"
 #include "QueryHolder.h"
 #include "AdhocStatement.h"
 #include <mysqld_error.h>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <limits>
+#include <mutex>
 
 class PingOperation : public SQLOperation
 {
@@ -42,16 +48,61 @@ class PingOperation : public SQLOperation
     }
 };
 
+//! Marks the current thread as one that must not block on the database (map updates) for
+//! the lifetime of the object. Synchronous queries issued from such a thread assert.
+class SyncQueryCheck
+{
+    public:
+        explicit SyncQueryCheck(bool enable) : _previous(Forbidden())
+        {
+            if (enable)
+                Forbidden() = true;
+        }
+
+        ~SyncQueryCheck()
+        {
+            Forbidden() = _previous;
+        }
+
+        static bool& Forbidden()
+        {
+            static thread_local bool forbidden = false;
+            return forbidden;
+        }
+
+    private:
+        SyncQueryCheck(SyncQueryCheck const&);
+        SyncQueryCheck& operator=(SyncQueryCheck const&);
+
+        bool _previous;
+};
+
+//! Buckets of the time spent waiting for a free synchronous connection.
+enum ConnectionAcquireBucket
+{
+    ACQUIRE_IMMEDIATE,                                      // a connection was free
+    ACQUIRE_WAIT_100US,                                     // waited less than 100us
+    ACQUIRE_WAIT_1MS,
+    ACQUIRE_WAIT_10MS,
+    ACQUIRE_WAIT_100MS,
+    ACQUIRE_WAIT_MAX                                        // waited 100ms or more
+};
+
 template <class T>
 class DatabaseWorkerPool
 {
     public:
+        //! Order key of operations that don't need to run after any other.
+        enum { UNORDERED = 0xFFFFFFFF };
+
         /* Activity state */
         DatabaseWorkerPool() :
-        _queue(new ACE_Activation_Queue())
+        _waiters(0), _nextConnection(0), _connectionAffinity(false), _acquireWaitTime(0)
         {
             memset(_connectionCount, 0, sizeof(_connectionCount));
             _connections.resize(IDX_SIZE);
+            for (uint8 i = 0; i <= ACQUIRE_WAIT_MAX; ++i)
+                _acquireStats[i] = 0;
 
             WPFatal (mysql_thread_safe(), "Used MySQL library isn't thread-safe.");
         }
@@ -68,11 +119,13 @@ class DatabaseWorkerPool
             TC_LOG_INFO("sql.update", "Opening DatabasePool '%s'. Asynchronous connections: %u, synchronous connections: %u.",
                 GetDatabaseName(), async_threads, synch_threads);
 
-            //! Open asynchronous connections (delayed operations)
+            //! Open asynchronous connections (delayed operations), each one consuming its own queue
             _connections[IDX_ASYNC].resize(async_threads);
+            _queues.resize(async_threads);
             for (uint8 i = 0; i < async_threads; ++i)
             {
-                T* t = new T(_queue, _connectionInfo);
+                _queues[i] = new ACE_Activation_Queue();
+                T* t = new T(_queues[i], _connectionInfo);
                 res &= t->Open();
                 _connections[IDX_ASYNC][i] = t;
                 ++_connectionCount[IDX_ASYNC];
@@ -104,7 +157,8 @@ class DatabaseWorkerPool
             //! Shuts down delaythreads for this connection pool by underlying deactivate().
             //! The next dequeue attempt in the worker thread tasks will result in an error,
             //! ultimately ending the worker thread task.
-            _queue->queue()->close();
+            for (size_t i = 0; i < _queues.size(); ++i)
+                _queues[i]->queue()->close();
 
             for (uint8 i = 0; i < _connectionCount[IDX_ASYNC]; ++i)
             {
@@ -125,8 +179,10 @@ class DatabaseWorkerPool
             for (uint8 i = 0; i < _connectionCount[IDX_SYNCH]; ++i)
                 _connections[IDX_SYNCH][i]->Close();
 
-            //! Deletes the ACE_Activation_Queue object and its underlying ACE_Message_Queue
-            delete _queue;
+            //! Deletes the ACE_Activation_Queue objects and their underlying ACE_Message_Queue
+            for (size_t i = 0; i < _queues.size(); ++i)
+                delete _queues[i];
+            _queues.clear();
 
             TC_LOG_INFO("sql.update", "All connections on DatabasePool '%s' closed.", GetDatabaseName());
         }
@@ -163,11 +219,12 @@ class DatabaseWorkerPool
         }
 
         //! Enqueues a one-way SQL operation in prepared statement format that will be executed asynchronously.
+        //! Operations sharing an order key (e.g. a character guid) are executed in the order they were enqueued.
         //! Statement must be prepared with CONNECTION_ASYNC flag.
-        void Execute(PreparedStatement* stmt)
+        void Execute(PreparedStatement* stmt, uint32 orderKey = UNORDERED)
         {
             PreparedStatementTask* task = new PreparedStatementTask(stmt);
-            Enqueue(task);
+            Enqueue(task, orderKey);
         }
 
         /**
@@ -183,7 +240,7 @@ class DatabaseWorkerPool
 
             T* t = GetFreeConnection();
             t->Execute(sql);
-            t->Unlock();
+            ReleaseConnection(t);
         }
 
         //! Directly executes a one-way SQL operation in string format -with variable args-, that will block the calling thread until finished.
@@ -208,7 +265,7 @@ class DatabaseWorkerPool
         {
             T* t = GetFreeConnection();
             t->Execute(stmt);
-            t->Unlock();
+            ReleaseConnection(t);
         }
 
         /**
@@ -219,11 +276,13 @@ class DatabaseWorkerPool
         //! Returns reference counted auto pointer, no need for manual memory management in upper level code.
         QueryResult Query(const char* sql, MySQLConnection* conn = NULL)
         {
+            ASSERT(!SyncQueryCheck::Forbidden(), "Synchronous query issued from a map thread, use an async query instead: %s", sql);
+
             if (!conn)
                 conn = GetFreeConnection();
 
             ResultSet* result = conn->Query(sql);
-            conn->Unlock();
+            ReleaseConnection(conn);
             if (!result || !result->GetRowCount())
             {
                 delete result;
@@ -270,9 +329,11 @@ class DatabaseWorkerPool
         //! Statement must be prepared with CONNECTION_SYNCH flag.
         PreparedQueryResult Query(PreparedStatement* stmt)
         {
+            ASSERT(!SyncQueryCheck::Forbidden(), "Synchronous query issued from a map thread, use an async query instead: statement %u", stmt->GetIndex());
+
             T* t = GetFreeConnection();
             PreparedResultSet* ret = t->Query(stmt);
-            t->Unlock();
+            ReleaseConnection(t);
 
             //! Delete proxy-class. Not needed anymore
             delete stmt;
@@ -328,11 +389,11 @@ class DatabaseWorkerPool
         //! return object as soon as the query is executed.
         //! The return value is then processed in ProcessQueryCallback methods.
         //! Any prepared statements added to this holder need to be prepared with the CONNECTION_ASYNC flag.
-        QueryResultHolderFuture DelayQueryHolder(SQLQueryHolder* holder)
+        QueryResultHolderFuture DelayQueryHolder(SQLQueryHolder* holder, uint32 orderKey = UNORDERED)
         {
             QueryResultHolderFuture res;
             SQLQueryHolderTask* task = new SQLQueryHolderTask(holder, res);
-            Enqueue(task);
+            Enqueue(task, orderKey);
             return res;     //! Fool compiler, has no use yet
         }
 
@@ -348,7 +409,8 @@ class DatabaseWorkerPool
 
         //! Enqueues a collection of one-way SQL operations (can be both adhoc and prepared). The order in which these operations
         //! were appended to the transaction will be respected during execution.
-        void CommitTransaction(SQLTransaction transaction)
+        //! Operations sharing an order key (e.g. a character guid) are executed in the order they were enqueued.
+        void CommitTransaction(SQLTransaction transaction, uint32 orderKey = UNORDERED)
         {
             #ifdef TRINITY_DEBUG
             //! Only analyze transaction weaknesses in Debug mode.
@@ -367,7 +429,7 @@ class DatabaseWorkerPool
             }
             #endif // TRINITY_DEBUG
 
-            Enqueue(new TransactionTask(transaction));
+            Enqueue(new TransactionTask(transaction), orderKey);
         }
 
         //! Directly executes a collection of one-way SQL operations (can be both adhoc and prepared). The order in which these operations
@@ -378,7 +440,7 @@ class DatabaseWorkerPool
             int errorCode = con->ExecuteTransaction(transaction);
             if (!errorCode)
             {
-                con->Unlock();      // OK, operation succesful
+                ReleaseConnection(con);     // OK, operation succesful
                 return;
             }
 
@@ -390,14 +452,20 @@ class DatabaseWorkerPool
                 for (uint8 i = 0; i < loopBreaker; ++i)
                 {
                     if (!con->ExecuteTransaction(transaction))
+                    {
+                        errorCode = 0;
                         break;
+                    }
                 }
             }
 
+            if (errorCode)
+                transaction->MarkFailed();
+
             //! Clean up now.
             transaction->Cleanup();
 
-            con->Unlock();
+            ReleaseConnection(con);
         }
 
         //! Method used to execute prepared statements in a diverse context.
@@ -454,15 +522,13 @@ class DatabaseWorkerPool
                 if (t->LockIfReady())
                 {
                     t->Ping();
-                    t->Unlock();
+                    ReleaseConnection(t);
                 }
             }
 
-            //! Assuming all worker threads are free, every worker thread will receive 1 ping operation request
-            //! If one or more worker threads are busy, the ping operations will not be split evenly, but this doesn't matter
-            //! as the sole purpose is to prevent connections from idling.
-            for (size_t i = 0; i < _connections[IDX_ASYNC].size(); ++i)
-                Enqueue(new PingOperation);
+            //! Every worker thread will receive 1 ping operation request
+            for (size_t i = 0; i < _queues.size(); ++i)
+                Enqueue(new PingOperation, i);
         }
 
         char const* GetDatabaseName() const
@@ -470,6 +536,21 @@ class DatabaseWorkerPool
             return _connectionInfo.database.c_str();
         }
 
+        //! Makes each thread try the synchronous connection it used last before the others,
+        //! so threads issuing many synchronous queries stop competing for the same connections.
+        void SetConnectionAffinity(bool enable)
+        {
+            _connectionAffinity = enable;
+        }
+
+        //! Number of synchronous connection acquisitions per bucket of time waited for a free connection.
+        void GetAcquireStats(uint64 (&counts)[ACQUIRE_WAIT_MAX + 1], uint64& totalWaitUs) const
+        {
+            for (uint8 i = 0; i <= ACQUIRE_WAIT_MAX; ++i)
+                counts[i] = _acquireStats[i];
+            totalWaitUs = _acquireWaitTime;
+        }
+
     private:
         unsigned long EscapeString(char *to, const char *from, unsigned long length)
         {
@@ -479,30 +560,90 @@ class DatabaseWorkerPool
             return mysql_real_escape_string(_connections[IDX_SYNCH][0]->GetHandle(), to, from, length);
         }
 
-        void Enqueue(SQLOperation* op)
+        //! Operations with the same order key go to the same asynchronous connection and are executed
+        //! in the order they were enqueued. Operations without a key all share the first connection's
+        //! queue, so they run in the order they were enqueued as well.
+        void Enqueue(SQLOperation* op, uint32 orderKey = UNORDERED)
         {
-            _queue->enqueue(op);
+            _queues[orderKey == UNORDERED ? 0 : orderKey % _queues.size()]->enqueue(op);
         }
 
-        //! Gets a free connection in the synchronous connection pool.
-        //! Caller MUST call t->Unlock() after touching the MySQL context to prevent deadlocks.
-        T* GetFreeConnection()
+        //! Tries every synchronous connection once, starting at the calling thread's preferred one.
+        T* TryLockConnection()
         {
-            uint8 i = 0;
-            size_t num_cons = _connectionCount[IDX_SYNCH];
-            //! Block forever until a connection is free
-            for (;;)
+            uint32 num_cons = _connectionCount[IDX_SYNCH];
+            uint32& preferred = PreferredConnection();
+            uint32 start = _connectionAffinity && preferred < num_cons ? preferred : _nextConnection++ % num_cons;
+
+            for (uint32 i = 0; i < num_cons; ++i)
             {
-                T* t = _connections[IDX_SYNCH][++i % num_cons];
-                //! Must be matched with t->Unlock() or you will get deadlocks
+                uint32 index = (start + i) % num_cons;
+                T* t = _connections[IDX_SYNCH][index];
+                //! Must be matched with ReleaseConnection(t) or you will get deadlocks
                 if (t->LockIfReady())
+                {
+                    preferred = index;
                     return t;
+                }
             }
 
-            //! This will be called when Celine Dion learns to sing
             return NULL;
         }
 
+        //! Gets a free connection in the synchronous connection pool, sleeping until one is released if all are busy.
+        //! Caller MUST call ReleaseConnection(t) after touching the MySQL context to prevent deadlocks.
+        T* GetFreeConnection()
+        {
+            if (T* t = TryLockConnection())
+            {
+                ++_acquireStats[ACQUIRE_IMMEDIATE];
+                return t;
+            }
+
+            std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+            T* t;
+            {
+                std::unique_lock<std::mutex> lock(_waitLock);
+                ++_waiters;
+                std::atomic_thread_fence(std::memory_order_seq_cst);
+                while (!(t = TryLockConnection()))
+                    _waitCondition.wait(lock);
+                --_waiters;
+            }
+
+            uint64 waited = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+            uint8 bucket = ACQUIRE_WAIT_100US;
+            for (uint64 limit = 100; bucket < ACQUIRE_WAIT_MAX && waited >= limit; limit *= 10)
+                ++bucket;
+
+            ++_acquireStats[bucket];
+            _acquireWaitTime += waited;
+            return t;
+        }
+
+        //! Unlocks a connection taken with GetFreeConnection and wakes up a thread waiting for one.
+        void ReleaseConnection(MySQLConnection* conn)
+        {
+            conn->Unlock();
+
+            //! Pairs with the increment of _waiters: either the waiter sees the connection
+            //! unlocked or we see the waiter, and take the lock so the wakeup can't be lost
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (_waiters.load(std::memory_order_relaxed))
+            {
+                { std::lock_guard<std::mutex> lock(_waitLock); }
+                _waitCondition.notify_one();
+            }
+        }
+
+        //! Index of the connection the calling thread used last in this pool.
+        static uint32& PreferredConnection()
+        {
+            static thread_local uint32 preferred = std::numeric_limits<uint32>::max();
+            return preferred;
+        }
+
     private:
         enum _internalIndex
         {
@@ -511,10 +652,20 @@ class DatabaseWorkerPool
             IDX_SIZE,
         };
 
-        ACE_Activation_Queue*           _queue;             //! Queue shared by async worker threads.
+        std::vector<ACE_Activation_Queue*> _queues;         //! One queue per async worker thread.
         std::vector< std::vector<T*> >  _connections;
         uint32                          _connectionCount[2];       //! Counter of MySQL connections;
         MySQLConnectionInfo             _connectionInfo;
+
+        //! Threads sleeping in GetFreeConnection until a synchronous connection is released.
+        std::mutex                      _waitLock;
+        std::condition_variable         _waitCondition;
+        std::atomic<uint32>             _waiters;
+        std::atomic<uint32>             _nextConnection;
+        bool                            _connectionAffinity;
+
+        std::atomic<uint64>             _acquireStats[ACQUIRE_WAIT_MAX + 1];
+        std::atomic<uint64>             _acquireWaitTime;
 };
 
 #endif
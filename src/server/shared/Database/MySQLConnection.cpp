@@ -379,6 +379,26 @@ int MySQLConnection::ExecuteTransaction(SQLTransaction& transaction)
 
     BeginTransaction();
 
+    if (!ExecuteInTransaction(transaction))
+    {
+        int errorCode = GetLastError();
+        RollbackTransaction();
+        return errorCode;
+    }
+
+    // we might encounter errors during certain queries, and depending on the kind of error
+    // we might want to restart the transaction. So to prevent data loss, we only clean up when it's all done.
+    // This is done in calling functions DatabaseWorkerPool<T>::DirectCommitTransaction and TransactionTask::Execute,
+    // and not while iterating over every element.
+
+    CommitTransaction();
+    return 0;
+}
+
+bool MySQLConnection::ExecuteInTransaction(SQLTransaction& transaction)
+{
+    std::list<SQLElementData> const& queries = transaction->m_queries;
+
     std::list<SQLElementData>::const_iterator itr;
     for (itr = queries.begin(); itr != queries.end(); ++itr)
     {
@@ -392,9 +412,7 @@ int MySQLConnection::ExecuteTransaction(SQLTransaction& transaction)
                 if (!Execute(stmt))
                 {
                     TC_LOG_WARN("sql", "Transaction aborted. %u queries not executed.", (uint32)queries.size());
-                    int errorCode = GetLastError();
-                    RollbackTransaction();
-                    return errorCode;
+                    return false;
                 }
             }
             break;
@@ -405,22 +423,14 @@ int MySQLConnection::ExecuteTransaction(SQLTransaction& transaction)
                 if (!Execute(sql))
                 {
                     TC_LOG_WARN("sql", "Transaction aborted. %u queries not executed.", (uint32)queries.size());
-                    int errorCode = GetLastError();
-                    RollbackTransaction();
-                    return errorCode;
+                    return false;
                 }
             }
             break;
         }
     }
 
-    // we might encounter errors during certain queries, and depending on the kind of error
-    // we might want to restart the transaction. So to prevent data loss, we only clean up when it's all done.
-    // This is done in calling functions DatabaseWorkerPool<T>::DirectCommitTransaction and TransactionTask::Execute,
-    // and not while iterating over every element.
-
-    CommitTransaction();
-    return 0;
+    return true;
 }
 
 MySQLPreparedStatement* MySQLConnection::GetPreparedStatement(uint32 index)
@@ -111,6 +111,8 @@ class MySQLConnection
         void RollbackTransaction();
         void CommitTransaction();
         int ExecuteTransaction(SQLTransaction& transaction);
+        //! Executes the queries of transaction in the transaction already begun on this connection.
+        bool ExecuteInTransaction(SQLTransaction& transaction);
 
         operator bool () const { return m_Mysql != NULL; }
         void Ping() { if (m_Mysql) mysql_ping(m_Mysql); }
@@ -471,3 +471,8 @@ bool PreparedStatementTask::Execute()
 
     return m_conn->Execute(m_stmt);
 }
+
+bool PreparedStatementTask::ExecuteBatched()
+{
+    return m_conn->Execute(m_stmt);
+}
@@ -72,6 +72,7 @@ class PreparedStatement
     friend class PreparedStatementTask;
     friend class MySQLPreparedStatement;
     friend class MySQLConnection;
+    friend class Transaction;
 
     public:
         explicit PreparedStatement(uint32 index, uint8 capacity);
@@ -92,6 +93,8 @@ class PreparedStatement
         void setBinary(const uint8 index, const std::vector<uint8>& value);
         void setNull(const uint8 index);
 
+        uint32 GetIndex() const { return m_index; }
+
     protected:
         //- Copy the parameters to a real MySQLPreparedStatement
         void BindParameters(MySQLPreparedStatement* m_stmt) const;
@@ -156,6 +159,8 @@ class PreparedStatementTask : public SQLOperation
         ~PreparedStatementTask();
 
         bool Execute();
+        uint32 GetBatchSize() const { return m_has_result ? 0 : 1; }
+        bool ExecuteBatched();
 
     protected:
         PreparedStatement* m_stmt;
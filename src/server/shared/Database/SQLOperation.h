@@ -68,6 +68,12 @@ class SQLOperation : public ACE_Method_Request
         virtual bool Execute() = 0;
         virtual void SetConnection(MySQLConnection* con) { m_conn = con; }
 
+        //! Number of statements of a one-way operation the worker may commit together with the
+        //! operations queued after it, 0 if the operation can't be batched.
+        virtual uint32 GetBatchSize() const { return 0; }
+        //! Executes a batchable operation inside the transaction the worker opened for the batch.
+        virtual bool ExecuteBatched() { return false; }
+
         MySQLConnection* m_conn;
 };
 
@@ -48,6 +48,65 @@ void Transaction::Append(PreparedStatement* stmt)
     m_queries.push_back(data);
 }
 
+namespace
+{
+    // FNV-1a
+    uint64 HashBytes(uint64 hash, void const* data, size_t size)
+    {
+        uint8 const* bytes = static_cast<uint8 const*>(data);
+        for (size_t i = 0; i < size; ++i)
+            hash = (hash ^ bytes[i]) * UI64LIT(1099511628211);
+        return hash;
+    }
+}
+
+uint64 Transaction::GetDigest(size_t& dataSize) const
+{
+    uint64 hash = UI64LIT(14695981039346656037);
+    dataSize = 0;
+
+    for (std::list<SQLElementData>::const_iterator itr = m_queries.begin(); itr != m_queries.end(); ++itr)
+    {
+        switch (itr->type)
+        {
+            case SQL_ELEMENT_PREPARED:
+            {
+                PreparedStatement const* stmt = itr->element.stmt;
+                hash = HashBytes(hash, &stmt->m_index, sizeof(stmt->m_index));
+                for (std::vector<PreparedStatementData>::const_iterator data = stmt->statement_data.begin(); data != stmt->statement_data.end(); ++data)
+                {
+                    hash = HashBytes(hash, &data->type, sizeof(data->type));
+                    if (data->type == TYPE_STRING || data->type == TYPE_BINARY)
+                    {
+                        hash = HashBytes(hash, data->binary.data(), data->binary.size());
+                        dataSize += data->binary.size();
+                    }
+                    else
+                    {
+                        hash = HashBytes(hash, &data->data, sizeof(data->data));
+                        dataSize += sizeof(data->data);
+                    }
+                }
+                break;
+            }
+            case SQL_ELEMENT_RAW:
+            {
+                size_t length = strlen(itr->element.query);
+                hash = HashBytes(hash, itr->element.query, length);
+                dataSize += length;
+                break;
+            }
+        }
+    }
+
+    return hash;
+}
+
+void Transaction::MoveTo(Transaction& other)
+{
+    other.m_queries.splice(other.m_queries.end(), m_queries);
+}
+
 void Transaction::Cleanup()
 {
     // This might be called by explicit calls to Cleanup or by the auto-destructor
@@ -88,7 +147,14 @@ bool TransactionTask::Execute()
     }
 
     // Clean up now.
+    m_trans->MarkFailed();
     m_trans->Cleanup();
 
     return false;
 }
+
+bool TransactionTask::ExecuteBatched()
+{
+    // a failed batch is replayed through Execute, which retries and cleans up
+    return m_conn->ExecuteInTransaction(m_trans);
+}
@@ -19,6 +19,8 @@
 #define _TRANSACTION_H
 
 #include "SQLOperation.h"
+#include <atomic>
+#include <memory>
 
 //- Forward declare (don't include header to prevent circular includes)
 class PreparedStatement;
@@ -43,12 +45,24 @@ class Transaction
 
         size_t GetSize() const { return m_queries.size(); }
 
+        //! Hash of the queries with their parameters, equal digests write the same rows.
+        //! dataSize receives the size of the queries' parameters.
+        uint64 GetDigest(size_t& dataSize) const;
+
+        //! Moves the queries to the end of another transaction.
+        void MoveTo(Transaction& other);
+
+        //! flag is set if the transaction fails to commit, several transactions may share one.
+        void SetFailureFlag(std::shared_ptr<std::atomic<bool>> flag) { _failureFlag = std::move(flag); }
+
     protected:
         void Cleanup();
+        void MarkFailed() { if (_failureFlag) _failureFlag->store(true); }
         std::list<SQLElementData> m_queries;
 
     private:
         bool _cleanedUp;
+        std::shared_ptr<std::atomic<bool>> _failureFlag;
 
 };
 typedef Trinity::AutoPtr<Transaction, ACE_Thread_Mutex> SQLTransaction;
@@ -65,6 +79,8 @@ class TransactionTask : public SQLOperation
 
     protected:
         bool Execute();
+        uint32 GetBatchSize() const { return uint32(m_trans->GetSize()); }
+        bool ExecuteBatched();
 
         SQLTransaction m_trans;
 };
@@ -0,0 +1,127 @@
+/*
+ * Copyright (C) 2008-2013 TrinityCore <http://www.trinitycore.org/>
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; either version 2 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TRINITY_POSITIONINDEX_H
+#define TRINITY_POSITIONINDEX_H
+
+#include "Define.h"
+
+#include <vector>
+#include <cstddef>
+
+namespace Trinity {
+
+/*
+ * @class PositionIndex keeps the positions of the objects of a container
+ * list as separate arrays, in the same order as the list. Searches filter
+ * candidates on these arrays instead of loading every object.
+ */
+class PositionIndex final
+{
+    static std::size_t const BlockSize = 64;
+
+public:
+    // sphere around (x, y, z), an entry matches if it is within radius plus its own size
+    struct SearchArea
+    {
+        float x;
+        float y;
+        float z;
+        float radius;
+        bool is3D;
+    };
+
+    std::size_t size() const
+    {
+        return x_.size();
+    }
+
+    void add(float x, float y, float z, float objectSize, uint32 phaseMask)
+    {
+        x_.push_back(x);
+        y_.push_back(y);
+        z_.push_back(z);
+        size_.push_back(objectSize);
+        phaseMask_.push_back(phaseMask);
+    }
+
+    void set(std::size_t index, float x, float y, float z, float objectSize, uint32 phaseMask)
+    {
+        x_[index] = x;
+        y_[index] = y;
+        z_[index] = z;
+        size_[index] = objectSize;
+        phaseMask_[index] = phaseMask;
+    }
+
+    // moves the last entry to index, like the swap-and-pop of the object list
+    void remove(std::size_t index)
+    {
+        std::size_t const last = x_.size() - 1;
+        if (index != last)
+            set(index, x_[last], y_[last], z_[last], size_[last], phaseMask_[last]);
+
+        x_.pop_back();
+        y_.pop_back();
+        z_.pop_back();
+        size_.pop_back();
+        phaseMask_.pop_back();
+    }
+
+    // Calls func(index) for the entries sharing a phase with phaseMask and inside area (if any),
+    // in list order, until func returns false.
+    template <typename Function>
+    void select(uint32 phaseMask, SearchArea const *area, Function &&func) const
+    {
+        std::size_t const count = x_.size();
+        for (std::size_t base = 0; base < count; base += BlockSize) {
+            std::size_t const end = base + BlockSize < count ? base + BlockSize : count;
+
+            // branch free so the compiler can vectorize it
+            uint64 matches = 0;
+            if (area) {
+                for (std::size_t i = base; i < end; ++i) {
+                    float const dx = x_[i] - area->x;
+                    float const dy = y_[i] - area->y;
+                    float const dz = area->is3D ? z_[i] - area->z : 0.0f;
+                    float const maxDist = area->radius + size_[i];
+                    bool const match = (phaseMask_[i] & phaseMask) != 0
+                        && dx * dx + dy * dy + dz * dz <= maxDist * maxDist;
+                    matches |= uint64(match) << (i - base);
+                }
+            } else {
+                for (std::size_t i = base; i < end; ++i)
+                    matches |= uint64((phaseMask_[i] & phaseMask) != 0) << (i - base);
+            }
+
+            for (std::size_t i = base; matches; ++i, matches >>= 1)
+                if ((matches & 1) && !func(i))
+                    return;
+        }
+    }
+
+private:
+    std::vector<float> x_;
+    std::vector<float> y_;
+    std::vector<float> z_;
+    std::vector<float> size_;
+    std::vector<uint32> phaseMask_;
+};
+
+} // namespace Trinity
+
+#endif
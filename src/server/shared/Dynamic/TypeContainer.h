@@ -26,6 +26,7 @@
 
 #include "Define.h"
 #include "Dynamic/TypeList.h"
+#include "Dynamic/PositionIndex.h"
 
 #include <type_traits>
 #include <vector>
@@ -43,6 +44,7 @@ template <typename T>
 struct ContainerMapList
 {
     std::vector<T*> elements;
+    PositionIndex positions;
 };
 
 template <>
@@ -95,6 +97,20 @@ mapForType(ContainerMapList<TypeList<Head, Tail>> &m)
     return Trinity::Detail::mapForType<SpecificType>(m.tail);
 }
 
+// position of SpecificType in a type list, used as its bit in occupancy masks
+template <typename SpecificType, typename List>
+struct TypeIndex;
+
+template <typename SpecificType, typename Tail>
+struct TypeIndex<SpecificType, TypeList<SpecificType, Tail>>
+    : std::integral_constant<std::size_t, 0>
+{ };
+
+template <typename SpecificType, typename Head, typename Tail>
+struct TypeIndex<SpecificType, TypeList<Head, Tail>>
+    : std::integral_constant<std::size_t, 1 + TypeIndex<SpecificType, Tail>::value>
+{ };
+
 } // namespace Detail
 
 /*
@@ -118,11 +134,14 @@ public:
         return m.elements.size();
     }
 
+    // occupancy gets the bit of SpecificType set while its list is not empty
     template <typename SpecificType>
-    void insert(SpecificType *obj)
+    void insert(SpecificType *obj, uint8 &occupancy)
     {
+        static_assert(Detail::TypeIndex<SpecificType, ObjectTypes>::value < 8, "too many types for an uint8 occupancy mask");
+
         auto &m = Detail::mapForType<SpecificType>(m_objectMap);
-        obj->AddToGrid(m.elements);
+        obj->AddToGrid(m.elements, m.positions, occupancy, uint8(1 << Detail::TypeIndex<SpecificType, ObjectTypes>::value));
     }
 
     ObjectMap & objectMap() { return m_objectMap; }
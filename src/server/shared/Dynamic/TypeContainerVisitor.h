@@ -32,6 +32,19 @@ namespace Trinity {
 
 namespace Detail {
 
+// visitors taking the position index of the list get it, the others only the list
+template <typename Visitor, typename T>
+inline auto VisitList(Visitor &v, ContainerMapList<T> &c, int) -> decltype(v.Visit(c.elements, c.positions), void())
+{
+    v.Visit(c.elements, c.positions);
+}
+
+template <typename Visitor, typename T>
+inline void VisitList(Visitor &v, ContainerMapList<T> &c, long)
+{
+    v.Visit(c.elements);
+}
+
 // terminate condition container map list
 template <typename Visitor>
 inline void VisitorHelper(Visitor &/*v*/, ContainerMapList<TypeNull> &/*c*/) { }
@@ -39,7 +52,7 @@ inline void VisitorHelper(Visitor &/*v*/, ContainerMapList<TypeNull> &/*c*/) { }
 template <typename Visitor, typename T>
 inline void VisitorHelper(Visitor &v, ContainerMapList<T> &c)
 {
-    v.Visit(c.elements);
+    VisitList(v, c, 0);
 }
 
 // recursion container map list
@@ -57,6 +70,30 @@ inline void VisitorHelper(Visitor &v, TypeMapContainer<ObjectTypes> &c)
     VisitorHelper(v, c.objectMap());
 }
 
+// same as above, skips the lists whose bit is not set in the occupancy mask
+template <typename Visitor>
+inline void VisitorHelper(Visitor &/*v*/, ContainerMapList<TypeNull> &/*c*/, uint8 /*mask*/) { }
+
+template <typename Visitor, typename T>
+inline void VisitorHelper(Visitor &v, ContainerMapList<T> &c, uint8 mask)
+{
+    if (mask & 1)
+        VisitList(v, c, 0);
+}
+
+template <typename Visitor, typename Head, typename Tail>
+inline void VisitorHelper(Visitor &v, ContainerMapList<TypeList<Head, Tail>> &c, uint8 mask)
+{
+    VisitorHelper(v, c.head, mask);
+    VisitorHelper(v, c.tail, uint8(mask >> 1));
+}
+
+template <typename Visitor, typename ObjectTypes>
+inline void VisitorHelper(Visitor &v, TypeMapContainer<ObjectTypes> &c, uint8 mask)
+{
+    VisitorHelper(v, c.objectMap(), mask);
+}
+
 } // namespace Detail
 
 template <typename Visitor, typename TypeContainer>
@@ -72,6 +109,11 @@ public:
         Trinity::Detail::VisitorHelper(i_visitor, c);
     }
 
+    void Visit(TypeContainer &c, uint8 occupancy)
+    {
+        Trinity::Detail::VisitorHelper(i_visitor, c, occupancy);
+    }
+
 private:
     Visitor &i_visitor;
 };
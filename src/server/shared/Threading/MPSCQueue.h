@@ -0,0 +1,99 @@
+/*
+ * Copyright (C) 2008-2014 TrinityCore <http://www.trinitycore.org/>
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; either version 2 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MPSCQUEUE_H
+#define MPSCQUEUE_H
+
+#include <atomic>
+
+// Unbounded multi-producer single-consumer queue without locks (Vyukov's node based queue).
+// Any thread may Enqueue, only one thread at a time may Dequeue; T must be cheap to copy.
+template<typename T>
+class MPSCQueue
+{
+    public:
+
+        MPSCQueue() : _head(new Node(T())), _tail(_head.load(std::memory_order_relaxed))
+        {
+        }
+
+        ~MPSCQueue()
+        {
+            T output;
+            while (Dequeue(output))
+                ;
+
+            delete _tail;
+        }
+
+        MPSCQueue(MPSCQueue const&) = delete;
+        MPSCQueue& operator=(MPSCQueue const&) = delete;
+
+        void Enqueue(T input)
+        {
+            Node* node = new Node(input);
+            Node* prevHead = _head.exchange(node, std::memory_order_acq_rel);
+            prevHead->Next.store(node, std::memory_order_release);
+        }
+
+        bool Dequeue(T& result)
+        {
+            Node* tail = _tail;
+            Node* next = tail->Next.load(std::memory_order_acquire);
+            if (!next)
+                return false;
+
+            result = next->Data;
+            _tail = next;
+            delete tail;
+            return true;
+        }
+
+        //! Dequeues the oldest element only if the checker accepts it.
+        template<class Checker>
+        bool Dequeue(T& result, Checker& check)
+        {
+            Node* next = _tail->Next.load(std::memory_order_acquire);
+            if (!next || !check.Process(next->Data))
+                return false;
+
+            return Dequeue(result);
+        }
+
+        //! An element being enqueued concurrently may not be visible yet.
+        bool Empty() const
+        {
+            return _tail->Next.load(std::memory_order_acquire) == nullptr;
+        }
+
+    private:
+
+        struct Node
+        {
+            explicit Node(T data) : Data(data), Next(nullptr) { }
+
+            T Data;
+            std::atomic<Node*> Next;
+        };
+
+        // producers swap the head, the consumer owns the tail (a dummy node)
+        std::atomic<Node*> _head;
+        char _padding[64 - sizeof(std::atomic<Node*>)];
+        Node* _tail;
+};
+
+#endif
@@ -0,0 +1,89 @@
+#include "TaskGraph.hpp"
+#include "ThreadPoolMgr.hpp"
+#include "Errors.h"
+#include "Log.h"
+#include "Timer.h"
+
+#include <algorithm>
+
+namespace Trinity {
+
+TaskGraph::TaskId TaskGraph::add(std::string name, FunctorType func, std::initializer_list<TaskId> dependencies)
+{
+    TaskId const id = nodes_.size();
+
+    std::unique_ptr<Node> node(new Node);
+    node->name = std::move(name);
+    node->func = std::move(func);
+    node->dependencyCount = dependencies.size();
+    node->remaining.store(0, std::memory_order_relaxed);
+    node->duration = 0;
+
+    for (TaskId dependency : dependencies) {
+        ASSERT(dependency < id, "TaskGraph: node %s depends on unknown node " SIZEFMTD, node->name.c_str(), dependency);
+        nodes_[dependency]->dependents.push_back(id);
+    }
+
+    nodes_.push_back(std::move(node));
+    return id;
+}
+
+void TaskGraph::run()
+{
+    for (auto const &node : nodes_)
+        node->remaining.store(node->dependencyCount, std::memory_order_relaxed);
+
+    uint32 const startTime = getMSTime();
+
+    {
+        TaskGroup group;
+
+        for (auto const &node : nodes_)
+            if (node->dependencyCount == 0)
+                schedule(group, *node);
+
+        group.wait();
+    }
+
+    wallTime_ = GetMSTimeDiffToNow(startTime);
+}
+
+void TaskGraph::schedule(TaskGroup &group, Node &node)
+{
+    group.run([this, &group, &node] {
+        uint32 const startTime = getMSTime();
+        node.func();
+        node.duration = GetMSTimeDiffToNow(startTime);
+
+        // the group counts this task until it returns, dependents scheduled
+        // from here are always waited for
+        for (TaskId dependent : node.dependents) {
+            Node &next = *nodes_[dependent];
+            if (next.remaining.fetch_sub(1, std::memory_order_acq_rel) == 1)
+                schedule(group, next);
+        }
+    });
+}
+
+void TaskGraph::logReport(char const *filter) const
+{
+    std::vector<Node const *> sorted;
+    sorted.reserve(nodes_.size());
+
+    uint32 total = 0;
+    for (auto const &node : nodes_) {
+        sorted.push_back(node.get());
+        total += node->duration;
+    }
+
+    std::stable_sort(sorted.begin(), sorted.end(), [](Node const *left, Node const *right) {
+        return left->duration > right->duration;
+    });
+
+    for (Node const *node : sorted)
+        TC_LOG_INFO(filter, ">> %-32s %6u ms", node->name.c_str(), node->duration);
+
+    TC_LOG_INFO(filter, ">> " SIZEFMTD " loaders finished in %u ms (%u ms if run serially)", nodes_.size(), wallTime_, total);
+}
+
+} // namespace Trinity
@@ -0,0 +1,70 @@
+#ifndef TRINITY_SHARED_TASK_GRAPH_HPP
+#define TRINITY_SHARED_TASK_GRAPH_HPP
+
+#include <atomic>
+#include <functional>
+#include <initializer_list>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <cstddef>
+#include <cstdint>
+
+namespace Trinity {
+
+class TaskGroup;
+
+// One-shot dependency graph on top of the thread pool: every node is
+// scheduled as soon as all the nodes it depends on are finished, nodes
+// without a path between them run concurrently. Nodes are added up front,
+// dependencies must refer to already added nodes so the graph cannot
+// contain cycles.
+class TaskGraph final
+{
+    typedef std::function<void()> FunctorType;
+
+    struct Node final
+    {
+        std::string name;
+        FunctorType func;
+        std::vector<std::size_t> dependents;
+        std::size_t dependencyCount;
+        std::atomic<std::size_t> remaining;
+        std::uint32_t duration;
+    };
+
+public:
+    typedef std::size_t TaskId;
+
+    TaskGraph()
+        : wallTime_(0)
+    { }
+
+    TaskGraph(TaskGraph const &) = delete;
+    TaskGraph & operator=(TaskGraph const &) = delete;
+
+    TaskId add(std::string name, FunctorType func, std::initializer_list<TaskId> dependencies = {});
+
+    // blocks until every node is finished
+    void run();
+
+    // per node duration, longest first, and the wall time of the whole graph
+    void logReport(char const *filter) const;
+
+    std::uint32_t wallTime() const
+    {
+        return wallTime_;
+    }
+
+private:
+    void schedule(TaskGroup &group, Node &node);
+
+    std::vector<std::unique_ptr<Node>> nodes_;
+
+    std::uint32_t wallTime_;
+};
+
+} // namespace Trinity
+
+#endif // TRINITY_SHARED_TASK_GRAPH_HPP
@@ -1,10 +1,25 @@
 #include "ThreadPoolMgr.hpp"
 
+#include <algorithm>
+
 namespace Trinity {
 
 ThreadPoolMgr::ThreadPoolMgr()
-    : requestCount_(0)
-{ }
+    : dequeCount_(0)
+    , stopped_(false)
+    , epoch_(0)
+    , idleWorkers_(0)
+    , idleWaiters_(0)
+{
+    for (auto &deque : deques_)
+        deque.store(nullptr, std::memory_order_relaxed);
+}
+
+ThreadPoolMgr::~ThreadPoolMgr()
+{
+    for (auto task : freeTasks_)
+        delete task;
+}
 
 void ThreadPoolMgr::start(std::size_t numThreads)
 {
@@ -15,28 +30,300 @@ void ThreadPoolMgr::start(std::size_t numThreads)
 
 void ThreadPoolMgr::stop()
 {
-    if (!queue_.frozen()) {
-        queue_.freeze();
-        for (auto &t : threads_)
-            t.join();
+    if (stopped_.exchange(true))
+        return;
+
+    {
+        std::lock_guard<std::mutex> guard(sleepLock_);
+        workerCond_.notify_all();
+    }
+
+    for (auto &t : threads_)
+        t.join();
+}
+
+void ThreadPoolMgr::schedule(TaskGroup &group, FunctorType func)
+{
+    DequeType * const deque = localDeque();
+    if (!deque) {
+        // too many threads schedule tasks at once, run it right away
+        func();
+        return;
+    }
+
+    Task * const task = allocateTask(std::move(func), group);
+    group.pending_.fetch_add(1, std::memory_order_relaxed);
+
+    Task *head = group.scheduled_.load(std::memory_order_relaxed);
+    do
+        task->next = head;
+    while (!group.scheduled_.compare_exchange_weak(head, task, std::memory_order_seq_cst, std::memory_order_relaxed));
+
+    deque->push(task);
+
+    epoch_.fetch_add(1, std::memory_order_seq_cst);
+    if (idleWorkers_.load(std::memory_order_seq_cst) != 0) {
+        std::lock_guard<std::mutex> guard(sleepLock_);
+        workerCond_.notify_one();
+    }
+
+    // the condition is shared by the waiters of all groups, they recheck
+    // their own group when woken
+    if (group.sleeping_.load(std::memory_order_seq_cst)) {
+        std::lock_guard<std::mutex> guard(sleepLock_);
+        waiterCond_.notify_all();
+    }
+}
+
+ThreadPoolMgr::LocalDeque::~LocalDeque()
+{
+    if (deque)
+        ThreadPoolMgr::instance()->releaseDeque(deque);
+}
+
+ThreadPoolMgr::DequeType * ThreadPoolMgr::localDeque()
+{
+    static thread_local LocalDeque local;
+    if (local.deque)
+        return local.deque;
+
+    std::lock_guard<std::mutex> guard(dequeLock_);
+
+    if (!freeDeques_.empty()) {
+        local.deque = freeDeques_.back();
+        freeDeques_.pop_back();
+        return local.deque;
+    }
+
+    std::size_t const index = dequeCount_.load(std::memory_order_relaxed);
+    if (index == MaxDeques)
+        return nullptr;
+
+    dequeStorage_.emplace_back(new DequeType());
+    local.deque = dequeStorage_.back().get();
+
+    deques_[index].store(local.deque, std::memory_order_release);
+    dequeCount_.store(index + 1, std::memory_order_release);
+    return local.deque;
+}
+
+void ThreadPoolMgr::releaseDeque(DequeType *deque)
+{
+    // every group waits for its tasks, what is left here is either already
+    // claimed or belongs to a group waited for by another thread
+    Task *task = nullptr;
+    while (deque->pop(task))
+        run(task);
+
+    // the deque stays visible to thieves, it just is empty until reused
+    std::lock_guard<std::mutex> guard(dequeLock_);
+    freeDeques_.push_back(deque);
+}
+
+ThreadPoolMgr::TaskCache::~TaskCache()
+{
+    ThreadPoolMgr * const pool = ThreadPoolMgr::instance();
+
+    std::lock_guard<std::mutex> guard(pool->taskLock_);
+    pool->freeTasks_.insert(pool->freeTasks_.end(), tasks.begin(), tasks.end());
+}
+
+std::vector<ThreadPoolMgr::Task *> & ThreadPoolMgr::localTasks()
+{
+    static thread_local TaskCache local;
+    return local.tasks;
+}
+
+ThreadPoolMgr::Task * ThreadPoolMgr::allocateTask(FunctorType func, TaskGroup &group)
+{
+    std::vector<Task *> &cache = localTasks();
+    if (cache.empty()) {
+        std::lock_guard<std::mutex> guard(taskLock_);
+        std::size_t const count = std::min(freeTasks_.size(), TaskBatchSize);
+        cache.insert(cache.end(), freeTasks_.end() - count, freeTasks_.end());
+        freeTasks_.resize(freeTasks_.size() - count);
+    }
+
+    Task *task = nullptr;
+    if (cache.empty()) {
+        task = new Task();
+    } else {
+        task = cache.back();
+        cache.pop_back();
+    }
+
+    // published to other threads by the pushes in schedule()
+    task->func = std::move(func);
+    task->group = &group;
+    task->claimed.store(false, std::memory_order_relaxed);
+    task->refs.store(2, std::memory_order_relaxed);
+    return task;
+}
+
+void ThreadPoolMgr::release(Task *task)
+{
+    if (task->refs.fetch_sub(1, std::memory_order_acq_rel) != 1)
+        return;
+
+    // drop the captures now, not when the task is reused
+    task->func = nullptr;
+
+    // tasks are mostly scheduled by one thread and finished by others,
+    // the surplus of the finishing threads goes back to the pool
+    std::vector<Task *> &cache = localTasks();
+    cache.push_back(task);
+    if (cache.size() >= 2 * TaskBatchSize) {
+        std::lock_guard<std::mutex> guard(taskLock_);
+        freeTasks_.insert(freeTasks_.end(), cache.end() - TaskBatchSize, cache.end());
+        cache.resize(cache.size() - TaskBatchSize);
+    }
+}
+
+bool ThreadPoolMgr::runPending()
+{
+    DequeType * const own = localDeque();
+
+    Task *task = nullptr;
+    if (!own || !own->pop(task)) {
+        // start at a different victim on every attempt to spread the steals
+        static thread_local std::size_t victim = 0;
+
+        std::size_t const count = dequeCount_.load(std::memory_order_acquire);
+        for (std::size_t i = 0; i < count && !task; ++i) {
+            DequeType *deque = deques_[(victim + i) % count].load(std::memory_order_acquire);
+            if (deque != own && deque->steal(task))
+                victim = (victim + i) % count;
+        }
+
+        if (!task) {
+            ++victim;
+            return false;
+        }
+    }
+
+    run(task);
+    return true;
+}
+
+bool ThreadPoolMgr::runPending(TaskGroup &group)
+{
+    for (;;) {
+        if (!group.taken_)
+            group.taken_ = group.scheduled_.exchange(nullptr, std::memory_order_acquire);
+
+        Task * const task = group.taken_;
+        if (!task)
+            return false;
+
+        group.taken_ = task->next;
+
+        bool const claimed = !task->claimed.exchange(true, std::memory_order_acq_rel);
+        if (claimed)
+            execute(task);
+
+        release(task);
+
+        if (claimed)
+            return true;
     }
 }
 
-void ThreadPoolMgr::wait()
+void ThreadPoolMgr::run(Task *task)
+{
+    if (!task->claimed.exchange(true, std::memory_order_acq_rel))
+        execute(task);
+
+    release(task);
+}
+
+bool ThreadPoolMgr::hasPending() const
 {
-    GuardType guard(lock_);
-    waitCond_.wait(guard, [this] { return requestCount_ == 0; });
+    std::size_t const count = dequeCount_.load(std::memory_order_acquire);
+    for (std::size_t i = 0; i < count; ++i)
+        if (!deques_[i].load(std::memory_order_acquire)->empty())
+            return true;
+
+    return false;
+}
+
+void ThreadPoolMgr::execute(Task *task)
+{
+    task->func();
+
+    TaskGroup * const group = task->group;
+
+    // the group may be destroyed by its waiter as soon as it is done,
+    // it must not be touched after the last decrement
+    if (group->pending_.fetch_sub(1, std::memory_order_seq_cst) == 1) {
+        if (idleWaiters_.load(std::memory_order_seq_cst) != 0) {
+            std::lock_guard<std::mutex> guard(sleepLock_);
+            waiterCond_.notify_all();
+        }
+    }
+}
+
+void ThreadPoolMgr::idle()
+{
+    idleWorkers_.fetch_add(1, std::memory_order_seq_cst);
+    unsigned const epoch = epoch_.load(std::memory_order_seq_cst);
+
+    // anything scheduled before the epoch was read is visible here,
+    // anything scheduled after changes the epoch and wakes one of us up
+    auto const stopped = [this] { return stopped_.load(std::memory_order_acquire); };
+    if (!stopped() && !hasPending()) {
+        std::unique_lock<std::mutex> guard(sleepLock_);
+        workerCond_.wait(guard, [this, epoch, &stopped] {
+            return stopped() || epoch_.load(std::memory_order_seq_cst) != epoch;
+        });
+    }
+
+    idleWorkers_.fetch_sub(1, std::memory_order_seq_cst);
+}
+
+void ThreadPoolMgr::idle(TaskGroup &group)
+{
+    group.sleeping_.store(true, std::memory_order_seq_cst);
+    idleWaiters_.fetch_add(1, std::memory_order_seq_cst);
+
+    // a task pushed after the flag was set wakes us up, one pushed before
+    // is seen by hasTasks()
+    auto const ready = [&group] { return group.done() || group.hasTasks(); };
+    if (!ready()) {
+        std::unique_lock<std::mutex> guard(sleepLock_);
+        waiterCond_.wait(guard, ready);
+    }
+
+    idleWaiters_.fetch_sub(1, std::memory_order_seq_cst);
+    group.sleeping_.store(false, std::memory_order_relaxed);
 }
 
 void ThreadPoolMgr::threadFunc()
 {
-    FunctorType f;
-    while (queue_.pop(f)) {
-        f();
-        GuardType g(lock_);
-        if (--requestCount_ == 0)
-            waitCond_.notify_all();
+    while (!stopped_.load(std::memory_order_acquire))
+        if (!runPending())
+            idle();
+}
+
+void TaskGroup::wait()
+{
+    ThreadPoolMgr * const pool = ThreadPoolMgr::instance();
+
+    while (!done())
+        if (!pool->runPending(*this))
+            pool->idle(*this);
+
+    // drop the references to the tasks run by other threads
+    ThreadPoolMgr::Task *task = taken_ ? taken_ : scheduled_.exchange(nullptr, std::memory_order_acquire);
+    while (task) {
+        ThreadPoolMgr::Task * const next = task->next;
+        pool->release(task);
+        task = next;
+
+        if (!task)
+            task = scheduled_.exchange(nullptr, std::memory_order_acquire);
     }
+
+    taken_ = nullptr;
 }
 
 } // namespace Trinity
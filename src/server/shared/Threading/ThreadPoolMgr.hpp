@@ -1,10 +1,12 @@
 #ifndef TRINITY_SHARED_THREAD_POOL_MGR_HPP
 #define TRINITY_SHARED_THREAD_POOL_MGR_HPP
 
-#include "SynchronizedQueue.hpp"
+#include "WorkStealingDeque.hpp"
 
+#include <atomic>
 #include <condition_variable>
 #include <functional>
+#include <memory>
 #include <mutex>
 #include <thread>
 #include <vector>
@@ -13,19 +15,73 @@
 
 namespace Trinity {
 
+class TaskGroup;
+
+// Work-stealing pool: every thread that schedules or runs tasks owns a
+// deque, idle threads steal from the others. Tasks are always scheduled
+// through a TaskGroup, waiting on a group executes pending tasks of that
+// group instead of blocking, so groups can be nested (e.g. instances
+// scheduled from the update of their parent map) without a waiter getting
+// stuck in unrelated work. A group is waited for by a single thread, the
+// one that created it.
 class ThreadPoolMgr final
 {
-    typedef std::mutex LockType;
-
-    typedef std::unique_lock<LockType> GuardType;
+    friend class TaskGroup;
 
     typedef std::function<void()> FunctorType;
 
-    typedef Trinity::SynchronizedQueue<FunctorType> QueueType;
+    // referenced by the deque it was pushed to and by its group, run by
+    // whichever of them claims it first; finished tasks are recycled
+    struct Task final
+    {
+        Task()
+            : group(nullptr)
+            , next(nullptr)
+            , claimed(false)
+            , refs(0)
+        { }
+
+        FunctorType func;
+        TaskGroup *group;
+        Task *next;             // link in the task list of the group
+        std::atomic<bool> claimed;
+        std::atomic<unsigned> refs;
+    };
+
+    typedef WorkStealingDeque<Task *> DequeType;
+
+    // workers plus external threads scheduling tasks at the same time,
+    // deques of finished threads are reused
+    static std::size_t const MaxDeques = 256;
+
+    // gives the deque of the thread back to the pool when it exits
+    struct LocalDeque final
+    {
+        LocalDeque()
+            : deque(nullptr)
+        { }
+
+        ~LocalDeque();
+
+        DequeType *deque;
+    };
+
+    // finished tasks kept by a thread for reuse, surplus goes back to the
+    // pool in batches so the pool lock is only taken every few tasks
+    static std::size_t const TaskBatchSize = 32;
+
+    struct TaskCache final
+    {
+        ~TaskCache();
+
+        std::vector<Task *> tasks;
+    };
 
 private:
     ThreadPoolMgr();
 
+    ~ThreadPoolMgr();
+
 public:
     static ThreadPoolMgr * instance()
     {
@@ -37,28 +93,123 @@ public:
 
     void stop();
 
+private:
+    void schedule(TaskGroup &group, FunctorType func);
+
+    DequeType * localDeque();
+
+    void releaseDeque(DequeType *deque);
+
+    std::vector<Task *> & localTasks();
+
+    Task * allocateTask(FunctorType func, TaskGroup &group);
+
+    void release(Task *task);
+
+    bool runPending();
+
+    bool runPending(TaskGroup &group);
+
+    void run(Task *task);
+
+    bool hasPending() const;
+
+    void execute(Task *task);
+
+    void idle();
+
+    void idle(TaskGroup &group);
+
+    void threadFunc();
+
+    std::vector<std::thread> threads_;
+
+    std::atomic<DequeType *> deques_[MaxDeques];
+
+    std::atomic<std::size_t> dequeCount_;
+
+    std::vector<std::unique_ptr<DequeType>> dequeStorage_;
+
+    std::vector<DequeType *> freeDeques_;
+
+    std::mutex dequeLock_;
+
+    std::vector<Task *> freeTasks_;
+
+    std::mutex taskLock_;
+
+    std::atomic<bool> stopped_;
+
+    // bumped on every push, lets idle workers detect work scheduled
+    // between their last scan and going to sleep
+    std::atomic<unsigned> epoch_;
+
+    // workers run any task, one of them is woken per push; waiters only
+    // run tasks of their own group and are woken when it gets a task or
+    // finishes
+    std::atomic<unsigned> idleWorkers_;
+
+    std::atomic<unsigned> idleWaiters_;
+
+    std::mutex sleepLock_;
+
+    std::condition_variable workerCond_;
+
+    std::condition_variable waiterCond_;
+};
+
+class TaskGroup final
+{
+    friend class ThreadPoolMgr;
+
+public:
+    TaskGroup()
+        : pending_(0)
+        , scheduled_(nullptr)
+        , taken_(nullptr)
+        , sleeping_(false)
+    { }
+
+    ~TaskGroup()
+    {
+        wait();
+    }
+
+    TaskGroup(TaskGroup const &) = delete;
+    TaskGroup & operator=(TaskGroup const &) = delete;
+
     template <typename RequestType>
-    void schedule(RequestType request)
+    void run(RequestType request)
     {
-        GuardType g(lock_);
-        if (queue_.push(std::move(request)))
-            ++requestCount_;
+        ThreadPoolMgr::instance()->schedule(*this, ThreadPoolMgr::FunctorType(std::move(request)));
     }
 
+    // returns once every task of the group is finished, runs pending tasks
+    // of the group in the meantime
     void wait();
 
-private:
-    void threadFunc();
-
-    QueueType queue_;
+    bool done() const
+    {
+        return pending_.load(std::memory_order_seq_cst) == 0;
+    }
 
-    std::vector<std::thread> threads_;
+private:
+    // waiter only
+    bool hasTasks() const
+    {
+        return taken_ || scheduled_.load(std::memory_order_seq_cst);
+    }
 
-    int requestCount_;
+    std::atomic<std::size_t> pending_;
 
-    LockType lock_;
+    // tasks of the group not run by the waiter yet, some of them may
+    // already be claimed by other threads. Any thread pushes to scheduled_
+    // without a lock, the single waiter moves the whole list to taken_.
+    std::atomic<ThreadPoolMgr::Task *> scheduled_;
+    ThreadPoolMgr::Task *taken_;
 
-    std::condition_variable waitCond_;
+    // set while the waiter sleeps, schedule() wakes it up
+    std::atomic<bool> sleeping_;
 };
 
 } // namespace Trinity
@@ -0,0 +1,149 @@
+#ifndef TRINITY_SHARED_WORK_STEALING_DEQUE_HPP
+#define TRINITY_SHARED_WORK_STEALING_DEQUE_HPP
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+#include <cstdint>
+
+namespace Trinity {
+
+// Chase-Lev deque: the owning thread pushes and pops at the bottom without
+// taking any lock, other threads steal from the top with a single CAS.
+// T must be trivially copyable (the thread pool stores task pointers).
+template <typename T>
+class WorkStealingDeque final
+{
+    class Buffer final
+    {
+    public:
+        explicit Buffer(std::int64_t capacity)
+            : capacity_(capacity)
+            , items_(new std::atomic<T>[capacity])
+        { }
+
+        std::int64_t capacity() const
+        {
+            return capacity_;
+        }
+
+        T get(std::int64_t index) const
+        {
+            return items_[index & (capacity_ - 1)].load(std::memory_order_relaxed);
+        }
+
+        void put(std::int64_t index, T item)
+        {
+            items_[index & (capacity_ - 1)].store(item, std::memory_order_relaxed);
+        }
+
+        Buffer * grow(std::int64_t bottom, std::int64_t top) const
+        {
+            Buffer *buffer = new Buffer(capacity_ * 2);
+            for (std::int64_t i = top; i < bottom; ++i)
+                buffer->put(i, get(i));
+            return buffer;
+        }
+
+    private:
+        std::int64_t capacity_;
+        std::unique_ptr<std::atomic<T>[]> items_;
+    };
+
+public:
+    // capacity must be a power of two
+    explicit WorkStealingDeque(std::int64_t capacity = 256)
+        : top_(0)
+        , bottom_(0)
+    {
+        buffers_.emplace_back(new Buffer(capacity));
+        buffer_.store(buffers_.back().get(), std::memory_order_relaxed);
+    }
+
+    WorkStealingDeque(WorkStealingDeque const &) = delete;
+    WorkStealingDeque & operator=(WorkStealingDeque const &) = delete;
+
+    // owner thread only
+    void push(T item)
+    {
+        std::int64_t const b = bottom_.load(std::memory_order_relaxed);
+        std::int64_t const t = top_.load(std::memory_order_acquire);
+        Buffer *buffer = buffer_.load(std::memory_order_relaxed);
+
+        if (b - t > buffer->capacity() - 1) {
+            // thieves may still read from the old buffer, it is released
+            // together with the deque
+            buffers_.emplace_back(buffer->grow(b, t));
+            buffer = buffers_.back().get();
+            buffer_.store(buffer, std::memory_order_release);
+        }
+
+        buffer->put(b, item);
+        std::atomic_thread_fence(std::memory_order_release);
+        bottom_.store(b + 1, std::memory_order_relaxed);
+    }
+
+    // owner thread only, takes the most recently pushed item
+    bool pop(T &item)
+    {
+        std::int64_t const b = bottom_.load(std::memory_order_relaxed) - 1;
+        Buffer *buffer = buffer_.load(std::memory_order_relaxed);
+        bottom_.store(b, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        std::int64_t t = top_.load(std::memory_order_relaxed);
+
+        if (t > b) {
+            bottom_.store(b + 1, std::memory_order_relaxed);
+            return false;
+        }
+
+        item = buffer->get(b);
+        if (t != b)
+            return true;
+
+        // last item, race against thieves
+        bool const won = top_.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+        bottom_.store(b + 1, std::memory_order_relaxed);
+        return won;
+    }
+
+    // any thread, takes the oldest item; fails only if the deque is empty
+    bool steal(T &item)
+    {
+        for (;;) {
+            std::int64_t t = top_.load(std::memory_order_acquire);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            std::int64_t const b = bottom_.load(std::memory_order_acquire);
+
+            if (t >= b)
+                return false;
+
+            T const candidate = buffer_.load(std::memory_order_acquire)->get(t);
+            if (top_.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+                item = candidate;
+                return true;
+            }
+        }
+    }
+
+    bool empty() const
+    {
+        return bottom_.load(std::memory_order_acquire) <= top_.load(std::memory_order_acquire);
+    }
+
+private:
+    // top is written by thieves, bottom by the owner: keep them on
+    // different cache lines
+    std::atomic<std::int64_t> top_;
+    char padding1_[64 - sizeof(std::atomic<std::int64_t>)];
+    std::atomic<std::int64_t> bottom_;
+    char padding2_[64 - sizeof(std::atomic<std::int64_t>)];
+    std::atomic<Buffer *> buffer_;
+
+    std::vector<std::unique_ptr<Buffer>> buffers_;
+};
+
+} // namespace Trinity
+
+#endif // TRINITY_SHARED_WORK_STEALING_DEQUE_HPP
@@ -395,6 +395,8 @@ bool Master::_StartDB()
         return false;
     }
 
+    WorldDatabase.SetConnectionAffinity(ConfigMgr::GetBoolDefault("WorldDatabase.SynchAffinity", false));
+
     ///- Get character database info from configuration file
     dbstring = ConfigMgr::GetStringDefault("CharacterDatabaseInfo", "");
     if (dbstring.empty())
@@ -420,6 +422,8 @@ bool Master::_StartDB()
         return false;
     }
 
+    CharacterDatabase.SetConnectionAffinity(ConfigMgr::GetBoolDefault("CharacterDatabase.SynchAffinity", false));
+
     ///- Get login database info from configuration file
     dbstring = ConfigMgr::GetStringDefault("LoginDatabaseInfo", "");
     if (dbstring.empty())
@@ -444,6 +448,8 @@ bool Master::_StartDB()
         return false;
     }
 
+    LoginDatabase.SetConnectionAffinity(ConfigMgr::GetBoolDefault("LoginDatabase.SynchAffinity", false));
+
     ///- Get the realm Id from the configuration file
     realmID = ConfigMgr::GetIntDefault("RealmID", 0);
     if (!realmID)